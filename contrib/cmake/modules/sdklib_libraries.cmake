@@ -71,6 +71,12 @@ macro(load_sdklib_libraries)
             set(HAVE_PDFIUM 1)
         endif()
 
+        if(USE_ZSTD)
+            find_package(zstd CONFIG REQUIRED)
+            target_link_libraries(SDKlib PRIVATE $<IF:$<TARGET_EXISTS:zstd::libzstd_shared>,zstd::libzstd_shared,zstd::libzstd_static>)
+            set(HAVE_ZSTD 1)
+        endif()
+
         if(USE_C_ARES)
             find_package(c-ares REQUIRED)
             target_link_libraries(SDKlib PRIVATE c-ares::cares)
@@ -144,6 +150,12 @@ macro(load_sdklib_libraries)
             set(HAVE_PDFIUM 1)
         endif()
 
+        if(USE_ZSTD)
+            pkg_check_modules(zstd REQUIRED IMPORTED_TARGET libzstd)
+            target_link_libraries(SDKlib PRIVATE PkgConfig::zstd)
+            set(HAVE_ZSTD 1)
+        endif()
+
         if(USE_C_ARES)
             pkg_check_modules(cares REQUIRED IMPORTED_TARGET libcares)
             target_link_libraries(SDKlib PRIVATE PkgConfig::cares)
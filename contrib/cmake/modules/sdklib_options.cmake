@@ -8,6 +8,7 @@ option(USE_FREEIMAGE "Used to create previews/thumbnails for photos/pictures" ON
 option(USE_FFMPEG "Used to create previews/thumbnails for video files" ON)
 option(USE_LIBUV "Includes the library and turns on internal web and ftp server functionality" OFF)
 option(USE_PDFIUM "Used to create previews/thumbnails for PDF files" ON)
+option(USE_ZSTD "Used to compress the node records stored in the account database" OFF)
 option(USE_C_ARES "If set, the SDK will manage DNS lookups and ipv4/ipv6 itself, using the c-ares library.  Otherwise we rely on cURL" ON)
 if (WIN32 OR IOS)
     option(USE_READLINE "Use the readline library for the console" OFF)
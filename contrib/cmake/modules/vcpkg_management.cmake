@@ -54,6 +54,10 @@ macro(process_vcpkg_libraries overlays_path)
         list(APPEND VCPKG_MANIFEST_FEATURES "use-pdfium")
     endif()
 
+    if (USE_ZSTD)
+        list(APPEND VCPKG_MANIFEST_FEATURES "use-zstd")
+    endif()
+
     if (USE_C_ARES)
         list(APPEND VCPKG_MANIFEST_FEATURES "use-cares")
     endif()
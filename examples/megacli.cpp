@@ -4130,12 +4130,14 @@ static void exec_fuseflags(autocomplete::ACState& state)
     auto parseCacheFlags = [&](fuse::InodeCacheFlags& flags) {
         std::string ageThreshold;
         std::string interval;
+        std::string maxListingSize;
         std::string maxSize;
         std::string sizeThreshold;
 
         state.extractflagparam("-cache-clean-age-threshold", ageThreshold);
         state.extractflagparam("-cache-clean-interval", interval);
         state.extractflagparam("-cache-clean-size-threshold", sizeThreshold);
+        state.extractflagparam("-cache-max-listing-size", maxListingSize);
         state.extractflagparam("-cache-max-size", maxSize);
 
         if (!ageThreshold.empty())
@@ -4144,6 +4146,9 @@ static void exec_fuseflags(autocomplete::ACState& state)
         if (!interval.empty())
             flags.mCleanInterval = seconds(stoul(interval));
 
+        if (!maxListingSize.empty())
+            flags.mMaxListingSize = stoul(maxListingSize);
+
         if (!maxSize.empty())
             flags.mMaxSize = stoul(maxSize);
 
@@ -4200,6 +4205,9 @@ static void exec_fuseflags(autocomplete::ACState& state)
               << "Cache Clean Size Threshold: "
               << flags.mInodeCacheFlags.mCleanSizeThreshold
               << "\n"
+              << "Cache Max Listing Size: "
+              << flags.mInodeCacheFlags.mMaxListingSize
+              << "\n"
               << "Cache Max Size: "
               << flags.mInodeCacheFlags.mMaxSize
               << "\n"
@@ -4240,6 +4248,7 @@ static void exec_fusemountadd(autocomplete::ACState& state)
 
     state.extractflagparam("-name", info.mFlags.mName);
 
+    info.mFlags.mHighThroughput = state.extractflag("-high-throughput");
     info.mFlags.mPersistent = state.extractflag("-persistent");
     info.mFlags.mReadOnly = state.extractflag("-read-only");
 
@@ -4478,6 +4487,20 @@ static void exec_fusemountflags(autocomplete::ACState& state)
     flags->mEnableAtStartup &= !disabled;
     flags->mPersistent |= enabled || disabled;
 
+    auto highThroughput = state.extractflag("-high-throughput");
+    auto normalThroughput = state.extractflag("-normal-throughput");
+
+    if (highThroughput && normalThroughput)
+    {
+        std::cerr << "A mount uses either the high or normal throughput profile."
+                  << std::endl;
+
+        return;
+    }
+
+    flags->mHighThroughput |= highThroughput;
+    flags->mHighThroughput &= !normalThroughput;
+
     state.extractflagparam("-name", flags->mName);
 
     auto readOnly = state.extractflag("-read-only");
@@ -4522,6 +4545,9 @@ static void exec_fusemountflags(autocomplete::ACState& state)
     std::cout << "Enabled at startup: "
               << flags->mEnableAtStartup
               << "\n"
+              << "High Throughput: "
+              << flags->mHighThroughput
+              << "\n"
               << "Name: "
               << flags->mName
               << "\n"
@@ -4567,6 +4593,9 @@ static void exec_fusemountlist(autocomplete::ACState& state)
                   << "  Enabled: "
                   << client->mFuseService.enabled(info.mPath)
                   << "\n"
+                  << "  High Throughput: "
+                  << (info.mFlags.mHighThroughput ? "Yes" : "No")
+                  << "\n"
                   << "  Name: \""
                   << info.mFlags.mName
                   << "\"\n"
@@ -5065,6 +5094,8 @@ autocomplete::ACN autocompleteSyntax()
                                            wholenumber("seconds", 5 * 60)),
                                   sequence(flag("-cache-clean-size-threshold"),
                                            wholenumber("count", 64)),
+                                  sequence(flag("-cache-max-listing-size"),
+                                           wholenumber("count", 16384)),
                                   sequence(flag("-cache-max-size"),
                                            wholenumber("count", 256)),
                                   sequence(flag("-flush-delay"),
@@ -5091,7 +5122,8 @@ autocomplete::ACN autocompleteSyntax()
            sequence(text("fuse"),
                     text("mount"),
                     text("add"),
-                    repeat(either(sequence(flag("-name"),
+                    repeat(either(flag("-high-throughput"),
+                                  sequence(flag("-name"),
                                            param("name")),
                                   flag("-persistent"),
                                   flag("-read-only"))),
@@ -5128,8 +5160,10 @@ autocomplete::ACN autocompleteSyntax()
                                     localFSFolder("target"))),
                     repeat(either(flag("-disabled-at-startup"),
                                   flag("-enabled-at-startup"),
+                                  flag("-high-throughput"),
                                   sequence(flag("-name"),
                                            param("name")),
+                                  flag("-normal-throughput"),
                                   flag("-persistent"),
                                   flag("-read-only"),
                                   flag("-transient"),
@@ -66,6 +66,10 @@ public:
     // true if the command returns strings, arrays or objects, but a seqtag is (optionally) also required. In example: ["seqtag"/error, <JSON from before v3>]
     bool mSeqtagArray = false;
 
+    // true if the command may be sent on the unordered lane, concurrently with other batches.
+    // Only read-only commands that never return a seqtag, and whose result no other command depends on, qualify.
+    bool mUnordered = false;
+
     // filters for JSON parsing in streaming
     std::map<std::string, std::function<bool(JSON *)>> mFilters;
 
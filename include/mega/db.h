@@ -71,6 +71,12 @@ public:
     virtual bool next(uint32_t*, string*) = 0;
     bool next(uint32_t*, string*, SymmCipher*);
 
+    // get next record in sequence, leaving decryption to decrypt() (possibly on another thread)
+    bool nextEncrypted(uint32_t*, string*);
+
+    // decrypt and unpad a record returned by nextEncrypted()
+    static bool decrypt(uint32_t, string*, SymmCipher*);
+
     // get specific record by key
     virtual bool get(uint32_t, string*) = 0;
 
@@ -166,6 +172,9 @@ public:
     virtual bool getRecentNodes(unsigned maxcount, m_time_t since, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) = 0;
     virtual bool getNodesByFingerprint(const std::string& fingerprint, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) = 0;
     virtual bool getNodeByFingerprint(const std::string& fingerprint, mega::NodeSerialized& node, NodeHandle& handle) = 0;
+
+    // pass the fingerprint of every file node to the callback
+    virtual bool getFingerprints(std::function<void(const std::string&)> callback) = 0;
     virtual bool getRootNodes(std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) = 0;
 
     /**
@@ -194,6 +203,9 @@ public:
 
     virtual bool isAncestor(NodeHandle node, NodeHandle ancestror, CancelToken cancelFlag) = 0;
 
+    // determine which of the nodes are located below ancestor, with a single query
+    virtual bool filterByAncestor(NodeHandle ancestor, const std::vector<NodeHandle>& nodes, std::set<NodeHandle>& descendants, CancelToken cancelFlag) = 0;
+
     // count of items in 'nodes' table. Returns 0 if error
     virtual uint64_t getNumberOfNodes() = 0;
 
@@ -314,6 +326,17 @@ struct MEGA_API DbAccess
     static const int LAST_DB_VERSION_WITHOUT_NOD;
     static const int LAST_DB_VERSION_WITHOUT_SRW;
 
+    // Node records without a header (see NodeData) are still read, and
+    // upgraded when they're next written.
+    static const int LAST_DB_VERSION_WITHOUT_NODE_HEADERS;
+
+    // Uncompressed node records are still read, and compressed over time.
+    static const int LAST_DB_VERSION_WITHOUT_NODE_COMPRESSION;
+
+    // True if the legacy database can be renamed to the current version,
+    // rather than discarded and fetched again.
+    static bool legacyDbRecyclable();
+
     DbAccess();
 
     virtual ~DbAccess() { }
@@ -29,6 +29,9 @@
 
 namespace mega {
 
+// Compresses the node records stored in an account database.
+class SqliteNodeCodec;
+
 class MEGA_API SqliteDbTable : public DbTable
 {
 protected:
@@ -117,11 +120,13 @@ public:
 
     bool getNodesByFingerprint(const std::string& fingerprint, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) override;
     bool getNodeByFingerprint(const std::string& fingerprint, mega::NodeSerialized& node, NodeHandle& handle) override;
+    bool getFingerprints(std::function<void(const std::string&)> callback) override;
     bool getRecentNodes(unsigned maxcount, m_time_t since, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes) override;
     bool getFavouritesHandles(NodeHandle node, uint32_t count, std::vector<mega::NodeHandle>& nodes) override;
     bool childNodeByNameType(NodeHandle parentHanlde, const std::string& name, nodetype_t nodeType, std::pair<NodeHandle, NodeSerialized>& node) override;
     bool getNodeSizeTypeAndFlags(NodeHandle node, m_off_t& size, nodetype_t& nodeType, uint64_t &oldFlags) override;
     bool isAncestor(mega::NodeHandle node, mega::NodeHandle ancestor, CancelToken cancelFlag) override;
+    bool filterByAncestor(mega::NodeHandle ancestor, const std::vector<mega::NodeHandle>& nodes, std::set<mega::NodeHandle>& descendants, CancelToken cancelFlag) override;
     uint64_t getNumberOfNodes() override;
     uint64_t getNumberOfChildrenByType(NodeHandle parentHandle, nodetype_t nodeType) override;
 
@@ -147,7 +152,11 @@ public:
     void createIndexes() override;
 
     void remove() override;
-    SqliteAccountState(PrnGen &rng, sqlite3*, FileSystemAccess &fsAccess, const mega::LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack);
+
+    // Compresses node records a batch at a time as the database commits.
+    void commit() override;
+
+    SqliteAccountState(PrnGen &rng, sqlite3*, FileSystemAccess &fsAccess, const mega::LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack, std::unique_ptr<SqliteNodeCodec> codec);
     void finalise();
     virtual ~SqliteAccountState();
 
@@ -176,6 +185,9 @@ private:
     // Allow at least the following containers:
     bool processSqlQueryNodes(sqlite3_stmt *stmt, std::vector<std::pair<mega::NodeHandle, mega::NodeSerialized>>& nodes);
 
+    // Transparently (de)compresses the node records we store
+    std::unique_ptr<SqliteNodeCodec> mCodec;
+
     // if add a new sqlite3_stmt update finalise()
     sqlite3_stmt* mStmtPutNode = nullptr;
     sqlite3_stmt* mStmtUpdateNode = nullptr;
@@ -213,6 +225,8 @@ private:
     sqlite3_stmt* mStmtNodeByOrigFp = nullptr;
     sqlite3_stmt* mStmtChildNode = nullptr;
     sqlite3_stmt* mStmtIsAncestor = nullptr;
+    sqlite3_stmt* mStmtAddAncestryCandidate = nullptr;
+    sqlite3_stmt* mStmtAncestry = nullptr;
     sqlite3_stmt* mStmtNumChild = nullptr;
     sqlite3_stmt* mStmtRecents = nullptr;
     sqlite3_stmt* mStmtFavourites = nullptr;
@@ -336,10 +350,10 @@ private:
         }
     };
 
-    bool addAndPopulateColumns(sqlite3* db, vector<NewColumn>&& newCols);
+    bool addAndPopulateColumns(sqlite3* db, vector<NewColumn>&& newCols, SqliteNodeCodec& codec);
     bool stripExistingColumns(sqlite3* db, vector<NewColumn>& cols);
     bool addColumn(sqlite3* db, const string& name, const string& type);
-    bool migrateDataToColumns(sqlite3* db, vector<NewColumn>&& cols);
+    bool migrateDataToColumns(sqlite3* db, vector<NewColumn>&& cols, SqliteNodeCodec& codec);
 };
 
 class OrderByClause
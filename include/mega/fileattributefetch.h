@@ -23,6 +23,7 @@
 #define MEGA_FILEATTRIBUTEFETCH_H 1
 
 #include "backofftimer.h"
+#include "filesystem.h"
 #include "types.h"
 #include "http.h"
 
@@ -52,6 +53,9 @@ struct MEGA_API FileAttributeFetchChannel
     // parse fetch result and remove completed attributes from pending
     void parse(int, bool);
 
+    // deliver a received attribute, caching it only if it was decrypted
+    void complete(handle, const FileAttributeFetch&, bool, const char*, uint32_t);
+
     // notify app of nodes that failed to receive their requested attribute
     void failed();
 
@@ -69,6 +73,70 @@ struct MEGA_API FileAttributeFetch
 
     FileAttributeFetch(handle, string, fatype, int);
 };
+
+// attribute found in the FileAttributeCache, waiting to be delivered
+struct MEGA_API FileAttributeCacheHit
+{
+    handle nodehandle;
+    fatype type;
+    int tag;
+    string data;
+};
+
+// optional on-disk cache of decrypted file attributes (thumbnails,
+// previews), keyed by attribute handle and type.  the least recently
+// used attributes are removed when the cache exceeds its size budget.
+class MEGA_API FileAttributeCache
+{
+public:
+    explicit FileAttributeCache(FileSystemAccess& fsAccess);
+
+    // cache attributes below path, or stop caching if path is empty.
+    // attributes already present below path are kept, if within budget.
+    // files below path that aren't named like attributes are left alone.
+    bool enable(const LocalPath& path, m_off_t budget);
+
+    bool enabled() const;
+
+    // retrieve a cached attribute
+    bool get(handle fah, fatype type, string& data);
+
+    // remember a decrypted attribute
+    void put(handle fah, fatype type, const char* data, size_t length);
+
+    // total size of the cached attributes
+    m_off_t size() const;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+private:
+    struct Entry
+    {
+        m_off_t size;
+        std::list<string>::iterator lru;
+    };
+
+    static string nameOf(handle fah, fatype type);
+
+    // whether name is one that nameOf() could have produced
+    static bool isName(const string& name);
+
+    void add(const string& name, m_off_t size);
+    void remove(const string& name);
+
+    // remove attributes until we're within budget
+    void evict();
+
+    FileSystemAccess& mFsAccess;
+    LocalPath mPath;
+    m_off_t mBudget = 0;
+    m_off_t mSize = 0;
+    std::map<string, Entry> mEntries;
+
+    // least recently used first
+    std::list<string> mLRU;
+};
 } // namespace
 
 #endif
@@ -755,6 +755,19 @@ struct MEGA_API FileAccess
     // Truncate a file.
     virtual bool ftruncate(m_off_t size = 0) = 0;
 
+    // Reserve space for a file of the specified size without changing its
+    // size, so that out of order writes don't fragment it.
+    // Returns false if the space couldn't be (or can't be) reserved.
+    virtual bool fpreallocate(m_off_t) { return false; }
+
+    // Start writing a range of the file back to disk.
+    virtual void fwriteback(m_off_t, m_off_t) { }
+
+    // Wait for a range already passed to fwriteback() to reach the disk and
+    // let the system drop it from its cache. Keeps large downloads from
+    // filling the cache with dirty pages.
+    virtual void fdropcache(m_off_t, m_off_t) { }
+
     FileAccess(Waiter *waiter);
     virtual ~FileAccess();
 
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <mega/fuse/common/directory_listing_forward.h>
+#include <mega/fuse/common/file_extension_db.h>
+#include <mega/fuse/common/inode_id.h>
+#include <mega/fuse/common/node_info.h>
+
+namespace mega
+{
+namespace fuse
+{
+
+// Describes a child in a directory's listing.
+//
+// Carries enough information to instantiate the child's inode
+// without consulting the cloud should it no longer be in memory.
+struct DirectoryListingEntry
+{
+    // The child's extension, if it only exists locally.
+    FileExtension mExtension;
+
+    // The child's ID, if it only exists locally.
+    InodeID mID;
+
+    // Describes the child.
+    //
+    // Only the child's name and parent are meaningful if the
+    // child only exists locally.
+    NodeInfo mInfo{};
+}; // DirectoryListingEntry
+
+} // fuse
+} // mega
+
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+namespace mega
+{
+namespace fuse
+{
+
+struct DirectoryListingEntry;
+
+using DirectoryListing = std::vector<DirectoryListingEntry>;
+using DirectoryListingPtr = std::shared_ptr<const DirectoryListing>;
+
+} // fuse
+} // mega
+
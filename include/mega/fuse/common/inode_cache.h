@@ -3,16 +3,20 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <list>
 #include <map>
 #include <mutex>
 #include <thread>
 
+#include <mega/fuse/common/directory_listing_forward.h>
 #include <mega/fuse/common/inode_cache_flags.h>
 #include <mega/fuse/common/inode_cache_forward.h>
 #include <mega/fuse/common/inode_forward.h>
 #include <mega/fuse/common/inode_id_forward.h>
 
+#include <mega/types.h>
+
 namespace mega
 {
 namespace fuse
@@ -20,14 +24,37 @@ namespace fuse
 
 class InodeCache
 {
+public:
+    // Describes how effective the listing cache has been.
+    struct ListingStatistics
+    {
+        // How many listings were served from the cache?
+        std::size_t mHits = 0u;
+
+        // How many listings have been invalidated?
+        std::size_t mInvalidations = 0u;
+
+        // How many listings had to be built from scratch?
+        std::size_t mRebuilds = 0u;
+    }; // ListingStatistics
+
+private:
     // Describes an inode in the cache.
     struct Entry;
 
+    // Describes a directory listing in the cache.
+    struct Listing;
+
     using EntryList = std::list<Entry>;
     using EntryListIterator = EntryList::iterator;
     using EntryPositionMap = std::map<InodeID, EntryListIterator>;
     using EntryPositionMapIterator = EntryPositionMap::iterator;
 
+    using ListingList = std::list<Listing>;
+    using ListingListIterator = ListingList::iterator;
+    using ListingPositionMap = std::map<NodeHandle, ListingListIterator>;
+    using ListingPositionMapIterator = ListingPositionMap::iterator;
+
     using Lock = std::unique_lock<std::mutex>;
 
     // Periodically tries to reduce the cache's size.
@@ -40,6 +67,9 @@ class InodeCache
                           Lock& lock,
                           std::size_t size);
 
+    // Reduce the listings to contain at most size entries.
+    void reduceListings(Lock& lock, std::size_t size);
+
     // Wakes up the cleaner thread.
     std::condition_variable mCV;
 
@@ -49,6 +79,21 @@ class InodeCache
     // Dictates how we behave.
     InodeCacheFlags mFlags;
 
+    // Used to detect listings invalidated while they were being built.
+    std::uint64_t mListingGeneration;
+
+    // Describes each directory listing in the cache.
+    ListingList mListings;
+
+    // Tracks where each directory listing can be found in the cache.
+    ListingPositionMap mListingPositions;
+
+    // How many entries do the cached listings contain?
+    std::size_t mListingSize;
+
+    // How effective has the listing cache been?
+    ListingStatistics mListingStatistics;
+
     // Serializes access to class members.
     mutable std::mutex mLock;
 
@@ -69,7 +114,7 @@ public:
     // Add an inode to the cache.
     bool add(const Inode& inode);
 
-    // Evict all inodes from the cache.
+    // Evict all inodes and listings from the cache.
     void clear();
 
     // Update this cache's flags.
@@ -78,6 +123,30 @@ public:
     // Retrieve this cache's flags.
     InodeCacheFlags flags() const;
 
+    // Invalidate a directory's cached listing.
+    void invalidate(NodeHandle handle);
+
+    // Retrieve a directory's cached listing.
+    //
+    // If the directory's listing isn't cached, generation is updated
+    // and must be passed back when the listing's been built.
+    //
+    // The listing describes the directory's children but doesn't keep
+    // them in memory: it's up to the caller to instantiate them.
+    DirectoryListingPtr listing(NodeHandle handle,
+                                std::uint64_t& generation);
+
+    // Cache a directory's listing.
+    //
+    // The listing is discarded if the directory's been invalidated
+    // since generation was retrieved.
+    void listing(NodeHandle handle,
+                 DirectoryListingPtr children,
+                 std::uint64_t generation);
+
+    // How effective has the listing cache been?
+    ListingStatistics listingStatistics() const;
+
     // Remove an inode from the cache.
     bool remove(const Inode& inode);
 }; // InodeCache
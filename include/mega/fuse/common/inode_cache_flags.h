@@ -23,6 +23,9 @@ struct InodeCacheFlags
 
     // How many inodes is the cache allowed to store?
     std::size_t mMaxSize = 256u;
+
+    // How many entries can the cache's directory listings contain?
+    std::size_t mMaxListingSize = 16384u;
 }; // InodeCacheFlags
 
 } // fuse
@@ -12,6 +12,7 @@
 #include <mega/fuse/common/database_forward.h>
 #include <mega/fuse/common/directory_inode_forward.h>
 #include <mega/fuse/common/directory_inode_results.h>
+#include <mega/fuse/common/directory_listing_forward.h>
 #include <mega/fuse/common/error_or_forward.h>
 #include <mega/fuse/common/file_cache_forward.h>
 #include <mega/fuse/common/file_extension_db_forward.h>
@@ -259,6 +260,13 @@ class InodeDB final
     // Check if a directory contains any children.
     ErrorOr<bool> hasChildren(const DirectoryInode& directory) const;
 
+    // Instantiate the children described by a directory's listing.
+    InodeRefVector instantiate(const DirectoryListing& listing,
+                               NodeHandle parentHandle) const;
+
+    // Describe a directory's children.
+    DirectoryListingPtr list(const DirectoryInode& parent) const;
+
     // Make a new directory below parent.
     ErrorOr<MakeInodeResult> makeDirectory(const platform::Mount& mount,
                                            const std::string& name,
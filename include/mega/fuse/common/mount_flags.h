@@ -22,6 +22,7 @@ struct MountFlags
 
     std::string mName;
     bool mEnableAtStartup = false;
+    bool mHighThroughput = false;
     bool mPersistent = false;
     bool mReadOnly = false;
 }; // MountFlags
@@ -25,7 +25,12 @@
 #include "types.h"
 #include "json.h"
 #include "filesystem.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace mega {
 
@@ -95,6 +100,52 @@ struct MEGA_API MediaProperties
 
 #ifdef USE_MEDIAINFO
 
+// Examines files on a small pool of worker threads, as opening a file with
+// mediainfoLib can take seconds.  Finished jobs are collected with pop().
+class MEGA_API MediaPropertiesExtractor
+{
+public:
+    struct Job
+    {
+        LocalPath path;
+
+        // for a download it is the handle of the node of the file.  For uploads it is the uploadHandle of the transfer
+        NodeOrUploadHandle handle;
+
+        // the key to use for XXTEA encryption of the attributes
+        uint32_t fakey[4];
+
+        // filled in by the worker thread
+        MediaProperties vp;
+    };
+
+    using Extract = std::function<void(Job&, FileSystemAccess&)>;
+
+    // extract defaults to MediaProperties::extractMediaPropertyFileAttributes
+    MediaPropertiesExtractor(std::shared_ptr<Waiter> waiter, unsigned threadCount, Extract extract = nullptr);
+    ~MediaPropertiesExtractor();
+
+    // examine a file on one of the worker threads, notifying the waiter once done
+    void push(std::unique_ptr<Job> job);
+
+    // a finished job, if there is one
+    std::unique_ptr<Job> pop();
+
+private:
+    void loop();
+
+    Extract mExtract;
+    std::shared_ptr<Waiter> mWaiter;
+
+    std::mutex mMutex;
+    std::condition_variable mCV;
+    std::deque<std::unique_ptr<Job>> mPending;
+    std::deque<std::unique_ptr<Job>> mFinished;
+    bool mStopping = false;
+
+    std::vector<std::thread> mThreads;
+};
+
 struct MEGA_API MediaFileInfo
 {
     struct MediaCodecs
@@ -145,6 +196,17 @@ struct MEGA_API MediaFileInfo
     // Check if we should retry video property extraction, due to previous failure with older library
     bool timeToRetryMediaPropertyExtraction(const std::string& fileattributes, uint32_t fakey[4]);
 
+    // Examine a file on a worker thread.  Its properties are attached to the node or upload when checkevents() collects them.
+    void queueMediaPropertiesExtraction(MegaClient* client, const LocalPath& localFilename, NodeOrUploadHandle handle, uint32_t fakey[4]);
+
+    // attach the properties of the files examined on the worker threads
+    int checkevents(MegaClient* client);
+
+    // number of threads examining files
+    static const unsigned EXTRACTION_THREADS;
+
+    std::unique_ptr<MediaPropertiesExtractor> extractor;
+
     MediaFileInfo();
 };
 
@@ -1405,6 +1405,7 @@ private:
     DriveInfoCollector mDriveInfoCollector;
 #endif
     BackoffTimer btcs;
+    BackoffTimer btcsUnordered;
     BackoffTimer btbadhost;
     BackoffTimer btworkinglock;
     BackoffTimer btreqstat;
@@ -1506,6 +1507,9 @@ public:
     // fetch state serialize from local cache
     bool fetchsc(DbTable*);
 
+    // decrypt state cache records on the worker threads, flagging those that could be decrypted
+    void decryptscrecords(vector<pair<uint32_t, string>>& records, vector<char>& decrypted);
+
     // fetch statusTable from local cache
     bool fetchStatusTable(DbTable*);
 
@@ -1687,6 +1691,9 @@ public:
     // reqs[r^1] is being processed on the API server
     HttpReq* pendingcs;
 
+    // batch of unordered commands being processed on the API server, concurrently with pendingcs
+    HttpReq* pendingcsUnordered = nullptr;
+
     // Only queue the "Server busy" event once, until the current cs completes, otherwise we may DDOS
     // ourselves in cases where many clients get 500s for a while and then recover at the same time
     bool pendingcs_serverBusySent = false;
@@ -1776,6 +1783,12 @@ public:
     // file attribute fetch channels
     fafc_map fafcs;
 
+    // decrypted file attributes kept on disk, if enabled
+    FileAttributeCache faCache;
+
+    // attributes found in faCache, delivered by exec()
+    std::deque<FileAttributeCacheHit> faCacheHits;
+
     // generate attribute string based on the pending attributes for this upload
     void pendingattrstring(UploadHandle, string*);
 
@@ -1784,6 +1797,7 @@ public:
     dsdrn_map dsdrns;      // indicates the time at which DRNs should be retried
     dr_list drq;           // DirectReads that are in DirectReadNodes which have fectched URLs
     drs_list drss;         // DirectReadSlot for each DR in drq, up to Max
+    DirectReadUrlCache drUrlCache; // temporary URLs of recently streamed nodes
     void removeAppData(void* t); // remove appdata (usually a MegaTransfer*) from every DirectRead
 
     // merge newly received share into nodes
@@ -1822,6 +1836,12 @@ public:
     // waiting for the completion of a putnodes
     pendingdbid_map pendingtcids;
 
+    // transfers whose cached record is out of date, see transfercachedirty()
+    set<Transfer*> dirtytransfers;
+
+    // when dirtytransfers were last written out
+    dstime transfercacheflushed = 0;
+
     // path of temporary files
     // waiting for the completion of a putnodes
     pendingfiles_map pendingfiles;
@@ -1880,6 +1900,16 @@ public:
     // update transfer in the persistent cache
     void transfercacheadd(Transfer*, TransferDbCommitter*);
 
+    // update transfer in the persistent cache soon, coalescing repeated updates (eg. progress)
+    void transfercachedirty(Transfer*);
+
+    // write out transfers updated with transfercachedirty(), once enough of them are waiting (or for long enough), or now if forced
+    void transfercacheflush(TransferDbCommitter*, bool force);
+
+    // how many transfers may wait to be written out, and for how long
+    static const size_t TRANSFERCACHE_MAX_DIRTY;
+    static const dstime TRANSFERCACHE_FLUSH_DS;
+
     // remove a transfer from the persistent cache
     void transfercachedel(Transfer*, TransferDbCommitter* committer);
 
@@ -1918,6 +1948,44 @@ public:
     // get a vector of recent actions in the account
     recentactions_vector getRecentActions(unsigned maxcount, m_time_t since);
 
+    // keep the files feeding getRecentActions() up to date with notified node changes
+    void updateRecentActions(const sharedNode_vector& nodes);
+
+    // drop them, so the next getRecentActions() reloads from the database
+    void invalidateRecentActions();
+
+private:
+    // a file eligible for the recent actions, with the keys used to bucket it
+    // (the node itself is only resolved when it's part of a result)
+    struct RecentNode
+    {
+        NodeHandle handle;
+        m_time_t ctime = 0;
+        handle owner = UNDEF;
+        NodeHandle parent;
+        size_t versions = 0;
+        bool media = false;
+    };
+
+    RecentNode makeRecentNode(const Node& n);
+    bool isRecentActionsCandidate(const Node& n) const;
+    void loadRecentActions(unsigned maxcount, m_time_t since);
+
+    // most recent first, keyed by ctime and handle
+    map<pair<m_time_t, NodeHandle>, RecentNode, std::greater<pair<m_time_t, NodeHandle>>> mRecentNodes;
+    map<NodeHandle, m_time_t> mRecentNodesTime;
+
+    // how they were loaded: up to mRecentNodesLimit files with ctime >= mRecentNodesSince
+    unsigned mRecentNodesMaxCount = 0;
+    size_t mRecentNodesLimit = 0;
+    m_time_t mRecentNodesSince = 0;
+
+    // true if every eligible file since mRecentNodesSince is in mRecentNodes (the limit was not reached)
+    bool mRecentNodesComplete = false;
+    bool mRecentNodesValid = false;
+
+public:
+
     // determine if the file is a video, photo, or media (video or photo).  If the extension (with trailing .) is not precalculated, pass null
     bool nodeIsMedia(const Node*, bool *isphoto, bool *isvideo) const;
 
@@ -2006,6 +2074,22 @@ public:
     // client-server request double-buffering
     RequestDispatcher reqs;
 
+    // commands that don't depend on the seqtag ordering of reqs (see Command::mUnordered)
+    RequestDispatcher reqsUnordered;
+
+    // send and process the batches of the unordered lane
+    void execunorderedcs();
+
+    // parse the error of a client-server request that failed as a whole, and tell the app about it.
+    // requestError receives the error as the request's commands should see it
+    error processRequestError(const string& in, string& requestError);
+
+    // tell the app that a client-server request failed the SSL public key check
+    void reportSslCheckFailure(const HttpReq& req);
+
+    // URL to post a client-server request to
+    string csurl(const string& idempotenceId, bool v3);
+
     // returns if the current pendingcs includes a fetch nodes command
     bool isFetchingNodesPendingCS();
 
@@ -2357,6 +2441,10 @@ public:
 #endif
         uint64_t transferStarts = 0, transferFinishes = 0;
         uint64_t transferTempErrors = 0, transferFails = 0;
+        uint64_t downloadWrites = 0, downloadWriteBytes = 0;
+        uint64_t transferCacheWrites = 0, transferCacheCoalesced = 0;
+        uint64_t directReadUrlCacheHits = 0, directReadUrlCacheMisses = 0;
+        uint64_t directReadFirstByteMs = 0, directReadFirstBytes = 0;
         uint64_t prepwaitImmediate = 0, prepwaitZero = 0, prepwaitHttpio = 0, prepwaitFsaccess = 0, nonzeroWait = 0;
         CodeCounter::DurationSum csRequestWaitTime;
         CodeCounter::DurationSum transfersActiveTime;
@@ -2541,6 +2629,9 @@ public:
     // return all available Elements in a Set, indexed by eid
     const elementsmap_t* getSetElements(handle sid) const;
 
+    // return the Elements, from any Set, that represent node nh
+    vector<const SetElement*> getSetElementsByNode(handle nh) const;
+
     // add new SetElement or replace exisiting one
     const SetElement* addOrUpdateSetElement(SetElement&& el);
 
@@ -2611,6 +2702,16 @@ private:
     vector<SetElement*> setelementnotify;
     map<handle, elementsmap_t> mSetElements; // indexed by Set id, then Element id
 
+    // maintain mSetElementsByNode
+    void indexSetElement(SetElement& el);
+    void unindexSetElement(const SetElement& el);
+    void rebuildSetElementIndex();
+
+    // drop all Elements of Set sid from memory
+    void eraseSetElements(handle sid);
+
+    multimap<handle, SetElement*> mSetElementsByNode; // indexed by node handle
+
     struct SetLink
     {
         handle mPublicId = UNDEF; // same as mSet.mPublicId once fetched
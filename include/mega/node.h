@@ -29,10 +29,11 @@
 #include "syncfilter.h"
 #include "backofftimer.h"
 #include <bitset>
+#include <limits>
 
 namespace mega {
 
-typedef map<LocalPath, LocalNode*> localnode_map;
+class NodeData;
 
 struct MEGA_API NodeCore
 {
@@ -368,6 +369,9 @@ struct MEGA_API Node : public NodeCore, FileFingerprint
 
     void setfingerprint();
 
+    // parse the fingerprint from the node's attributes, without indexing it
+    void parsefingerprint();
+
     void faspec(string*);
 
     NodeCounter getCounter() const;
@@ -384,6 +388,10 @@ struct MEGA_API Node : public NodeCore, FileFingerprint
     // It's used for speeding up get children when Node parent is known
     NodePosition mNodePosition;
 
+    // read-only snapshot unknown to NodeManager (see NodeData::createSnapshot)
+    // Neither mFingerPrintPosition nor mNodePosition are valid for snapshots
+    bool mIsSnapshot = false;
+
     // check if node is below this node
     bool isbelow(Node*) const;
     bool isbelow(NodeHandle) const;
@@ -395,6 +403,7 @@ struct MEGA_API Node : public NodeCore, FileFingerprint
 
     bool serialize(string*) const override;
     static std::shared_ptr<Node> unserialize(MegaClient& client, const string*, bool fromOldCache, std::list<std::unique_ptr<NewShare>>& ownNewshares);
+    static std::shared_ptr<Node> unserialize(MegaClient& client, NodeData& nodeData, bool fromOldCache, std::list<std::unique_ptr<NewShare>>& ownNewshares);
 
     Node(MegaClient&, NodeHandle, NodeHandle, nodetype_t, m_off_t, handle, const char*, m_time_t);
     ~Node();
@@ -505,7 +514,7 @@ inline bool Node::hasZeroKey(const string& nodekeydata)
 class NodeData
 {
 public:
-    NodeData(const char* ptr, size_t size, int component) : mStart(ptr), mEnd(ptr + size), mComp(component) {}
+    NodeData(const char* ptr, size_t size, int component);
 
     m_time_t getMtime();
     int getLabel();
@@ -513,8 +522,23 @@ public:
     std::string getTags();
     handle getHandle();
 
+    // Parse the whole record up front, returning false if it's malformed.
+    //
+    // Parsing doesn't touch any shared state so it's safe to do on
+    // any thread, ahead of createNode(...).
+    bool parse();
+
     std::unique_ptr<Node> createNode(MegaClient& client, bool fromOldCache, std::list<std::unique_ptr<NewShare>>& ownNewshares);
 
+    // Create a read-only snapshot of the node, which isn't indexed, cached
+    // or linked into the tree by the NodeManager.
+    //
+    // Returns nullptr for nodes carrying shares or still encrypted, as only
+    // a fully loaded node can represent those.
+    //
+    // nodeCounter is the counter stored next to the node's record.
+    std::unique_ptr<Node> createSnapshot(MegaClient& client, const std::string& nodeCounter);
+
     enum
     {
         COMPONENT_ALL = -1,
@@ -526,14 +550,53 @@ public:
         COMPONENT_TAGS,
     };
 
+    // Fields that can be located directly via a record's offset table.
+    //
+    // Offsets are relative to the start of the record's body, which
+    // is laid out exactly like a legacy record.
+    enum RecordField
+    {
+        FIELD_KEY,       // node key (zeroes if the node is encrypted)
+        FIELD_SHARES,    // share count, share key and shares
+        FIELD_ATTRS,     // node attributes
+        FIELD_LINK,      // public link
+        FIELD_ENCRYPTED, // node key data and attribute string of encrypted nodes
+        NUM_RECORD_FIELDS
+    };
+
+    // Records carrying an offset table start with this marker plus their version.
+    //
+    // Legacy records start with a node's size or negated type, neither
+    // of which can be anywhere near this value.
+    static constexpr m_off_t RECORD_MARKER = std::numeric_limits<m_off_t>::min();
+    static constexpr uint8_t RECORD_VERSION = 1;
+
+    // Size of a current record's header.
+    static constexpr size_t RECORD_HEADER_SIZE =
+        sizeof(m_off_t) + sizeof(uint8_t) + NUM_RECORD_FIELDS * sizeof(uint32_t);
+
+    // Writes a current record header into d at position, with offsets for
+    // a body that starts immediately after it.
+    static void writeRecordHeader(string& d, size_t position, const uint32_t (&offsets)[NUM_RECORD_FIELDS]);
+
 private:
+    // Parse the header of a current record, if present.
+    bool readHeader();
+
+    // Read only the node's attributes via the record's offset table.
+    bool readAttrsIndexed();
+
     bool readComponents();
-    bool readFailed() { return (mReadAttempted && !mReadSucceeded) || (!mReadAttempted && !readComponents()); }
+    bool readFailed();
 
     const char* mStart;
     const char* mEnd;
     int mComp;
 
+    // Offsets of each field in the record's body, if it carries an offset table.
+    uint32_t mOffsets[NUM_RECORD_FIELDS] = {};
+    bool mIndexed = false;
+
     m_off_t mSize = 0;
     nodetype_t mType = TYPE_UNKNOWN;
     handle mHandle = 0;
@@ -625,6 +688,27 @@ struct MEGA_API LocalNodeCore
 
 }; // LocalNodeCore
 
+// Keys of a LocalNode in its parent's children and schildren.
+struct LocalNodeName
+{
+    const LocalPath& operator()(const LocalNodeCore& node) const
+    {
+        return node.localname;
+    }
+}; // LocalNodeName
+
+struct LocalNodeShortname
+{
+    const LocalPath& operator()(const LocalNodeCore& node) const
+    {
+        assert(node.slocalname);
+        return *node.slocalname;
+    }
+}; // LocalNodeShortname
+
+typedef sorted_pointer_vector<LocalNode, LocalNodeName> localnode_children;
+typedef sorted_pointer_vector<LocalNode, LocalNodeShortname> localnode_shortchildren;
+
 struct MEGA_API LocalNode
   : public LocalNodeCore
 {
@@ -640,11 +724,11 @@ struct MEGA_API LocalNode
     // parent linkage
     LocalNode* parent = nullptr;
 
-    // children by name
-    localnode_map children;
+    // children by name, kept in a flat vector so large syncs don't pay for a tree node and name copy per child
+    localnode_children children;
 
     unique_ptr<LocalPath> cloneShortname() const;
-    localnode_map schildren;
+    localnode_shortchildren schildren;
 
     // The last scan of the folder (for folders).
     // Removed again when the folder is fully synced.
@@ -885,10 +969,22 @@ struct MEGA_API LocalNode
     // current subtree sync state as last notified to OS
     treestate_t mReportedSyncState = TREESTATE_NONE;
 
+    // id under which the sync state is published for overlay icon queries, 0 if not linked yet
+    uint64_t mTreestateId = 0;
+
     // check the current state
     treestate_t checkTreestate(bool notifyChangeToApp);
     void recursiveSetAndReportTreestate(treestate_t ts, bool recurse, bool reportToApp);
 
+    // publish mReportedSyncState, linking this node (and its ancestors) below the sync root if need be
+    void publishTreestate();
+
+    // link this node below its parent, so its published state can be found by path
+    void linkTreestate();
+
+    // forget the published states of this subtree, as it's leaving the sync
+    void unpublishTreestates();
+
     // timer to delay upload start
     dstime nagleds = 0;
     void bumpnagleds();
@@ -908,6 +1004,9 @@ struct MEGA_API LocalNode
 
     LocalNode* findChildWithSyncedNodeHandle(NodeHandle h);
 
+    // approximate bytes used by this node and its subtree, not counting name storage
+    size_t footprint() const;
+
     FSNode getLastSyncedFSDetails() const;
     FSNode getScannedFSDetails() const;
 
@@ -19,6 +19,7 @@
  * program.
  */
 
+#include <mutex>
 #include <thread>
 #ifndef NODEMANAGER_H
 #define NODEMANAGER_H 1
@@ -154,7 +155,11 @@ public:
     // read children from DB and load them in memory
     sharedNode_list getChildren(const Node *parent, CancelToken cancelToken = CancelToken());
 
-    sharedNode_vector getChildren(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page);
+    // If 'snapshots' is true, nodes that aren't already in memory are returned as read-only
+    // snapshots (see NodeData::createSnapshot) instead of being loaded: bulk listings then
+    // don't grow the set of nodes in memory nor evict others from the LRU cache.
+    // Snapshots must only be used to read the node's data.
+    sharedNode_vector getChildren(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, bool snapshots = false);
 
     // read children from type (folder or file) from DB and load them in memory
     sharedNode_vector getChildrenFromType(const NodeHandle &parent, nodetype_t type, CancelToken cancelToken);
@@ -171,7 +176,8 @@ public:
     /** @deprecated Use searchNodes(const NodeSearchFilter...) instead */
     sharedNode_vector search(NodeHandle ancestorHandle, const char* searchString, bool recursive, Node::Flags requiredFlags, Node::Flags excludeFlags, Node::Flags excludeRecursiveFlags, CancelToken cancelFlag);
 
-    sharedNode_vector searchNodes(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page);
+    // See getChildren(const NodeSearchFilter&...) regarding 'snapshots'
+    sharedNode_vector searchNodes(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, bool snapshots = false);
 
     /** @deprecated Use searchNodes(const NodeSearchFilter...) instead */
     sharedNode_vector getInSharesWithName(const char *searchString, CancelToken cancelFlag);
@@ -280,6 +286,21 @@ public:
     // This method only can be used in Megacli for testing purposes
     uint64_t getNumberNodesInRam() const;
 
+    struct FingerprintFilterStats
+    {
+        // memory used by the filter, in bytes
+        size_t memory = 0;
+        // look-ups answered by the filter
+        uint64_t lookups = 0;
+        // look-ups that didn't need to query the DB
+        uint64_t negatives = 0;
+        // look-ups that queried the DB without finding anything
+        uint64_t falsePositives = 0;
+    };
+
+    // Statistics about the fingerprint filter, for testing purposes
+    FingerprintFilterStats getFingerprintFilterStats() const;
+
     // Add new relationship between parent and child
     void addChild(NodeHandle parent, NodeHandle child, Node *node);
     // remove relationship between parent and child
@@ -361,6 +382,41 @@ private:
         std::set<FileFingerprint, FileFingerprintCmp> mAllFingerprintsLoaded;
     };
 
+    // Bloom filter over the fingerprints of all file nodes in the DB, so most look-ups
+    // of fingerprints that aren't in the account never need to query the DB.
+    // Fingerprints of removed or updated nodes aren't taken out: they only make false
+    // positives a bit more likely until the filter is rebuilt.
+    class FingerprintFilter
+    {
+    public:
+        // size the (empty) filter for the specified number of fingerprints
+        void reset(size_t capacity);
+        void clear();
+
+        void add(const std::string& fingerprint);
+        bool mayContain(const std::string& fingerprint) const;
+
+        // false until the filter has been built
+        bool ready() const { return !mBits.empty(); }
+
+        // true once more fingerprints have been added than the filter was sized for
+        bool saturated() const { return mCount > mCapacity; }
+
+        size_t memory() const { return mBits.size() * sizeof(uint64_t); }
+
+    private:
+        // ~1% false positives when the filter is full
+        static constexpr size_t BITS_PER_FINGERPRINT = 10;
+        static constexpr unsigned NUM_HASHES = 7;
+
+        template<typename Function>
+        void forEachBit(const std::string& fingerprint, Function&& function) const;
+
+        std::vector<uint64_t> mBits;
+        size_t mCapacity = 0;
+        size_t mCount = 0;
+    };
+
     // Stores nodes that have been loaded in RAM from DB (not necessarily all of them)
     std::map<NodeHandle, NodeManagerNode> mNodes;
 
@@ -390,9 +446,14 @@ private:
 
     // returns nullptr if there are unserialization errors. Also triggers a full reload (fetchnodes)
     shared_ptr<Node> getNodeFromNodeSerialized(const NodeSerialized& nodeSerialized);
+    shared_ptr<Node> getNodeFromNodeData(NodeData& nodeData, const std::string& nodeCounter);
+
+    // returns a read-only snapshot of the node, or nullptr if it must be fully loaded
+    shared_ptr<Node> getNodeSnapshot(NodeData& nodeData, const std::string& nodeCounter);
 
     // reads from DB and loads the node in memory
     shared_ptr<Node> unserializeNode(const string*, bool fromOldCache);
+    shared_ptr<Node> unserializeNode(NodeData& nodeData, bool fromOldCache);
 
     // returns the counter for the specified node, calculating it recursively and accessing to DB if it's neccesary
     NodeCounter calculateNodeCounter(const NodeHandle &nodehandle, nodetype_t parentType, std::shared_ptr<Node> node, bool isInRubbish);
@@ -400,6 +461,16 @@ private:
     // Container storing FileFingerprint* (Node* in practice) ordered by fingerprint
     FingerprintContainer mFingerPrints;
 
+    // Fingerprints of all file nodes in DB (built once all nodes are available)
+    FingerprintFilter mFingerprintFilter;
+    FingerprintFilterStats mFingerprintFilterStats;
+
+    // (re)build mFingerprintFilter from the fingerprints at DB
+    void buildFingerprintFilter();
+
+    // false if the fingerprint is certainly not at DB
+    bool fingerprintMayBeInDb(const std::string& fingerprint);
+
     // Return a node from Data base, node shouldn't be in RAM previously
     shared_ptr<Node> getNodeFromDataBase(NodeHandle handle);
 
@@ -410,17 +481,29 @@ private:
     // Avoid loading nodes whose ancestor is not ancestorHandle. If ancestorHandle is undef load all nodes
     // If a valid cancelFlag is passed and takes true value, this method returns without complete operation
     // If a valid object is passed, it must be kept alive until this method returns.
-    sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, NodeHandle ancestorHandle = NodeHandle(), CancelToken cancelFlag = CancelToken());
+    sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, NodeHandle ancestorHandle = NodeHandle(), CancelToken cancelFlag = CancelToken(), bool snapshots = false);
+
+    sharedNode_vector searchNodes_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, bool snapshots);
+    sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, CancelToken cancelFlag, bool snapshots = false);
+
+    // Parse records on our own worker threads, ahead of loading them.
+    // Null entries are skipped. Must be called without holding mMutex.
+    void parseNodes(std::vector<std::unique_ptr<NodeData>>& records);
+
+    // Threads dedicated to parsing records, created on first use.
+    //
+    // Parsing has its own threads so that a large load isn't stuck behind
+    // whatever work the client's worker threads happen to be doing.
+    std::unique_ptr<MegaClientAsyncQueue> mParseQueue;
+    std::once_flag mParseQueueCreated;
 
-    sharedNode_vector searchNodes_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page);
-    sharedNode_vector processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized>>& nodesFromTable, CancelToken cancelFlag);
-    sharedNode_vector getChildren_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page);
+    sharedNode_vector getChildren_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, bool snapshots);
 
     // node temporary in memory, which will be removed upon write to DB
     std::shared_ptr<Node> mNodeToWriteInDb;
 
     // Stores (or updates) the node in the DB. It also tries to decrypt it for the last time before storing it.
-    void putNodeInDb(Node* node) const;
+    void putNodeInDb(Node* node);
 
     // true when the NodeManager has been inicialized and contains a valid filesystem
     bool mInitialized = false;
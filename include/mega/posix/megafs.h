@@ -166,6 +166,14 @@ public:
 
     bool ftruncate(m_off_t size) override;
 
+#if defined(__linux__) && !defined(__ANDROID__)
+    bool fpreallocate(m_off_t size) override;
+
+    void fwriteback(m_off_t pos, m_off_t length) override;
+
+    void fdropcache(m_off_t pos, m_off_t length) override;
+#endif // __linux__ && ! __ANDROID__
+
     bool sysread(byte *, unsigned, m_off_t) override;
     bool sysstat(m_time_t*, m_off_t*, FSLogging) override;
     bool sysopen(bool async, FSLogging) override;
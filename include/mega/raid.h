@@ -106,6 +106,12 @@ namespace mega {
         // indicate that the buffer written by asyncIO (or synchronously) can now be discarded.
         void bufferWriteCompleted(unsigned connectionNum, bool succeeded);
 
+        // take the output piece away from a connection, so that connection can carry on downloading while the piece is decrypted and written elsewhere.
+        std::shared_ptr<RaidBufferManager::FilePiece> detachAsyncOutputBuffer(unsigned connectionNum);
+
+        // indicate that a piece taken with detachAsyncOutputBuffer has been written.
+        void detachedBufferWriteCompleted(FilePiece& piece);
+
         // temp URL to use on a given connection.  The same on all connections for a non-raid file.
         const std::string& tempURL(unsigned connectionNum);
 
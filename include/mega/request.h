@@ -97,8 +97,12 @@ public:
     RequestDispatcher(PrnGen&);
 
     // Queue a command to be send to MEGA. Some commands must go in their own batch (in case other commands fail the whole batch), determined by the Command's `batchSeparately` field.
+    // Commands flagged `mUnordered` are handed to `unorderedLane`, if there is one.
     void add(Command*);
 
+    // dispatcher for commands that don't need to be ordered with respect to this one's
+    RequestDispatcher* unorderedLane = nullptr;
+
     // Commands are waiting and could be sent (could be a retry if connection failed etc) (they are not already sent, not awaiting response)
     bool readyToSend() const;
 
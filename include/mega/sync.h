@@ -22,6 +22,7 @@
 #ifndef MEGA_SYNC_H
 #define MEGA_SYNC_H 1
 
+#include <array>
 #include <future>
 #include <unordered_set>
 
@@ -389,6 +390,34 @@ class SyncThreadsafeState
     MegaClient* mClient = nullptr;
     handle mBackupId = 0;
 
+    // Tree states published by the sync thread.
+    // Each published LocalNode has a compact id, and is linked to its parent's id by name
+    // (and by shortname, if it has one) so that no entry carries a whole path, and so
+    // renaming or moving a folder only relinks that folder.
+    // Sharded so that an overlay icon query only ever waits for a single map update,
+    // never for a whole recursiveSync pass holding mLocalNodeChangeMutex.
+    using TreestateLink = pair<uint64_t, LocalPath>;
+
+    struct TreestateShard
+    {
+        mutable mutex mMutex;
+        map<TreestateLink, uint64_t> mNames;
+        map<TreestateLink, uint64_t> mShortnames;
+        map<uint64_t, treestate_t> mStates;
+    };
+
+    static constexpr size_t TREESTATE_SHARDS = 64;
+    mutable std::array<TreestateShard, TREESTATE_SHARDS> mTreestates;
+
+    // only used by the sync thread
+    uint64_t mNextTreestateId = 0;
+
+    TreestateShard& treestateShard(uint64_t parentId, const LocalPath& name) const;
+    TreestateShard& treestateShard(uint64_t id) const;
+
+    // id of parentId's child with this name or shortname, 0 if there's none
+    uint64_t linkedTreestate(uint64_t parentId, const LocalPath& name) const;
+
 public:
 
     const bool mCanChangeVault;
@@ -414,6 +443,20 @@ public:
     LocalPath syncTmpFolder() const;
     void setSyncTmpFolder(const LocalPath&);
 
+    // Allocate an id for a LocalNode about to be linked.
+    uint64_t nextTreestateId();
+
+    // Link (or unlink) an id below its parent's.  The sync root has parent id 0 and an empty name.
+    void linkTreestate(uint64_t parentId, const LocalPath& name, const LocalPath* shortname, uint64_t id);
+    void unlinkTreestate(uint64_t parentId, const LocalPath& name, const LocalPath* shortname, uint64_t id);
+
+    // Record the tree state last reported for an id (TREESTATE_NONE forgets it).
+    void publishTreestate(uint64_t id, treestate_t ts);
+
+    // Look up a path relative to the sync root, by name or by shortname at each level.
+    // Safe to call from any thread, without waiting for the sync thread.
+    treestate_t publishedTreestate(const LocalPath& relativePath) const;
+
     SyncThreadsafeState(handle backupId, MegaClient* client, bool canChangeVault) : mClient(client), mBackupId(backupId), mCanChangeVault(canChangeVault)  {}
     handle backupId() const { return mBackupId; }
     MegaClient* client() const { return mClient; }
@@ -475,6 +518,17 @@ public:
     // process all outstanding filesystem notifications (mark sections of the sync tree to visit)
     dstime procscanq();
 
+    // Folders marked by filesystem notifications, and when they were marked.
+    // These are synced directly, without waiting for a full pass from localroot.
+    map<LocalPath, dstime> mTargetedFolders;
+
+    // Sync the folders in mTargetedFolders.  Returns true if any were visited.
+    bool recursiveSyncTargetedFolders();
+
+    // Sync a single folder, below localroot, as if we had reached it from localroot.
+    // Returns false if its ancestors still need attention.
+    bool recursiveSyncTargetedFolder(LocalNode& node);
+
     // helper for checking moves etc
     bool checkIfFileIsChanging(FSNode& fsNode, const LocalPath& fullPath);
 
@@ -604,7 +658,9 @@ public:
     std::shared_ptr<ScanService::ScanRequest> mActiveScanRequestUnscanned;
 
     static const int SCANNING_DELAY_DS;
+    static const int TARGETED_SCANNING_DELAY_DS;
     static const int EXTRA_SCANNING_DELAY_DS;
+    static const int TARGETED_SYNC_MAX_DS;
     static const int FILE_UPDATE_DELAY_DS;
     static const int FILE_UPDATE_MAX_DELAY_SECS;
     static const dstime RECENT_VERSION_INTERVAL_SECS;
@@ -1063,11 +1119,9 @@ struct Syncs
     // synchronous for now as that's a constraint from the intermediate layer
     NodeHandle getSyncedNodeForLocalPath(const LocalPath&);
 
-    // synchronous and requires first locking mLocalNodeChangeMutex
-    treestate_t getSyncStateForLocalPath(handle backupId, const LocalPath&);
-
-    // a variant for recovery after not being able to lock the mutex in time, all on the sync thread
-    bool getSyncStateForLocalPath(const LocalPath& lp, treestate_t& ts, nodetype_t& nt, SyncConfig& sc);
+    // answered from the tree states published by the sync thread, so it never waits for a sync pass.
+    // returns false if the path is not within an active sync
+    bool getSyncStateForLocalPath(const LocalPath& lp, treestate_t& ts) const;
 
     Syncs(MegaClient& mc);
     ~Syncs();
@@ -1269,6 +1323,8 @@ private:
     bool checkSyncsMovesWereComplete(); // Iterate through syncs, calling Sync::checkMovesgWereComplete(). Returns false if any sync returns false.
     bool isAnySyncSyncing() const;
     bool isAnySyncScanning_inThread() const;
+    bool isAnySyncTargeted_inThread() const;
+    bool recursiveSyncTargetedFolders_inThread(); // Sync folders marked by notifications ahead of the next full pass. Returns true if any were visited.
     bool checkSyncsScanningWasComplete_inThread(); // Iterate through syncs, calling Sync::checkScanningWasComplete(). Returns false if any sync returns false.
     void unsetSyncsScanningWasComplete_inThread(); // Unset scanningWasComplete flag for every sync.
 
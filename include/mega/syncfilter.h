@@ -37,11 +37,13 @@ struct FileAccess;
 // Forward Declaration
 class SizeFilter;
 class StringFilter;
+class StringFilterIndex;
 
 // Convenience.
 using SizeFilterPtr = std::shared_ptr<SizeFilter>;
 using StringFilterPtr = std::shared_ptr<StringFilter>;
 using StringFilterPtrVector = std::vector<StringFilterPtr>;
+using StringFilterIndexPtr = std::shared_ptr<StringFilterIndex>;
 
 class MEGA_API DefaultFilterChain
 {
@@ -166,6 +168,9 @@ public:
     FilterLoadResult load(FileSystemAccess& fsAccess, const LocalPath& path);
     FilterLoadResult load(FileAccess& fileAccess);
 
+    // Loads filters from a list of lines.
+    FilterLoadResult load(const string_vector& lines);
+
     // Attempts to locate a match for the path pair p.
     ExclusionState match(const RemotePathPair& p,
                        const nodetype_t type,
@@ -184,6 +189,11 @@ private:
     // Name and/or path filters.
     StringFilterPtrVector mStringFilters;
 
+    // Compiled form of mStringFilters.
+    //
+    // Index 0 considers every filter, index 1 only inheritable filters.
+    StringFilterIndexPtr mStringFilterIndex[2];
+
     // File size filter.
     SizeFilterPtr mSizeFilter;
 }; /* FilterChain */
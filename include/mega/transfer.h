@@ -211,6 +211,19 @@ struct MEGA_API Transfer : public FileFingerprint
     // whether the transfer is a Sync upload transfer
     bool mIsSyncUpload = false;
 
+    // where this transfer is in the TransferList's ready queues
+    struct ReadyPosition
+    {
+        // in the ready queue of this category, with this priority
+        bool queued = false;
+        unsigned category = 0;
+        uint64_t priority = 0;
+
+        // waiting out a backoff before going back to the ready queue
+        bool backingOff = false;
+        std::multimap<dstime, Transfer*>::iterator wakeup;
+    } readyPosition;
+
 private:
     FileDistributor::TargetNameExistsResolution toTargetNameExistsResolution(CollisionResolution resolution);
 };
@@ -238,6 +251,9 @@ public:
     static const uint64_t PRIORITY_START = 0x0000800000000000ull;
     static const uint64_t PRIORITY_STEP  = 0x0000000000010000ull;
 
+    // the least space left between transfers when priorities have to be spread out
+    static const uint64_t PRIORITY_MIN_SPACING = PRIORITY_STEP / 64;
+
     typedef deque_with_lazy_bulk_erase<Transfer*, LazyEraseTransferPtr> transfer_list;
 
     TransferList();
@@ -264,6 +280,12 @@ public:
                                                    TransferDbCommitter& committer);
     Transfer *transferat(direction_t direction, unsigned int position);
 
+    // the backoff timers of this direction's transfers were rearmed
+    void backoffsAborted(direction_t direction);
+
+    // remove every transfer from the list, without deleting them
+    void clear();
+
     std::array<transfer_list, 2> transfers;
     MegaClient *client;
     uint64_t currentpriority;
@@ -272,6 +294,29 @@ private:
     void prepareIncreasePriority(Transfer *transfer, transfer_list::iterator srcit, transfer_list::iterator dstit, TransferDbCommitter& committer);
     void prepareDecreasePriority(Transfer *transfer, transfer_list::iterator it, transfer_list::iterator dstit);
     bool isReady(Transfer *transfer);
+
+    // Renumber the transfers around dstindex so there's room to move the transfer at srcindex before it.
+    // Returns the priority the moved transfer should take.
+    uint64_t makeRoom(direction_t direction, size_t srcindex, size_t dstindex, TransferDbCommitter& committer);
+
+    // Transfers without a slot that could be started, so that nexttransfers() doesn't need to walk the whole list.
+    // Paused transfers are left out until resumed and those waiting out a backoff until it expires.
+    // Transfers holding a slot stay queued, so there are never more of them to skip than there are slots.
+    typedef std::set<std::pair<uint64_t, Transfer*>> ready_queue;
+
+    // indexed by TransferCategory::index(), in priority order
+    std::array<ready_queue, 6> mReady;
+
+    // transfers waiting out a backoff, by direction and the time their timer fires
+    std::array<std::multimap<dstime, Transfer*>, 2> mBackingOff;
+
+    void enqueueReady(Transfer* transfer);
+    void dequeueReady(Transfer* transfer);
+    void backOff(Transfer* transfer);
+    void wakeBackedOff(direction_t direction, dstime now);
+
+    // the transfer's priority changed
+    void reprioritizeReady(Transfer* transfer);
 };
 
 /**
@@ -694,6 +739,12 @@ struct MEGA_API DirectRead
 
     int reqtag;
 
+    // when the read was queued, to measure its time to first byte
+    std::chrono::steady_clock::time_point queuedAt = std::chrono::steady_clock::now();
+
+    // whether any data has been delivered to the app yet
+    bool delivered = false;
+
     void abort();
     m_off_t drMaxReqSize() const;
 
@@ -747,6 +798,44 @@ struct MEGA_API DirectReadNode
     DirectReadNode(MegaClient*, handle, bool, SymmCipher*, int64_t, const char*, const char*, const char*);
     ~DirectReadNode();
 };
+
+// temporary URLs of recently streamed nodes, so that reads opened after the
+// previous ones finished (eg. a player seeking) don't wait for the API
+class MEGA_API DirectReadUrlCache
+{
+public:
+    // URLs are valid for longer than this, and are dropped sooner if rejected
+    static constexpr dstime MAX_AGE_DS = 6000;
+
+    static constexpr size_t MAX_ENTRIES = 64;
+
+    // retrieve the URLs and size of a node, if fresh ones are known
+    bool get(handle h, std::vector<std::string>& tempurls, m_off_t& size);
+
+    // remember the URLs just obtained for a node
+    void put(handle h, const std::vector<std::string>& tempurls, m_off_t size);
+
+    // forget a node's URLs (eg. the storage server rejected them)
+    void invalidate(handle h);
+
+    void clear();
+
+    size_t size() const;
+
+private:
+    struct Entry
+    {
+        std::vector<std::string> tempurls;
+        m_off_t size;
+        dstime obtained;
+        std::list<handle>::iterator lru;
+    };
+
+    std::map<handle, Entry> mEntries;
+
+    // least recently used at the front
+    std::list<handle> mLRU;
+};
 } // namespace
 
 #endif
@@ -81,6 +81,18 @@ struct MEGA_API TransferSlot
     // maximum gap between chunks for uploads
     static const m_off_t MAX_GAP_SIZE;
 
+    // max data held by the download pipeline before connections wait for it to drain
+    static const m_off_t MAX_PIPELINE_SIZE;
+
+    // max async writes in flight from the download pipeline
+    static const unsigned MAX_PIPELINE_WRITES;
+
+    // max size of a write merging contiguous pieces from the download pipeline
+    static const m_off_t MAX_PIPELINE_WRITE_SIZE;
+
+    // data written to a download before it's flushed from the page cache
+    static const m_off_t WRITEBACK_WINDOW;
+
     m_off_t maxRequestSize;
 
     m_off_t progressreported;
@@ -120,6 +132,28 @@ struct MEGA_API TransferSlot
     // async IO operations
     AsyncIOContext** asyncIO;
 
+    // How many downloaded pieces are at each stage of the pipeline, to tell which stage is holding the download back.
+    struct PipelineStats
+    {
+        // being decrypted and mac'd on the worker threads
+        unsigned decrypting = 0;
+
+        // decrypted, waiting for earlier pieces or for a free write
+        unsigned decrypted = 0;
+
+        // being written to file
+        unsigned writing = 0;
+
+        // data held by the pipeline
+        m_off_t bytes = 0;
+
+        // writes issued so far, and the data they carried
+        uint64_t writes = 0;
+        uint64_t bytesWritten = 0;
+    };
+
+    PipelineStats pipelineStats() const;
+
     // handle I/O for this slot
     void doio(MegaClient*, TransferDbCommitter&);
 
@@ -171,9 +205,62 @@ struct MEGA_API TransferSlot
     ~TransferSlot();
 
 private:
+    // So unit tests can drive the pipeline directly.
+    friend class TransferSlotTestPeer;
+
     // New CloudRaid Proxy
     std::shared_ptr<CloudRaid> cloudRaid;
 
+    // An async write from the pipeline, covering one or more contiguous pieces
+    struct PipelineWrite
+    {
+        // the pieces' data, when there's more than one
+        std::unique_ptr<byte[]> data;
+
+        std::unique_ptr<AsyncIOContext> context;
+    };
+
+    // A downloaded piece handed over by its connection
+    struct PipelinedPiece
+    {
+        std::shared_ptr<TransferBufferManager::FilePiece> piece;
+
+        // set by the worker thread once the piece is decrypted and mac'd
+        std::atomic<bool> decrypted{false};
+
+        // write in flight, if any
+        std::shared_ptr<PipelineWrite> write;
+    };
+
+    using PipelinedPieceMap = std::map<m_off_t, std::shared_ptr<PipelinedPiece>>;
+
+    // Download pipeline, by file position.  Connections hand their pieces over and carry on downloading,
+    // while the pieces are decrypted on the client's worker threads and then written to file in order.
+    PipelinedPieceMap mPipeline;
+    m_off_t mPipelineBytes = 0;
+    uint64_t mPipelineWrites = 0;
+    uint64_t mPipelineBytesWritten = 0;
+
+    // written data up to here has been flushed (or is being flushed) from the page cache
+    m_off_t mWritebackPos = 0;
+    m_off_t mDroppedPos = 0;
+
+    // once a window's worth of contiguous data has been written, start writing it back
+    // and then wait for the previous window to reach the disk and drop it from the page cache
+    void writeback(m_off_t contiguous);
+
+    // whether a downloaded piece can be handed to the pipeline now, or must wait on its connection
+    bool pipelineAccepts(const TransferBufferManager::FilePiece& piece) const;
+
+    // hand a downloaded piece over to be decrypted and written
+    void pipelinePiece(MegaClient* client, std::shared_ptr<TransferBufferManager::FilePiece> piece);
+
+    // write decrypted pieces and account for those written.  Returns true if the transfer completed or failed.
+    bool processPipeline(MegaClient* client, TransferDbCommitter& committer, dstime& backoff);
+
+    // remove a piece from the pipeline, crediting the transfer with its data if it was written
+    PipelinedPieceMap::iterator retirePipelinedPiece(PipelinedPieceMap::iterator it, bool written);
+
     void toggleport(HttpReqXfer* req);
     bool checkDownloadTransferFinished(TransferDbCommitter& committer, MegaClient* client);
     bool checkMetaMacWithMissingLateEntries();
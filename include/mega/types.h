@@ -646,6 +646,86 @@ public:
 
 };
 
+template <class T, class KeyOf>
+class sorted_pointer_vector
+{
+    // A compact replacement for map<Key, T*> where the key is a member of T.
+    // Entries are kept in a single vector of pointers ordered by KeyOf()(const T&), so there is no per-entry allocation
+    // and no copy of the key, which matters for syncs with millions of LocalNodes.
+    // Entries that arrive out of order (eg. when loading from the state cache) are appended to an unsorted tail that is
+    // merged in by the next lookup or traversal, so bulk population stays O(n log n) rather than O(n^2).
+    // As with vector, any insertion or erase invalidates iterators.
+    mutable vector<T*> mEntries;
+    mutable size_t nSorted = 0;
+
+    template<class Key>
+    static bool keyLess(const T* t, const Key& key) { return KeyOf()(*t) < key; }
+
+    static bool entryLess(const T* lhs, const T* rhs) { return KeyOf()(*lhs) < KeyOf()(*rhs); }
+
+    void applySort() const
+    {
+        if (nSorted == mEntries.size()) return;
+
+        // later entries replace earlier ones with the same key, as map's operator[] would
+        std::stable_sort(mEntries.begin() + static_cast<ptrdiff_t>(nSorted), mEntries.end(), entryLess);
+        std::inplace_merge(mEntries.begin(), mEntries.begin() + static_cast<ptrdiff_t>(nSorted), mEntries.end(), entryLess);
+
+        auto out = mEntries.begin();
+        for (auto in = mEntries.begin(); in != mEntries.end(); ++in)
+        {
+            if (out != mEntries.begin() && !entryLess(*(out - 1), *in))
+            {
+                *(out - 1) = *in;
+            }
+            else
+            {
+                *out++ = *in;
+            }
+        }
+        mEntries.erase(out, mEntries.end());
+        nSorted = mEntries.size();
+    }
+
+public:
+
+    typedef typename vector<T*>::const_iterator iterator;
+    typedef iterator const_iterator;
+
+    iterator begin() const       { applySort(); return mEntries.cbegin(); }
+    iterator end() const         { applySort(); return mEntries.cend(); }
+    size_t size() const          { applySort(); return mEntries.size(); }
+    bool empty() const           { return mEntries.empty(); }
+    size_t capacity() const      { return mEntries.capacity(); }
+    T* back() const              { applySort(); return mEntries.back(); }
+    void clear()                 { mEntries.clear(); nSorted = 0; }
+    void shrink_to_fit()         { applySort(); mEntries.shrink_to_fit(); }
+
+    template<class Key>
+    iterator find(const Key& key) const
+    {
+        applySort();
+        auto i = std::lower_bound(mEntries.cbegin(), mEntries.cend(), key, keyLess<Key>);
+        return i != mEntries.cend() && !(key < KeyOf()(**i)) ? i : mEntries.cend();
+    }
+
+    // add t, replacing any existing entry with the same key
+    void set(T* t)
+    {
+        assert(t);
+        bool inOrder = nSorted == mEntries.size() && (mEntries.empty() || entryLess(mEntries.back(), t));
+        mEntries.push_back(t);
+        if (inOrder) ++nSorted;
+    }
+
+    iterator erase(iterator i)
+    {
+        assert(nSorted == mEntries.size() && i != mEntries.cend());
+        --nSorted;
+        return mEntries.erase(i);
+    }
+};
+
 template <class T1, class T2> class mapWithLookupExisting : public map<T1, T2>
 {
     typedef map<T1, T2> base; // helps older gcc
@@ -8094,6 +8094,27 @@ class MegaTransferListener
          */
         virtual void onTransferStart(MegaApi *api, MegaTransfer *transfer);
 
+        /**
+         * @brief This function is called when a batch of transfers has been started
+         *
+         * It's only called for batches started with MegaApi::startUploads or
+         * MegaApi::startDownloads, once all the transfers in the batch have been
+         * processed by the SDK. The list contains every transfer of the batch, in the
+         * order they were submitted. Transfers that failed straight away, or that were
+         * cancelled before the batch was processed, have already received their
+         * MegaTransferListener::onTransferFinish callback.
+         *
+         * The SDK retains the ownership of the transfers parameter.
+         * Don't use it after this functions returns.
+         *
+         * The api object is the one created by the application, it will be valid until
+         * the application deletes it.
+         *
+         * @param api MegaApi object that started the transfers
+         * @param transfers Information about the transfers
+         */
+        virtual void onTransfersStart(MegaApi* api, MegaTransferList* transfers);
+
         /**
          * @brief This function is called when a transfer has finished
          *
@@ -15456,6 +15477,37 @@ class MegaApi
          */
         void startUpload(const char *localPath, MegaNode *parent, const char *fileName, int64_t mtime, const char *appData, bool isSourceTemporary, bool startFirst, MegaCancelToken *cancelToken, MegaTransferListener *listener=NULL);
 
+        /**
+         * @brief Upload a batch of files or folders to the same parent
+         *
+         * This is equivalent to calling MegaApi::startUpload for each path, but is much
+         * cheaper when starting a large number of transfers. The whole batch is submitted
+         * to the SDK at once: the parent is looked up once and the transfer database is
+         * only committed once for the batch.
+         *
+         * Each transfer still receives its own MegaTransferListener::onTransferFinish
+         * callback. Once the whole batch has been started, the listener receives a single
+         * MegaTransferListener::onTransfersStart callback. The listener's per transfer
+         * MegaTransferListener::onTransferStart callbacks, in the order of localPaths, can be
+         * turned off with notifyEachStart. Listeners registered with
+         * MegaApi::addTransferListener or MegaApi::addListener are always notified.
+         *
+         * The batch starts after any transfers and requests submitted before this call.
+         *
+         * @param localPaths Local paths of the files or folders
+         * @param parent Parent node for the files or folders in the MEGA account
+         * @param appData Custom app data to save in every MegaTransfer object
+         *  + If you don't need this param provide NULL as value
+         * @param startFirst puts the transfers on top of the upload queue
+         *  + If you don't need this param provide false as value
+         * @param cancelToken MegaCancelToken to be able to cancel all transfers in the batch.
+         * App retains the ownership of this param.
+         * @param notifyEachStart Whether the listener's MegaTransferListener::onTransferStart
+         * is called for each transfer.
+         * @param listener MegaTransferListener to track these transfers
+         */
+        void startUploads(MegaStringList* localPaths, MegaNode* parent, const char* appData, bool startFirst, MegaCancelToken* cancelToken, bool notifyEachStart = true, MegaTransferListener* listener = NULL);
+
         /**
          * @brief Upload a file or a folder
          *
@@ -15551,6 +15603,39 @@ class MegaApi
          */
         void startDownload(MegaNode* node, const char* localPath, const char *customName, const char *appData, bool startFirst, MegaCancelToken *cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener = NULL);
 
+        /**
+         * @brief Download a batch of files or folders from MEGA into the same local folder
+         *
+         * This is equivalent to calling MegaApi::startDownload for each node, but is much
+         * cheaper when starting a large number of transfers. The whole batch is submitted
+         * to the SDK at once: the type of the local filesystem is determined once and the
+         * transfer database is only committed once for the batch.
+         *
+         * Each transfer still receives its own MegaTransferListener::onTransferFinish
+         * callback. Once the whole batch has been started, the listener receives a single
+         * MegaTransferListener::onTransfersStart callback. The listener's per transfer
+         * MegaTransferListener::onTransferStart callbacks, in the order of nodes, can be
+         * turned off with notifyEachStart. Listeners registered with
+         * MegaApi::addTransferListener or MegaApi::addListener are always notified.
+         *
+         * The batch starts after any transfers and requests submitted before this call.
+         *
+         * @param nodes MegaNodes that identify the files or folders
+         * @param localFolder Destination folder, it must end with a '\' or '/' character
+         * @param appData Custom app data to save in every MegaTransfer object
+         *  + If you don't need this param provide NULL as value
+         * @param startFirst puts the transfers on top of the download queue
+         *  + If you don't need this param provide false as value
+         * @param cancelToken MegaCancelToken to be able to cancel all transfers in the batch.
+         * App retains the ownership of this param.
+         * @param collisionCheck Indicates the collision check on same files, see MegaApi::startDownload
+         * @param collisionResolution Indicates how to save same files, see MegaApi::startDownload
+         * @param notifyEachStart Whether the listener's MegaTransferListener::onTransferStart
+         * is called for each transfer.
+         * @param listener MegaTransferListener to track these transfers
+         */
+        void startDownloads(MegaNodeList* nodes, const char* localFolder, const char* appData, bool startFirst, MegaCancelToken* cancelToken, int collisionCheck, int collisionResolution, bool notifyEachStart = true, MegaTransferListener* listener = NULL);
+
         /**
          * @brief Start an streaming download for a file in MEGA
          *
@@ -17126,6 +17211,33 @@ class MegaApi
          */
         unsigned long long getNumNodesAtCacheLRU() const;
 
+        /**
+         * @brief Keep the thumbnails and previews downloaded by the SDK in a local cache
+         *
+         * Requests for thumbnails and previews present in the cache (MegaApi::getThumbnail,
+         * MegaApi::getPreview) are served from it, without contacting the storage servers.
+         * When the cache exceeds the specified size, the least recently used ones are removed.
+         *
+         * Files already present in the cache folder, from a previous execution, are reused.
+         *
+         * @note The cached thumbnails and previews are stored unencrypted. By default, there
+         * is no cache.
+         *
+         * @param path Folder to keep the cache in, or NULL to disable the cache
+         * @param maxSize Maximum size of the cache, in bytes
+         * @return True if the cache could be enabled (or disabled)
+         */
+        bool setFileAttributeCache(const char* path, long long maxSize);
+
+        /**
+         * @brief Get the proportion of thumbnail and preview requests served from the cache
+         *
+         * @see MegaApi::setFileAttributeCache
+         *
+         * @return Hit rate of the cache, between 0 and 1 (0 if there were no requests yet)
+         */
+        double getFileAttributeCacheHitRate();
+
         enum { ORDER_NONE = 0, ORDER_DEFAULT_ASC, ORDER_DEFAULT_DESC,
             ORDER_SIZE_ASC, ORDER_SIZE_DESC,
             ORDER_CREATION_ASC, ORDER_CREATION_DESC,
@@ -22457,6 +22569,21 @@ class MegaApi
          */
         MegaSetElement* getSetElement(MegaHandle sid, MegaHandle eid);
 
+        /**
+         * @brief Get all Elements, from any Set of the current user, that represent a node.
+         *
+         * This answers "which Sets contain this node" without iterating all Sets.
+         *
+         * The response value is stored as a MegaSetElementList.
+         *
+         * You take the ownership of the returned value
+         *
+         * @param nodeHandle the handle of the node represented by the Elements
+         *
+         * @return Elements representing the node; an empty list if there are none
+         */
+        MegaSetElementList* getSetElementsByNode(MegaHandle nodeHandle);
+
         /**
          * @brief Returns true if the Set has been exported (has a public link)
          *
@@ -25013,6 +25140,8 @@ public:
 
     virtual size_t getCleanSizeThreshold() const = 0;
 
+    virtual size_t getMaxListingSize() const = 0;
+
     virtual size_t getMaxSize() const = 0;
 
     virtual void setCleanAgeThreshold(std::size_t seconds) = 0;
@@ -25021,6 +25150,8 @@ public:
 
     virtual void setCleanSizeThreshold(std::size_t size) = 0;
 
+    virtual void setMaxListingSize(std::size_t size) = 0;
+
     virtual void setMaxSize(std::size_t size) = 0;
 }; // MegaFuseInodeCacheFlags
 
@@ -25192,6 +25323,15 @@ public:
      */
     virtual bool getEnableAtStartup() const = 0;
 
+    /**
+     * @brief
+     * Query whether the mount uses the high-throughput session profile.
+     *
+     * @return
+     * True if the mount uses the high-throughput session profile.
+     */
+    virtual bool getHighThroughput() const = 0;
+
     /**
      * @brief
      * Retrives a mount's name.
@@ -25233,6 +25373,22 @@ public:
      */
     virtual void setEnableAtStartup(bool enable) = 0;
 
+    /**
+     * @brief
+     * Specify whether a mount should use the high-throughput session profile.
+     *
+     * When enabled, the mount negotiates asynchronous reads, large writes
+     * and more background requests with the kernel and lets the kernel
+     * cache entries and attributes of stable inodes for longer.
+     *
+     * @param highThroughput
+     * True if the mount should use the high-throughput session profile.
+     *
+     * @note
+     * This flag takes effect the next time the mount is enabled.
+     */
+    virtual void setHighThroughput(bool highThroughput) = 0;
+
     /**
      * @brief
      * Set the mount's name.
@@ -2527,6 +2527,21 @@ class TransferQueue
         void setAllCancelled(CancelToken t, int direction);
 };
 
+// A batch of transfers submitted by startUploads() or startDownloads().
+struct TransferBatch
+{
+    TransferQueue queue;
+
+    // Listener of every transfer in the batch, told once the whole batch has started.
+    MegaTransferListener* listener = nullptr;
+
+    // Is the listener also told about each transfer's start?
+    bool notifyEachStart = true;
+
+    // Copies of the transfers started so far, for MegaTransferListener::onTransfersStart.
+    vector<unique_ptr<MegaTransfer>> started;
+};
+
 #ifdef ENABLE_SYNC
 
 /**
@@ -3164,8 +3179,14 @@ class MegaApiImpl : public MegaApp
         //Transfers
         void startUploadForSupport(const char* localPath, bool isSourceFileTemporary, FileSystemType fsType, MegaTransferListener* listener);
         void startUpload(bool startFirst, const char* localPath, MegaNode* parent, const char* fileName, const char* targetUser, int64_t mtime, int folderTransferTag, bool isBackup, const char* appData, bool isSourceFileTemporary, bool forceNewUpload, FileSystemType fsType, CancelToken cancelToken, MegaTransferListener* listener);
+        void startUploads(bool startFirst, MegaStringList* localPaths, MegaNode* parent, const char* appData, CancelToken cancelToken, bool notifyEachStart, MegaTransferListener* listener);
         MegaTransferPrivate* createUploadTransfer(bool startFirst, const char *localPath, MegaNode *parent, const char *fileName, const char *targetUser, int64_t mtime, int folderTransferTag, bool isBackup, const char *appData, bool isSourceFileTemporary, bool forceNewUpload, FileSystemType fsType, CancelToken cancelToken, MegaTransferListener *listener, const FileFingerprint* preFingerprintedFile = nullptr);
         void startDownload (bool startFirst, MegaNode *node, const char* localPath, const char *customName, int folderTransferTag, const char *appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener);
+        void startDownloads(bool startFirst, MegaNodeList* nodes, const char* localFolder, const char* appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool notifyEachStart, MegaTransferListener* listener);
+
+        // Submit a batch of transfers to the SDK thread, to be started under a single lock and commit.
+        // The batch is queued behind requests and transfers submitted before it.
+        void startTransferBatch(std::shared_ptr<TransferBatch> batch);
         MegaTransferPrivate* createDownloadTransfer(bool startFirst, MegaNode *node, const char* localPath, const char *customName, int folderTransferTag, const char *appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener, FileSystemType fsType);
         void startStreaming(MegaNode* node, m_off_t startPos, m_off_t size, MegaTransferListener *listener);
         void setStreamingMinimumRate(int bytesPerSecond);
@@ -3280,6 +3301,7 @@ class MegaApiImpl : public MegaApp
         unsigned getSetElementCount(MegaHandle sid, bool includeElementsInRubbishBin);
         MegaSetElementList* getSetElements(MegaHandle sid, bool includeElementsInRubbishBin);
         MegaSetElement* getSetElement(MegaHandle sid, MegaHandle eid);
+        MegaSetElementList* getSetElementsByNode(MegaHandle nodeHandle);
         const char* getPublicLinkForExportedSet(MegaHandle sid);
         void fetchPublicSet(const char* publicSetLink, MegaRequestListener* listener = nullptr);
         MegaSet* getPublicSetInPreview();
@@ -3369,6 +3391,8 @@ class MegaApiImpl : public MegaApp
         void updateStats();
         void setLRUCacheSize(unsigned long long size);
         unsigned long long getNumNodesAtCacheLRU() const;
+        bool setFileAttributeCache(const char* path, long long maxSize);
+        double getFileAttributeCacheHitRate();
         unsigned long long getNumNodes();
         unsigned long long getAccurateNumNodes();
         long long getTotalDownloadedBytes();
@@ -3763,6 +3787,7 @@ public:
         void fetchCreditCardInfo(MegaRequestListener* listener = nullptr);
 
         void fireOnTransferStart(MegaTransferPrivate *transfer);
+        void fireOnTransfersStart(TransferBatch& batch);
         void fireOnTransferFinish(MegaTransferPrivate *transfer, unique_ptr<MegaErrorPrivate> e); // deletes `transfer` !!
         void fireOnTransferUpdate(MegaTransferPrivate *transfer);
         void fireOnFolderTransferUpdate(MegaTransferPrivate *transfer, int stage, uint32_t foldercount, uint32_t createdfoldercount, uint32_t filecount, const LocalPath* currentFolder, const LocalPath* currentFileLeafname);
@@ -3878,6 +3903,24 @@ private:
         unique_ptr<MegaNode> mLastKnownVaultNode;
         unique_ptr<MegaNode> mLastKnownRubbishNode;
 
+        // Snapshots of nodes recently returned by getNodeByHandle, so that
+        // we can answer without waiting for sdkMutex while the client is busy.
+        // Entries are only added while sdkMutex is held and are dropped as
+        // nodes_updated reports changes, so they are never older than the
+        // last completed exec().
+        mutex mNodeSnapshotsMutex;
+        map<handle, unique_ptr<MegaNode>> mNodeSnapshots;
+        static constexpr size_t MAX_NODE_SNAPSHOTS = 16384;
+
+        // Returns a copy of our snapshot of the specified node, if any.
+        MegaNode* getNodeSnapshot(handle h);
+
+        // Record a snapshot of node.  Requires sdkMutex.
+        void addNodeSnapshot(MegaNode& node);
+
+        // Drop snapshots of the specified nodes, or all snapshots if null.
+        void removeNodeSnapshots(const sharedNode_vector* nodes);
+
 #ifdef HAVE_LIBUV
         MegaHTTPServer *httpServer;
         int httpServerMaxBufferSize;
@@ -3902,6 +3945,13 @@ private:
         TransferQueue transferQueue;
         map<int, MegaRequestPrivate *> requestMap;
 
+        // Batches waiting in requestQueue, so that they can be cancelled or aborted.
+        std::mutex pendingTransferBatchesMutex;
+        set<std::shared_ptr<TransferBatch>> pendingTransferBatches;
+
+        // Batch being started by the SDK thread, if any.
+        TransferBatch* currentTransferBatch = nullptr;
+
         // sc requests to close existing wsc and immediately retrieve pending actionpackets
         RequestQueue scRequestQueue;
 
@@ -3936,10 +3986,6 @@ private:
 
         MegaTimeZoneDetails *mTimezones;
 
-        std::atomic<bool> syncPathStateLockTimeout{ false };
-        set<LocalPath> syncPathStateDeferredSet;
-        mutex syncPathStateDeferredSetMutex;
-
         int threadExit;
         void loop();
 
@@ -5218,6 +5264,8 @@ public:
 
     size_t getCleanSizeThreshold() const override;
 
+    size_t getMaxListingSize() const override;
+
     size_t getMaxSize() const override;
 
     void setCleanAgeThreshold(std::size_t seconds) override;
@@ -5226,6 +5274,8 @@ public:
 
     void setCleanSizeThreshold(std::size_t size) override;
 
+    void setMaxListingSize(std::size_t size) override;
+
     void setMaxSize(std::size_t size) override;
 }; // MegaFuseExecutorFlagsPrivate
 
@@ -5312,6 +5362,8 @@ public:
 
     const fuse::MountFlags& getFlags() const;
 
+    bool getHighThroughput() const override;
+
     const char* getName() const override;
 
     bool getPersistent() const override;
@@ -5320,6 +5372,8 @@ public:
 
     void setEnableAtStartup(bool enable) override;
 
+    void setHighThroughput(bool highThroughput) override;
+
     void setName(const char* name) override;
 
     void setPersistent(bool persistent) override;
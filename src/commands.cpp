@@ -679,6 +679,11 @@ bool CommandDirectRead::procresult(Result r, JSON& json)
                             tl = MegaClient::DEFAULT_BW_OVERQUOTA_BACKOFF_SECS;
                         }
 
+                        if (e == API_OK)
+                        {
+                            client->drUrlCache.put(drn->h, drn->tempurls, drn->size);
+                        }
+
                         drn->cmdresult(e, e == API_EOVERQUOTA ? tl * 10 : 0);
                     }
 
@@ -5096,6 +5101,8 @@ bool CommandABTestActive::procresult(Result r, JSON&)
 CommandGetUserQuota::CommandGetUserQuota(MegaClient* client, std::shared_ptr<AccountDetails> ad, bool storage, bool transfer, bool pro, int source, std::function<void(std::shared_ptr<AccountDetails>, Error)> completion)
   : details(ad), mStorage(storage), mTransfer(transfer), mPro(pro), mCompletion(std::move(completion))
 {
+    mUnordered = true;
+
     cmd("uq");
     if (storage)
     {
@@ -5723,6 +5730,9 @@ bool CommandSetPH::procresult(Result r, JSON& json)
 
 CommandGetPH::CommandGetPH(MegaClient* client, handle cph, const byte* ckey, int cop)
 {
+    // public link lookups don't touch the account
+    mUnordered = true;
+
     cmd("g");
     arg("p", (byte*)&cph, MegaClient::NODEHANDLE);
 
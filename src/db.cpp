@@ -75,25 +75,31 @@ bool DbTable::put(uint32_t type, Cacheable* record, SymmCipher* key)
 
 // get next record, decrypt and unpad
 bool DbTable::next(uint32_t* type, string* data, SymmCipher* key)
+{
+    return nextEncrypted(type, data) && decrypt(*type, data, key);
+}
+
+bool DbTable::nextEncrypted(uint32_t* type, string* data)
 {
     if (next(type, data))
     {
-        if (!*type)
-        {
-            return true;
-        }
-
         if (*type > nextid)
         {
             nextid = *type & - IDSPACING;
         }
 
-        return PaddedCBC::decrypt(data, key);
+        return true;
     }
 
     return false;
 }
 
+bool DbTable::decrypt(uint32_t type, string* data, SymmCipher* key)
+{
+    // record 0 is stored unencrypted
+    return !type || PaddedCBC::decrypt(data, key);
+}
+
 DBTableTransactionCommitter *DbTable::getTransactionCommitter() const
 {
     return mTransactionCommitter;
@@ -132,10 +138,20 @@ void DbTable::checkCommitter(DBTableTransactionCommitter*)
     assert(mTransactionCommitter);
 }
 
-const int DbAccess::LEGACY_DB_VERSION = 13;
+const int DbAccess::LEGACY_DB_VERSION = 14;
 const int DbAccess::DB_VERSION = DbAccess::LEGACY_DB_VERSION + 1;
 const int DbAccess::LAST_DB_VERSION_WITHOUT_NOD = 12;
 const int DbAccess::LAST_DB_VERSION_WITHOUT_SRW = 13;
+const int DbAccess::LAST_DB_VERSION_WITHOUT_NODE_HEADERS = 14;
+const int DbAccess::LAST_DB_VERSION_WITHOUT_NODE_COMPRESSION = 14;
+
+bool DbAccess::legacyDbRecyclable()
+{
+    return LEGACY_DB_VERSION == LAST_DB_VERSION_WITHOUT_NOD
+        || LEGACY_DB_VERSION == LAST_DB_VERSION_WITHOUT_SRW
+        || LEGACY_DB_VERSION == LAST_DB_VERSION_WITHOUT_NODE_HEADERS
+        || LEGACY_DB_VERSION == LAST_DB_VERSION_WITHOUT_NODE_COMPRESSION;
+}
 
 DbAccess::DbAccess()
 {
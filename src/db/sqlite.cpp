@@ -23,9 +23,518 @@
 
 #include <numeric>
 
+#ifdef HAVE_ZSTD
+#include <zdict.h>
+#include <zstd.h>
+#endif // HAVE_ZSTD
+
 #ifdef USE_SQLITE
 namespace mega {
 
+// Compresses node records using a dictionary trained on the account's own
+// nodes. Serialized nodes are small and highly repetitive so without a
+// dictionary there's little for a compressor to work with.
+//
+// Compressed records begin with a marker that can't begin a serialized node
+// which means compressed and uncompressed records can live side by side.
+//
+// Opening a database only loads its dictionary. Training a dictionary and
+// compressing existing records happens a little at a time, as the database
+// commits, so that opening a large account isn't held up.
+class SqliteNodeCodec
+{
+    // Prefixes every compressed record.
+    static constexpr m_off_t MARKER = NodeData::RECORD_MARKER + 256;
+
+    // How many records we must have before we'll train a dictionary.
+    static constexpr int MIN_SAMPLES = 1024;
+
+    // How many records we'll feed into the trainer at most.
+    static constexpr int MAX_SAMPLES = 16384;
+
+    // How large a dictionary may be.
+    static constexpr size_t MAX_DICTIONARY_SIZE = 112640;
+
+    // How many records we compress each time the database commits.
+    static constexpr int MIGRATION_BATCH_SIZE = 1024;
+
+    // Check whether a stored record is compressed.
+    static bool compressed(const char* data, size_t size);
+
+#ifdef HAVE_ZSTD
+    // Train a new dictionary from the records in the database.
+    bool train(string& dictionary);
+
+    // Make dictionary our active dictionary.
+    bool use(const string& dictionary);
+
+    ZSTD_CCtx* mCompressor = nullptr;
+    ZSTD_CDict* mCompressionDictionary = nullptr;
+    ZSTD_DCtx* mDecompressor = nullptr;
+    ZSTD_DDict* mDecompressionDictionary = nullptr;
+    unsigned mDictionaryID = 0;
+
+    // Records written since we last tried to train a dictionary.
+    //
+    // Starts out high enough that we'll try once per session.
+    int mNumWritten = MIN_SAMPLES;
+
+    // Handle of the last record we've examined during migration.
+    int64_t mMigrationPosition = std::numeric_limits<int64_t>::min();
+
+    // Have we examined every record?
+    bool mMigrated = false;
+#endif // HAVE_ZSTD
+
+    sqlite3* mDB;
+
+    // Serializes access to our (de)compression contexts.
+    std::mutex mLock;
+
+public:
+    explicit SqliteNodeCodec(sqlite3* db);
+
+    ~SqliteNodeCodec();
+
+    // Compress record in place.
+    //
+    // Returns false, leaving record unchanged, if it isn't worth compressing
+    // or we have no dictionary to compress it with.
+    bool compress(string& record);
+
+    // Copy a record out of the database, decompressing it if necessary.
+    bool decompress(const void* data, size_t size, string& record);
+
+    // Load the database's dictionary, if it has one.
+    bool load();
+
+    // Compress a batch of records still stored uncompressed.
+    //
+    // Must be called within a transaction.
+    bool migrate();
+
+    // Train and store a dictionary if we have none and enough records.
+    //
+    // Must be called outside of a transaction as the dictionary has to be
+    // stored before any record is compressed with it.
+    bool prepare();
+}; // SqliteNodeCodec
+
+SqliteNodeCodec::SqliteNodeCodec(sqlite3* db)
+  : mDB(db)
+{
+}
+
+SqliteNodeCodec::~SqliteNodeCodec()
+{
+#ifdef HAVE_ZSTD
+    ZSTD_freeCCtx(mCompressor);
+    ZSTD_freeCDict(mCompressionDictionary);
+    ZSTD_freeDCtx(mDecompressor);
+    ZSTD_freeDDict(mDecompressionDictionary);
+#endif // HAVE_ZSTD
+}
+
+bool SqliteNodeCodec::compressed(const char* data, size_t size)
+{
+    return data && size >= sizeof(MARKER) && MemAccess::get<m_off_t>(data) == MARKER;
+}
+
+bool SqliteNodeCodec::compress(string& record)
+{
+#ifdef HAVE_ZSTD
+    std::lock_guard<std::mutex> guard(mLock);
+
+    if (!mCompressionDictionary)
+    {
+        ++mNumWritten;
+        return false;
+    }
+
+    string compressed(sizeof(MARKER) + ZSTD_compressBound(record.size()), '\0');
+
+    MemAccess::set<m_off_t>(reinterpret_cast<byte*>(&compressed[0]), MARKER);
+
+    auto size = ZSTD_compress_usingCDict(mCompressor,
+                                         &compressed[sizeof(MARKER)],
+                                         compressed.size() - sizeof(MARKER),
+                                         record.data(),
+                                         record.size(),
+                                         mCompressionDictionary);
+
+    if (ZSTD_isError(size))
+    {
+        LOG_warn << "Unable to compress node record: " << ZSTD_getErrorName(size);
+        return false;
+    }
+
+    // Not worth storing the record compressed.
+    if (sizeof(MARKER) + size >= record.size())
+    {
+        return false;
+    }
+
+    compressed.resize(sizeof(MARKER) + size);
+    record = std::move(compressed);
+
+    return true;
+#else // HAVE_ZSTD
+    static_cast<void>(record);
+    return false;
+#endif // ! HAVE_ZSTD
+}
+
+bool SqliteNodeCodec::decompress(const void* data, size_t size, string& record)
+{
+    auto begin = static_cast<const char*>(data);
+
+    // Record's stored uncompressed.
+    if (!compressed(begin, size))
+    {
+        record.assign(begin, size);
+        return true;
+    }
+
+#ifdef HAVE_ZSTD
+    begin += sizeof(MARKER);
+    size -= sizeof(MARKER);
+
+    auto length = ZSTD_getFrameContentSize(begin, size);
+
+    if (length == ZSTD_CONTENTSIZE_ERROR || length == ZSTD_CONTENTSIZE_UNKNOWN)
+    {
+        LOG_err << "Compressed node record is malformed";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(mLock);
+
+    if (!mDecompressionDictionary || ZSTD_getDictID_fromFrame(begin, size) != mDictionaryID)
+    {
+        LOG_err << "Node record was compressed with an unknown dictionary";
+        return false;
+    }
+
+    record.resize(static_cast<size_t>(length));
+
+    auto result = ZSTD_decompress_usingDDict(mDecompressor,
+                                             &record[0],
+                                             record.size(),
+                                             begin,
+                                             size,
+                                             mDecompressionDictionary);
+
+    if (ZSTD_isError(result) || result != length)
+    {
+        LOG_err << "Unable to decompress node record: "
+                << (ZSTD_isError(result) ? ZSTD_getErrorName(result) : "length mismatch");
+        record.clear();
+        return false;
+    }
+
+    return true;
+#else // HAVE_ZSTD
+    LOG_err << "Unable to decompress node record: zstd support is not available";
+    return false;
+#endif // ! HAVE_ZSTD
+}
+
+bool SqliteNodeCodec::load()
+{
+    const char* sql = "CREATE TABLE IF NOT EXISTS nodedictionary (id int64 PRIMARY KEY NOT NULL, dictionary BLOB NOT NULL)";
+
+    if (sqlite3_exec(mDB, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while creating node dictionary table: " << sqlite3_errmsg(mDB);
+        return false;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+
+    if (sqlite3_prepare_v2(mDB, "SELECT dictionary FROM nodedictionary LIMIT 1", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while preparing to load node dictionary: " << sqlite3_errmsg(mDB);
+        return false;
+    }
+
+    string dictionary;
+
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        auto data = static_cast<const char*>(sqlite3_column_blob(stmt, 0));
+        auto size = sqlite3_column_bytes(stmt, 0);
+
+        if (data && size > 0)
+        {
+            dictionary.assign(data, static_cast<size_t>(size));
+        }
+    }
+
+    sqlite3_finalize(stmt);
+
+#ifdef HAVE_ZSTD
+    // Dictionary's trained later, once we have enough records.
+    if (dictionary.empty())
+    {
+        return true;
+    }
+
+    return use(dictionary);
+#else // HAVE_ZSTD
+    // Records in this database can't be read without zstd.
+    if (!dictionary.empty())
+    {
+        LOG_err << "Database contains compressed nodes but zstd support is not available";
+        return false;
+    }
+
+    return true;
+#endif // ! HAVE_ZSTD
+}
+
+bool SqliteNodeCodec::migrate()
+{
+#ifdef HAVE_ZSTD
+    // Nothing to compress with or nothing left to compress.
+    if (!mCompressionDictionary || mMigrated)
+    {
+        return true;
+    }
+
+    sqlite3_stmt* select = nullptr;
+    sqlite3_stmt* update = nullptr;
+
+    auto finalize = [&]() {
+        sqlite3_finalize(select);
+        sqlite3_finalize(update);
+    };
+
+    if (sqlite3_prepare_v2(mDB, "SELECT nodehandle, node FROM nodes WHERE nodehandle > ? ORDER BY nodehandle LIMIT ?", -1, &select, nullptr) != SQLITE_OK
+        || sqlite3_prepare_v2(mDB, "UPDATE nodes SET node = ? WHERE nodehandle = ?", -1, &update, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while preparing to compress nodes: " << sqlite3_errmsg(mDB);
+        finalize();
+        return false;
+    }
+
+    std::vector<std::pair<int64_t, string>> records;
+    int numSelected = 0;
+
+    sqlite3_bind_int64(select, 1, mMigrationPosition);
+    sqlite3_bind_int(select, 2, MIGRATION_BATCH_SIZE);
+
+    // Collect the batch before modifying the table.
+    while (sqlite3_step(select) == SQLITE_ROW)
+    {
+        auto data = static_cast<const char*>(sqlite3_column_blob(select, 1));
+        auto size = static_cast<size_t>(sqlite3_column_bytes(select, 1));
+
+        mMigrationPosition = sqlite3_column_int64(select, 0);
+
+        ++numSelected;
+
+        if (!data || compressed(data, size))
+        {
+            continue;
+        }
+
+        string record(data, size);
+
+        // Not worth compressing.
+        if (!compress(record))
+        {
+            continue;
+        }
+
+        records.emplace_back(mMigrationPosition, std::move(record));
+    }
+
+    for (auto& r : records)
+    {
+        sqlite3_bind_blob(update, 1, r.second.data(), static_cast<int>(r.second.size()), SQLITE_STATIC);
+        sqlite3_bind_int64(update, 2, r.first);
+
+        auto result = sqlite3_step(update);
+
+        sqlite3_reset(update);
+
+        if (result != SQLITE_DONE)
+        {
+            LOG_err << "Db error while compressing nodes: " << sqlite3_errmsg(mDB);
+            finalize();
+            return false;
+        }
+    }
+
+    finalize();
+
+    // Freed pages are reused by later writes so there's no need to vacuum.
+    mMigrated = numSelected < MIGRATION_BATCH_SIZE;
+
+    LOG_debug << "Compressed " << records.size()
+              << " of " << numSelected
+              << " node(s)"
+              << (mMigrated ? ", migration complete" : "");
+
+    return true;
+#else // HAVE_ZSTD
+    return true;
+#endif // ! HAVE_ZSTD
+}
+
+bool SqliteNodeCodec::prepare()
+{
+#ifdef HAVE_ZSTD
+    // We already have a dictionary or too few records have been written
+    // since we last tried to train one.
+    if (mCompressionDictionary || mNumWritten < MIN_SAMPLES)
+    {
+        return true;
+    }
+
+    mNumWritten = 0;
+
+    string dictionary;
+
+    if (!train(dictionary) || dictionary.empty())
+    {
+        return true;
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+
+    if (sqlite3_prepare_v2(mDB, "INSERT INTO nodedictionary (id, dictionary) VALUES (?, ?)", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while preparing to store node dictionary: " << sqlite3_errmsg(mDB);
+        return false;
+    }
+
+    sqlite3_bind_int64(stmt, 1, ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size()));
+    sqlite3_bind_blob(stmt, 2, dictionary.data(), static_cast<int>(dictionary.size()), SQLITE_STATIC);
+
+    auto result = sqlite3_step(stmt);
+
+    sqlite3_finalize(stmt);
+
+    if (result != SQLITE_DONE)
+    {
+        LOG_err << "Db error while storing node dictionary: " << sqlite3_errmsg(mDB);
+        return false;
+    }
+
+    return use(dictionary);
+#else // HAVE_ZSTD
+    return true;
+#endif // ! HAVE_ZSTD
+}
+
+#ifdef HAVE_ZSTD
+
+bool SqliteNodeCodec::train(string& dictionary)
+{
+    sqlite3_stmt* stmt = nullptr;
+
+    if (sqlite3_prepare_v2(mDB, "SELECT COUNT(*) FROM nodes", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while preparing to count nodes: " << sqlite3_errmsg(mDB);
+        return false;
+    }
+
+    int64_t count = 0;
+
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        count = sqlite3_column_int64(stmt, 0);
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (count < MIN_SAMPLES)
+    {
+        return true;
+    }
+
+    // Spread our samples evenly across the table.
+    if (sqlite3_prepare_v2(mDB, "SELECT node FROM nodes WHERE rowid % ? = 0 LIMIT ?", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        LOG_err << "Db error while preparing to sample nodes: " << sqlite3_errmsg(mDB);
+        return false;
+    }
+
+    sqlite3_bind_int64(stmt, 1, std::max<int64_t>(1, count / MAX_SAMPLES));
+    sqlite3_bind_int(stmt, 2, MAX_SAMPLES);
+
+    string samples;
+    std::vector<size_t> sizes;
+
+    sizes.reserve(MAX_SAMPLES);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        auto data = static_cast<const char*>(sqlite3_column_blob(stmt, 0));
+        auto size = sqlite3_column_bytes(stmt, 0);
+
+        if (data && size > 0)
+        {
+            samples.append(data, static_cast<size_t>(size));
+            sizes.emplace_back(static_cast<size_t>(size));
+        }
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (sizes.size() < static_cast<size_t>(MIN_SAMPLES))
+    {
+        return true;
+    }
+
+    dictionary.resize(MAX_DICTIONARY_SIZE);
+
+    auto size = ZDICT_trainFromBuffer(&dictionary[0],
+                                      dictionary.size(),
+                                      samples.data(),
+                                      sizes.data(),
+                                      static_cast<unsigned>(sizes.size()));
+
+    if (ZDICT_isError(size))
+    {
+        // Not fatal: we'll just keep storing records uncompressed.
+        LOG_warn << "Unable to train node dictionary: " << ZDICT_getErrorName(size);
+        dictionary.clear();
+        return true;
+    }
+
+    dictionary.resize(size);
+
+    LOG_info << "Trained a " << size << " byte node dictionary from " << sizes.size() << " node(s)";
+
+    return true;
+}
+
+bool SqliteNodeCodec::use(const string& dictionary)
+{
+    std::lock_guard<std::mutex> guard(mLock);
+
+    assert(!mCompressionDictionary && !mDecompressionDictionary);
+
+    mCompressor = ZSTD_createCCtx();
+    mCompressionDictionary = ZSTD_createCDict(dictionary.data(), dictionary.size(), ZSTD_CLEVEL_DEFAULT);
+    mDecompressor = ZSTD_createDCtx();
+    mDecompressionDictionary = ZSTD_createDDict(dictionary.data(), dictionary.size());
+    mDictionaryID = ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+
+    if (mCompressor && mCompressionDictionary && mDecompressor && mDecompressionDictionary)
+    {
+        return true;
+    }
+
+    LOG_err << "Unable to load node dictionary";
+
+    return false;
+}
+
+#endif // HAVE_ZSTD
+
 SqliteDbAccess::SqliteDbAccess(const LocalPath& rootPath)
   : mRootPath(rootPath)
 {
@@ -72,7 +581,7 @@ bool SqliteDbAccess::checkDbFileAndAdjustLegacy(FileSystemAccess& fsAccess, cons
             LOG_debug << "Found legacy database at: " << legacyPath;
 
             // if current version, use that one... unless migration to NoD or renaming to adapt the version to SRW are required
-            if (currentDbVersion == LEGACY_DB_VERSION && LEGACY_DB_VERSION != LAST_DB_VERSION_WITHOUT_NOD && LEGACY_DB_VERSION != LAST_DB_VERSION_WITHOUT_SRW)
+            if (currentDbVersion == LEGACY_DB_VERSION && !legacyDbRecyclable())
             {
                 LOG_debug << "Using a legacy database.";
                 dbPath = std::move(legacyPath);
@@ -160,6 +669,15 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
         return nullptr;
     }
 
+    // Load the dictionary used to compress node records, if there is one.
+    auto codec = std::make_unique<SqliteNodeCodec>(db);
+
+    if (!codec->load())
+    {
+        sqlite3_close(db);
+        return nullptr;
+    }
+
     // Add following columns to existing 'nodes' table that might not have them, and populate them if needed:
     vector<NewColumn> newCols{
         {"mtime",
@@ -185,7 +703,7 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
         };
 
 
-    if (!addAndPopulateColumns(db, std::move(newCols)))
+    if (!addAndPopulateColumns(db, std::move(newCols), *codec))
     {
         sqlite3_close(db);
         return nullptr;
@@ -240,7 +758,8 @@ DbTable *SqliteDbAccess::openTableWithNodes(PrnGen &rng, FileSystemAccess &fsAcc
                                 fsAccess,
                                 dbPath,
                                 (flags & DB_OPEN_FLAG_TRANSACTED) > 0,
-                                std::move(dBErrorCallBack));
+                                std::move(dBErrorCallBack),
+                                std::move(codec));
 }
 
 bool SqliteDbAccess::probe(FileSystemAccess& fsAccess, const string& name) const
@@ -380,7 +899,7 @@ void SqliteDbAccess::removeDBFiles(FileSystemAccess& fsAccess, mega::LocalPath&
 
 }
 
-bool SqliteDbAccess::addAndPopulateColumns(sqlite3* db, vector<NewColumn>&& newCols)
+bool SqliteDbAccess::addAndPopulateColumns(sqlite3* db, vector<NewColumn>&& newCols, SqliteNodeCodec& codec)
 {
     // skip existing columns
     if (!stripExistingColumns(db, newCols))
@@ -397,7 +916,7 @@ bool SqliteDbAccess::addAndPopulateColumns(sqlite3* db, vector<NewColumn>&& newC
         }
     }
 
-    return migrateDataToColumns(db, std::move(newCols));
+    return migrateDataToColumns(db, std::move(newCols), codec);
 }
 
 bool SqliteDbAccess::stripExistingColumns(sqlite3* db, vector<NewColumn>& cols)
@@ -442,7 +961,7 @@ bool SqliteDbAccess::addColumn(sqlite3* db, const string& name, const string& ty
     return true;
 }
 
-bool SqliteDbAccess::migrateDataToColumns(sqlite3* db, vector<NewColumn>&& cols)
+bool SqliteDbAccess::migrateDataToColumns(sqlite3* db, vector<NewColumn>&& cols, SqliteNodeCodec& codec)
 {
     if (cols.empty()) return true;
 
@@ -466,12 +985,18 @@ bool SqliteDbAccess::migrateDataToColumns(sqlite3* db, vector<NewColumn>&& cols)
     map<handle, std::vector<std::unique_ptr<MigrateType>>> newValues;
     uint64_t numRows = 0;
     uint64_t affectedRows = 0;
+    string record;
     while (sqlite3_step(stmt) == SQLITE_ROW)
     {
-        const char* blob = static_cast<const char*>(sqlite3_column_blob(stmt, 1));
+        const void* blob = sqlite3_column_blob(stmt, 1);
         int blobSize = sqlite3_column_bytes(stmt, 1);
         handle nh = sqlite3_column_int64(stmt, 0);
-        NodeData nd(blob, blobSize, NodeData::COMPONENT_ATTRS);
+        if (!codec.decompress(blob, static_cast<size_t>(blobSize), record))
+        {
+            continue;
+        }
+
+        NodeData nd(record.data(), record.size(), NodeData::COMPONENT_ATTRS);
 
         std::vector<std::unique_ptr<MigrateType>> migrateElement;
         migrateElement.reserve(cols.size());
@@ -889,9 +1414,11 @@ void SqliteDbTable::errorHandler(int sqliteError, const string& operation, bool
     }
 }
 
-SqliteAccountState::SqliteAccountState(PrnGen &rng, sqlite3 *pdb, FileSystemAccess &fsAccess, const LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack)
+SqliteAccountState::SqliteAccountState(PrnGen &rng, sqlite3 *pdb, FileSystemAccess &fsAccess, const LocalPath &path, const bool checkAlwaysTransacted, DBErrorCallback dBErrorCallBack, std::unique_ptr<SqliteNodeCodec> codec)
     : SqliteDbTable(rng, pdb, fsAccess, path, checkAlwaysTransacted, dBErrorCallBack)
+    , mCodec(std::move(codec))
 {
+    assert(mCodec);
 }
 
 SqliteAccountState::~SqliteAccountState()
@@ -899,6 +1426,23 @@ SqliteAccountState::~SqliteAccountState()
     finalise();
 }
 
+void SqliteAccountState::commit()
+{
+    // Compress another batch of the records stored before we had a dictionary.
+    if (db && !mCodec->migrate())
+    {
+        LOG_warn << "Unable to compress node records in " << dbfile;
+    }
+
+    SqliteDbTable::commit();
+
+    // Train a dictionary if we now have enough records to do so.
+    if (db && !mCodec->prepare())
+    {
+        LOG_warn << "Unable to prepare node dictionary in " << dbfile;
+    }
+}
+
 int SqliteAccountState::progressHandler(void *param)
 {
     CancelToken* cancelFlag = static_cast<CancelToken*>(param);
@@ -927,9 +1471,8 @@ bool SqliteAccountState::processSqlQueryNodes(sqlite3_stmt *stmt, std::vector<st
         // blob node
         data = sqlite3_column_blob(stmt, 2);
         size = sqlite3_column_bytes(stmt, 2);
-        if (data && size)
+        if (data && size && mCodec->decompress(data, static_cast<size_t>(size), node.mNode))
         {
-            node.mNode = std::string(static_cast<const char*>(data), size);
             nodes.insert(nodes.end(), std::make_pair(nodeHandle, std::move(node)));
         }
     }
@@ -1163,6 +1706,12 @@ void SqliteAccountState::finalise()
     sqlite3_finalize(mStmtIsAncestor);
     mStmtIsAncestor = nullptr;
 
+    sqlite3_finalize(mStmtAddAncestryCandidate);
+    mStmtAddAncestryCandidate = nullptr;
+
+    sqlite3_finalize(mStmtAncestry);
+    mStmtAncestry = nullptr;
+
     sqlite3_finalize(mStmtNumChild);
     mStmtNumChild = nullptr;
 
@@ -1196,6 +1745,9 @@ bool SqliteAccountState::put(Node *node)
         node->serialize(&nodeSerialized);
         assert(nodeSerialized.size());
 
+        // Store the record compressed when it's worthwhile.
+        mCodec->compress(nodeSerialized);
+
         sqlite3_bind_int64(mStmtPutNode, 1, node->nodehandle);
         sqlite3_bind_int64(mStmtPutNode, 2, node->parenthandle);
 
@@ -1309,8 +1861,9 @@ bool SqliteAccountState::getNode(NodeHandle nodehandle, NodeSerialized &nodeSeri
                 if (dataNodeCounter && sizeNodeCounter && dataNodeSerialized && sizeNodeSerialized)
                 {
                     nodeSerialized.mNodeCounter.assign(static_cast<const char*>(dataNodeCounter), sizeNodeCounter);
-                    nodeSerialized.mNode.assign(static_cast<const char*>(dataNodeSerialized), sizeNodeSerialized);
-                    success = true;
+                    success = mCodec->decompress(dataNodeSerialized,
+                                                 static_cast<size_t>(sizeNodeSerialized),
+                                                 nodeSerialized.mNode);
                 }
             }
         }
@@ -2009,6 +2562,42 @@ bool SqliteAccountState::getNodeByFingerprint(const std::string &fingerprint, me
     return result;
 }
 
+bool SqliteAccountState::getFingerprints(std::function<void(const std::string&)> callback)
+{
+    if (!db)
+    {
+        return false;
+    }
+
+    sqlite3_stmt *stmt = nullptr;
+    int sqlResult = sqlite3_prepare_v2(db, "SELECT fingerprint FROM nodes WHERE type = ?", -1, &stmt, NULL);
+    if (sqlResult == SQLITE_OK)
+    {
+        if ((sqlResult = sqlite3_bind_int(stmt, 1, FILENODE)) == SQLITE_OK)
+        {
+            std::string fingerprint;
+
+            while ((sqlResult = sqlite3_step(stmt)) == SQLITE_ROW)
+            {
+                const void* data = sqlite3_column_blob(stmt, 0);
+                int size = sqlite3_column_bytes(stmt, 0);
+
+                fingerprint.assign(static_cast<const char*>(data), static_cast<size_t>(size));
+                callback(fingerprint);
+            }
+        }
+    }
+
+    if (sqlResult != SQLITE_DONE)
+    {
+        errorHandler(sqlResult, "Get fingerprints", false);
+    }
+
+    sqlite3_finalize(stmt);
+
+    return sqlResult == SQLITE_DONE;
+}
+
 bool SqliteAccountState::getRecentNodes(unsigned maxcount, m_time_t since, std::vector<std::pair<NodeHandle, NodeSerialized>>& nodes)
 {
     if (!db)
@@ -2229,6 +2818,142 @@ bool SqliteAccountState::isAncestor(NodeHandle node, NodeHandle ancestor, Cancel
     return result;
 }
 
+bool SqliteAccountState::filterByAncestor(NodeHandle ancestor, const std::vector<NodeHandle>& nodes, std::set<NodeHandle>& descendants, CancelToken cancelFlag)
+{
+    if (!db)
+    {
+        return false;
+    }
+
+    // Stage the nodes we're interested in so they can be joined against.
+    int sqlResult = sqlite3_exec(db, "CREATE TEMP TABLE IF NOT EXISTS ancestrycandidates (nodehandle int64 PRIMARY KEY NOT NULL)", nullptr, nullptr, nullptr);
+
+    if (sqlResult == SQLITE_OK)
+    {
+        sqlResult = sqlite3_exec(db, "DELETE FROM temp.ancestrycandidates", nullptr, nullptr, nullptr);
+    }
+
+    if (sqlResult == SQLITE_OK && !mStmtAddAncestryCandidate)
+    {
+        sqlResult = sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO temp.ancestrycandidates (nodehandle) VALUES (?)", -1, &mStmtAddAncestryCandidate, NULL);
+    }
+
+    for (auto i = nodes.begin(); sqlResult == SQLITE_OK && i != nodes.end(); ++i)
+    {
+        if ((sqlResult = sqlite3_bind_int64(mStmtAddAncestryCandidate, 1, i->as8byte())) == SQLITE_OK)
+        {
+            sqlResult = sqlite3_step(mStmtAddAncestryCandidate);
+            sqlResult = sqlResult == SQLITE_DONE ? SQLITE_OK : sqlResult;
+        }
+
+        sqlite3_reset(mStmtAddAncestryCandidate);
+    }
+
+    if (sqlResult != SQLITE_OK)
+    {
+        errorHandler(sqlResult, "Filter by ancestor", false);
+        return false;
+    }
+
+    // Walk up from every candidate at once, visiting each shared ancestor
+    // only once and stopping as soon as we reach the ancestor we're after.
+    std::string sqlQuery = "WITH RECURSIVE ancestry(nodehandle, parenthandle) "
+            "AS (SELECT N.nodehandle, N.parenthandle FROM temp.ancestrycandidates AS C CROSS JOIN nodes AS N ON (N.nodehandle = C.nodehandle) "
+            "UNION SELECT N.nodehandle, N.parenthandle FROM ancestry AS A CROSS JOIN nodes AS N ON (N.nodehandle = A.parenthandle) "
+            "WHERE A.parenthandle != ?) "
+            "SELECT nodehandle, parenthandle FROM ancestry";
+
+    if (cancelFlag.exists())
+    {
+        sqlite3_progress_handler(db, NUM_VIRTUAL_MACHINE_INSTRUCTIONS, SqliteAccountState::progressHandler, static_cast<void*>(&cancelFlag));
+    }
+
+    if (!mStmtAncestry)
+    {
+        sqlResult = sqlite3_prepare_v2(db, sqlQuery.c_str(), -1, &mStmtAncestry, NULL);
+    }
+
+    std::map<handle, handle> parents;
+
+    if (sqlResult == SQLITE_OK)
+    {
+        if ((sqlResult = sqlite3_bind_int64(mStmtAncestry, 1, ancestor.as8byte())) == SQLITE_OK)
+        {
+            while ((sqlResult = sqlite3_step(mStmtAncestry)) == SQLITE_ROW)
+            {
+                parents.emplace(sqlite3_column_int64(mStmtAncestry, 0),
+                                sqlite3_column_int64(mStmtAncestry, 1));
+            }
+        }
+    }
+
+    // unregister the handler (no-op if not registered)
+    sqlite3_progress_handler(db, -1, nullptr, nullptr);
+
+    sqlite3_reset(mStmtAncestry);
+
+    sqlite3_exec(db, "DELETE FROM temp.ancestrycandidates", nullptr, nullptr, nullptr);
+
+    if (sqlResult != SQLITE_DONE)
+    {
+        errorHandler(sqlResult, "Filter by ancestor", true);
+        return false;
+    }
+
+    // Resolve each candidate, remembering the answer for every node on its path.
+    std::map<handle, bool> below;
+    std::vector<handle> path;
+
+    for (auto& node : nodes)
+    {
+        auto current = node.as8byte();
+        auto result = false;
+
+        path.clear();
+
+        while (true)
+        {
+            // Marking the node up front also protects us from cycles.
+            auto known = below.emplace(current, false);
+
+            if (!known.second)
+            {
+                result = known.first->second;
+                break;
+            }
+
+            path.emplace_back(current);
+
+            auto parent = parents.find(current);
+
+            if (parent == parents.end())
+            {
+                break;
+            }
+
+            if (parent->second == ancestor.as8byte())
+            {
+                result = true;
+                break;
+            }
+
+            current = parent->second;
+        }
+
+        for (auto h : path)
+        {
+            below[h] = result;
+        }
+
+        if (result)
+        {
+            descendants.emplace(node);
+        }
+    }
+
+    return true;
+}
+
 uint64_t SqliteAccountState::getNumberOfNodes()
 {
     uint64_t count = 0;
@@ -19,6 +19,8 @@
  * program.
  */
 
+#include <algorithm>
+
 #include "mega/fileattributefetch.h"
 #include "mega/megaclient.h"
 #include "mega/megaapp.h"
@@ -145,11 +147,7 @@ void FileAttributeFetchChannel::parse(int /*fac*/, bool final)
                 SymmCipher *cipher = client->getRecycledTemporaryNodeCipher(&it->second->nodekey);
                 if (cipher)
                 {
-                    if (!cipher->cbc_decrypt((byte*)ptr, falen))
-                    {
-                        LOG_err << "Failed to CBC decrypt file attributes";
-                    }
-                    client->app->fa_complete(it->second->nodehandle, it->second->type, ptr, falen);
+                    complete(h, *it->second, cipher->cbc_decrypt((byte*)ptr, falen), ptr, falen);
                 }
 
                 delete it->second;
@@ -161,6 +159,21 @@ void FileAttributeFetchChannel::parse(int /*fac*/, bool final)
     }
 }
 
+// hand a received attribute to the application, caching it only if it was decrypted
+void FileAttributeFetchChannel::complete(handle fah, const FileAttributeFetch& fetch, bool decrypted, const char* data, uint32_t length)
+{
+    if (decrypted)
+    {
+        client->faCache.put(fah, fetch.type, data, length);
+    }
+    else
+    {
+        LOG_err << "Failed to CBC decrypt file attributes";
+    }
+
+    client->app->fa_complete(fetch.nodehandle, fetch.type, data, length);
+}
+
 // notify the application of the request failure and remove records no longer needed
 void FileAttributeFetchChannel::failed()
 {
@@ -186,4 +199,220 @@ void FileAttributeFetchChannel::failed()
         }
     }
 }
+FileAttributeCache::FileAttributeCache(FileSystemAccess& fsAccess)
+  : mFsAccess(fsAccess)
+{
+}
+
+bool FileAttributeCache::enable(const LocalPath& path, m_off_t budget)
+{
+    mEntries.clear();
+    mLRU.clear();
+    mSize = 0;
+    mPath = path;
+    mBudget = budget;
+
+    if (mPath.empty())
+    {
+        return true;
+    }
+
+    mFsAccess.mkdirlocal(mPath, false, false);
+
+    auto da = mFsAccess.newdiraccess();
+    LocalPath dirPath = mPath;
+
+    if (!da->dopen(&dirPath, nullptr, false))
+    {
+        LOG_err << "Unable to open the file attribute cache: " << mPath;
+        mPath = LocalPath();
+        return false;
+    }
+
+    // recover the attributes cached previously, oldest first
+    std::multimap<m_time_t, std::pair<string, m_off_t>> existing;
+    LocalPath name;
+    nodetype_t type;
+
+    while (da->dnext(dirPath, name, false, &type))
+    {
+        // only adopt files that we could have written ourselves
+        if (type != FILENODE || !isName(name.toPath(false)))
+        {
+            continue;
+        }
+
+        auto fa = mFsAccess.newfileaccess();
+        auto filePath = mPath;
+
+        filePath.appendWithSeparator(name, false);
+
+        if (fa->fopen(filePath, FSLogging::logOnError))
+        {
+            existing.emplace(fa->mtime, std::make_pair(name.toPath(false), fa->size));
+        }
+    }
+
+    for (auto& i : existing)
+    {
+        add(i.second.first, i.second.second);
+    }
+
+    evict();
+
+    LOG_debug << "File attribute cache enabled with " << mEntries.size() << " attribute(s), " << mSize << " bytes";
+
+    return true;
+}
+
+bool FileAttributeCache::enabled() const
+{
+    return !mPath.empty();
+}
+
+bool FileAttributeCache::get(handle fah, fatype type, string& data)
+{
+    if (!enabled())
+    {
+        return false;
+    }
+
+    auto name = nameOf(fah, type);
+    auto it = mEntries.find(name);
+
+    if (it == mEntries.end())
+    {
+        ++misses;
+        return false;
+    }
+
+    auto filePath = mPath;
+    filePath.appendWithSeparator(LocalPath::fromRelativePath(name), false);
+
+    auto fa = mFsAccess.newfileaccess();
+
+    if (!fa->fopen(filePath, true, false, FSLogging::logOnError)
+        || !fa->fread(&data, static_cast<unsigned>(it->second.size), 0, 0, FSLogging::logOnError))
+    {
+        // removed or damaged behind our back
+        fa.reset();
+        remove(name);
+        ++misses;
+        return false;
+    }
+
+    fa.reset();
+
+    // so the order survives restarts
+    mFsAccess.setmtimelocal(filePath, m_time());
+    mLRU.splice(mLRU.end(), mLRU, it->second.lru);
+
+    ++hits;
+    return true;
+}
+
+void FileAttributeCache::put(handle fah, fatype type, const char* data, size_t length)
+{
+    if (!enabled() || static_cast<m_off_t>(length) > mBudget)
+    {
+        return;
+    }
+
+    auto name = nameOf(fah, type);
+
+    remove(name);
+
+    auto filePath = mPath;
+    filePath.appendWithSeparator(LocalPath::fromRelativePath(name), false);
+
+    auto fa = mFsAccess.newfileaccess();
+
+    if (!fa->fopen(filePath, false, true, FSLogging::logOnError)
+        || !fa->fwrite(reinterpret_cast<const byte*>(data), static_cast<unsigned>(length), 0))
+    {
+        fa.reset();
+        mFsAccess.unlinklocal(filePath);
+        return;
+    }
+
+    fa.reset();
+
+    add(name, static_cast<m_off_t>(length));
+    evict();
+}
+
+m_off_t FileAttributeCache::size() const
+{
+    return mSize;
+}
+
+string FileAttributeCache::nameOf(handle fah, fatype type)
+{
+    return string(Base64Str<sizeof(fah)>((const byte*)&fah)) + "." + std::to_string(type);
+}
+
+bool FileAttributeCache::isName(const string& name)
+{
+    auto dot = name.find('.');
+
+    if (dot == string::npos || dot + 1 == name.size())
+    {
+        return false;
+    }
+
+    handle fah = 0;
+
+    if (Base64::atob(name.substr(0, dot).c_str(), (byte*)&fah, sizeof(fah)) != sizeof(fah))
+    {
+        return false;
+    }
+
+    auto suffix = name.substr(dot + 1);
+
+    if (suffix.size() > 5 || !std::all_of(suffix.begin(), suffix.end(), [](char c) { return c >= '0' && c <= '9'; }))
+    {
+        return false;
+    }
+
+    // reject anything we wouldn't have named this way, such as padded or out of range values
+    return nameOf(fah, static_cast<fatype>(std::stoul(suffix))) == name;
+}
+
+void FileAttributeCache::add(const string& name, m_off_t size)
+{
+    auto& entry = mEntries[name];
+
+    entry.size = size;
+    entry.lru = mLRU.insert(mLRU.end(), name);
+
+    mSize += size;
+}
+
+void FileAttributeCache::remove(const string& name)
+{
+    auto it = mEntries.find(name);
+
+    if (it == mEntries.end())
+    {
+        return;
+    }
+
+    auto filePath = mPath;
+    filePath.appendWithSeparator(LocalPath::fromRelativePath(name), false);
+
+    mFsAccess.unlinklocal(filePath);
+
+    mSize -= it->second.size;
+    mLRU.erase(it->second.lru);
+    mEntries.erase(it);
+}
+
+void FileAttributeCache::evict()
+{
+    while (mSize > mBudget && !mLRU.empty())
+    {
+        remove(mLRU.front());
+    }
+}
+
 } // namespace
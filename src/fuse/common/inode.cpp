@@ -55,6 +55,10 @@ void Inode::moved(InodeDBLock& lock,
     // Sanity.
     assert(lock.owns_lock());
 
+    // Neither parent's listing reflects the node's new location.
+    mInodeDB.cache().invalidate(mParentHandle);
+    mInodeDB.cache().invalidate(parentHandle);
+
     // The node's been marked as removed.
     if (mRemoved)
     {
@@ -310,6 +314,9 @@ void Inode::removed(bool removed) const
     // Update our removal state.
     mRemoved = removed;
 
+    // Our parent's listing no longer reflects its content.
+    mInodeDB.cache().invalidate(mParentHandle);
+
     // We've been removed.
     if (mRemoved)
     {
@@ -1,11 +1,14 @@
+#include <cassert>
 #include <chrono>
 #include <functional>
 
+#include <mega/fuse/common/directory_listing.h>
 #include <mega/fuse/common/inode_cache.h>
 #include <mega/fuse/common/inode.h>
 #include <mega/fuse/common/logging.h>
 #include <mega/fuse/common/ref.h>
 #include <mega/fuse/common/utility.h>
+#include <mega/utils.h>
 
 namespace mega
 {
@@ -34,6 +37,37 @@ struct InodeCache::Entry
     EntryPositionMapIterator mPosition;
 }; // Entry;
 
+struct InodeCache::Listing
+{
+    Listing(NodeHandle handle, std::uint64_t generation)
+      : mChildren()
+      , mGeneration(generation)
+      , mHandle(handle)
+      , mPosition()
+    {
+    }
+
+    // How many entries does this listing contribute to the cache?
+    std::size_t size() const
+    {
+        return 1u + (mChildren ? mChildren->size() : 0u);
+    }
+
+    // What children does this directory contain?
+    //
+    // Null if the listing hasn't been built yet.
+    DirectoryListingPtr mChildren;
+
+    // Which generation of this listing is current?
+    std::uint64_t mGeneration;
+
+    // What directory does this listing describe?
+    NodeHandle mHandle;
+
+    // Where is the listing in the cache's position map?
+    ListingPositionMapIterator mPosition;
+}; // Listing
+
 void InodeCache::loop()
 {
     // Convenience.
@@ -60,6 +94,9 @@ void InodeCache::loop()
 
         // Try and reduce the cache's size.
         evicted = reduce(ageThreshold, lock, sizeThreshold);
+
+        // Make sure the listings respect the current limit.
+        reduceListings(lock, mFlags.mMaxListingSize);
     }
 
     FUSEDebug1("Inode Cache Cleaner thread stopped");
@@ -110,13 +147,42 @@ InodeRefVector InodeCache::reduce(std::chrono::seconds age,
                evicted.size(),
                num);
 
+    FUSEDebugF("Listing cache: %lu hit(s), %lu rebuild(s), %lu invalidation(s)",
+               mListingStatistics.mHits,
+               mListingStatistics.mRebuilds,
+               mListingStatistics.mInvalidations);
+
     return evicted;
 }
 
+void InodeCache::reduceListings(Lock&, std::size_t size)
+{
+    // Evict listings until they contain no more than size entries.
+    while (mListingSize > size)
+    {
+        // Select the least recently used listing.
+        auto& listing = mListings.back();
+
+        // Update the cache's size.
+        mListingSize -= listing.size();
+
+        // Remove the listing from the position map.
+        mListingPositions.erase(listing.mPosition);
+
+        // Remove the listing from the cache.
+        mListings.pop_back();
+    }
+}
+
 InodeCache::InodeCache(const InodeCacheFlags& flags)
   : mCV()
   , mEntries()
   , mFlags(flags)
+  , mListingGeneration(0u)
+  , mListings()
+  , mListingPositions()
+  , mListingSize(0u)
+  , mListingStatistics()
   , mLock()
   , mPositions()
   , mTerminate{false}
@@ -183,8 +249,10 @@ void InodeCache::clear()
 {
     EntryList entries;
     EntryPositionMap positions;
+    ListingList listings;
+    ListingPositionMap listingPositions;
 
-    // Acquire ownership of mEntries and mPositions.
+    // Acquire ownership of mEntries, mListings and their positions.
     {
         // Acquire lock.
         std::lock_guard<std::mutex> guard(mLock);
@@ -192,6 +260,13 @@ void InodeCache::clear()
         // Take ownership of mEntries and mPositions.
         entries = std::move(mEntries);
         positions = std::move(mPositions);
+
+        // Take ownership of mListings and mListingPositions.
+        listings = std::move(mListings);
+        listingPositions = std::move(mListingPositions);
+
+        // Listings are now empty.
+        mListingSize = 0u;
     }
 }
 
@@ -217,6 +292,133 @@ InodeCacheFlags InodeCache::flags() const
     return mFlags;
 }
 
+void InodeCache::invalidate(NodeHandle handle)
+{
+    Lock guard(mLock);
+
+    // Is this directory's listing in the cache?
+    auto p = mListingPositions.find(handle);
+
+    // Listing isn't in the cache.
+    if (p == mListingPositions.end())
+        return;
+
+    // Convenience.
+    auto& listing = *p->second;
+
+    // Any listing being built is now stale.
+    listing.mGeneration = ++mListingGeneration;
+
+    // Listing hasn't been built yet.
+    if (!listing.mChildren)
+        return;
+
+    // For debugging.
+    FUSEDebugF("Invalidating listing of %s",
+               toNodeHandle(handle).c_str());
+
+    // Update the cache's size.
+    mListingSize -= listing.mChildren->size();
+
+    // Discard the listing's children.
+    listing.mChildren.reset();
+
+    ++mListingStatistics.mInvalidations;
+}
+
+DirectoryListingPtr InodeCache::listing(NodeHandle handle,
+                                        std::uint64_t& generation)
+{
+    Lock guard(mLock);
+
+    // Convenience.
+    auto l = mListings.begin();
+
+    // Is this directory's listing in the cache?
+    auto p = mListingPositions.find(handle);
+
+    // Listing's in the cache.
+    if (p != mListingPositions.end())
+    {
+        // Mark listing as most recently used if necessary.
+        if (l != p->second)
+            mListings.splice(l, mListings, p->second);
+
+        // Listing's been built.
+        if (p->second->mChildren)
+        {
+            ++mListingStatistics.mHits;
+
+            return p->second->mChildren;
+        }
+
+        // Listing's being built by someone else.
+        generation = p->second->mGeneration;
+
+        return nullptr;
+    }
+
+    // Add a placeholder for this directory's listing.
+    l = mListings.emplace(l, handle, ++mListingGeneration);
+
+    // Add the listing to the position map.
+    l->mPosition = mListingPositions.emplace(handle, l).first;
+
+    // Update the cache's size.
+    mListingSize += l->size();
+
+    // Let the caller know which generation they're building.
+    generation = l->mGeneration;
+
+    return nullptr;
+}
+
+void InodeCache::listing(NodeHandle handle,
+                         DirectoryListingPtr children,
+                         std::uint64_t generation)
+{
+    Lock guard(mLock);
+
+    // Is this directory's listing in the cache?
+    auto p = mListingPositions.find(handle);
+
+    // Listing's been evicted.
+    if (p == mListingPositions.end())
+        return;
+
+    // Convenience.
+    auto& listing = *p->second;
+
+    // Listing's been invalidated or built by someone else.
+    if (listing.mGeneration != generation || listing.mChildren)
+        return;
+
+    // Sanity.
+    assert(children);
+
+    // Listing's too large to be cached.
+    if (children->size() >= mFlags.mMaxListingSize)
+        return;
+
+    // Update the cache's size.
+    mListingSize += children->size();
+
+    // Cache the directory's listing.
+    listing.mChildren = std::move(children);
+
+    ++mListingStatistics.mRebuilds;
+
+    // Make sure we don't exceed our limit.
+    reduceListings(guard, mFlags.mMaxListingSize);
+}
+
+InodeCache::ListingStatistics InodeCache::listingStatistics() const
+{
+    Lock guard(mLock);
+
+    return mListingStatistics;
+}
+
 bool InodeCache::remove(const Inode& inode)
 {
     Lock guard(mLock);
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <iterator>
 #include <map>
 #include <tuple>
 
@@ -9,6 +11,7 @@
 #include <mega/fuse/common/client.h>
 #include <mega/fuse/common/database.h>
 #include <mega/fuse/common/directory_inode.h>
+#include <mega/fuse/common/directory_listing.h>
 #include <mega/fuse/common/error_or.h>
 #include <mega/fuse/common/file_cache.h>
 #include <mega/fuse/common/file_info.h>
@@ -356,279 +359,23 @@ void InodeDB::childRemoved(const Inode& inode,
 
 InodeRefVector InodeDB::children(const DirectoryInode& parent) const
 {
-    // So we can look up strings by reference.
-    struct StringPtrLess {
-        bool operator()(const std::string* lhs,
-                        const std::string* rhs) const
-        {
-            return *lhs < *rhs;
-        }
-    }; // StringPtrLess
-
-    // Convenience.
-    using StringPtrToNodeInfoPtrMap =
-      std::map<const std::string*,
-               NodeInfoList::iterator,
-               StringPtrLess>;
-
-    // Stores the description of each of this node's children.
-    NodeInfoList storage;
-
-    // Maps a child's name to its description.
-    StringPtrToNodeInfoPtrMap descriptions;
-
-    // Insert dummy for purposes of duplicate detection.
-    storage.emplace_back();
+    // Used to detect whether the listing's invalidated while we build it.
+    std::uint64_t generation = 0u;
 
-    // What children are present in the cloud?
-    client().each([&](NodeInfo description) {
-        // Have we seen a child with this name before?
-        auto i = descriptions.find(&description.mName);
-
-        // Haven't seen a child with this name before.
-        if (i == descriptions.end())
-        {
-            auto j = storage.end();
-
-            // Latch the child's description.
-            j = storage.emplace(j, std::move(description));
-
-            // Add child to index.
-            descriptions[&j->mName] = j;
-
-            // Process the next child.
-            return;
-        }
-
-        // We've already detected a duplicate with this name.
-        if (i->second == storage.begin())
-            return;
+    // Have we already listed this directory?
+    auto listing = cache().listing(parent.handle(), generation);
 
-        // Remove existing child's description.
-        storage.erase(i->second);
-
-        // Mark name as a duplicate.
-        i->second = storage.begin();
-    }, parent.handle());
-
-    auto guard = lockAll(mContext.mDatabase, *this);
-
-    auto transaction = mContext.mDatabase.transaction();
-    auto query = transaction.query(mQueries.mGetChildrenByParentHandle);
-
-    // What children are present on disk?
-    query.param(":parent_handle") = parent.handle();
-    query.execute();
-
-    // What children need to be loaded?
-    struct PendingChild
+    // Directory hasn't been listed so build a new listing.
+    if (!listing)
     {
-        PendingChild(FileExtension extension,
-                     std::string name,
-                     InodeID id)
-          : mExtension(std::move(extension))
-          , mName(std::move(name))
-          , mID(id)
-        {
-        }
-
-        // The child's extension.
-        FileExtension mExtension;
-
-        // The child's name.
-        std::string mName;
-
-        // The child's ID.
-        InodeID mID;
-    }; // PendingChild
-
-    using PendingChildVector = std::vector<PendingChild>;
-
-    // Children waiting to be loaded.
-    PendingChildVector pending;
+        listing = list(parent);
 
-    // What children have been removed or replaced?
-    InodeIDVector removed;
-
-    for ( ; query; ++query)
-    {
-        auto id = query.field("id").inode();
-        auto name = query.field("name").string();
-
-        // Have we already seen a cloud child with this name?
-        auto i = descriptions.find(&name);
-
-        // A child with this name is present in the cloud.
-        if (i != descriptions.end())
-        {
-            // Child was a duplicate.
-            if (i->second == storage.begin())
-                continue;
-
-            // Cloud child has replaced this local child.
-            removed.emplace_back(id);
-
-            // Process next local child.
-            continue;
-        }
-
-        // Child exists only locally.
-        pending.emplace_back(fileExtensionDB().get(query.field("extension")),
-                             std::move(name),
-                             id);
-    }
-
-    InodeRefVector children;
-
-    // Convenience.
-    auto& self = const_cast<InodeDB&>(*this);
-
-    // Pop dummy marker.
-    storage.pop_front();
-
-    // Prepare query.
-    query = transaction.query(mQueries.mGetExtensionAndInodeIDByHandle);
-
-    // Instantiate cloud children.
-    while (!storage.empty())
-    {
-        // Latch child's description.
-        auto info = std::move(storage.front());
-
-        // Pop description.
-        storage.pop_front();
-
-        // Instantiate child.
-        children.emplace_back(([&]() {
-            // Is the child already in memory?
-            auto h = mByHandle.find(info.mHandle);
-
-            // Child's already in memory.
-            if (h != mByHandle.end())
-                return InodeRef(h->second->accessed());
-
-            // Child's a directory.
-            if (info.mIsDirectory)
-                return self.add(&InodeDB::buildDirectory, info);
-
-            query.reset();
-
-            // Check if child's in the file cache.
-            query.param(":handle") = info.mHandle;
-            query.execute();
-
-            // Child's not in the file cache.
-            if (!query)
-                return self.add(&InodeDB::buildFile, info);
-
-            // Convenience.
-            auto extension = fileExtensionDB().get(query.field("extension"));
-            auto id = query.field("id").inode();
-
-            // Try and get our hands on the file's info.
-            auto fileInfo = fileCache().info(extension, id);
-
-            // File's been removed from the cache.
-            if (!fileInfo)
-            {
-                // Remember to purge the stale record.
-                removed.emplace_back(id);
-
-                // Return new child instance.
-                return self.add(&InodeDB::buildFile, info);
-            }
-
-            // Instantiate child.
-            auto ptr = std::make_unique<FileInode>(id, info, self);
-
-            // Inject file info.
-            ptr->fileInfo(std::move(fileInfo));
-
-            // Establish reference to new child.
-            auto ref = InodeRef(ptr->accessed());
-
-            // Add child to index.
-            mByHandle.emplace(info.mHandle, ptr.get());
-            mByID.emplace(id, std::move(ptr));
-
-            // Return new child instance.
-            return ref;
-        })());
-    }
-
-    // Instantiate local children.
-    while (!pending.empty())
-    {
-        // Convenience.
-        auto& child = pending.back();
-
-        // Pop child's name and ID.
-        auto extension = std::move(child.mExtension);
-        auto name = std::move(child.mName);
-        auto id = child.mID;
-
-        pending.pop_back();
-
-        // Is the child already in memory?
-        auto i = mByID.find(id);
-
-        // Child's already in memory.
-        if (i != mByID.end())
-        {
-            // Add child to vector.
-            children.emplace_back(i->second->accessed());
-
-            // Process next child.
-            continue;
-        }
-
-        // Try and get our hands on the file's info.
-        auto fileInfo = fileCache().info(extension, id);
-
-        // File's been removed from the cache.
-        if (!fileInfo)
-        {
-            // Remember to purge stale record.
-            removed.emplace_back(id);
-
-            // Process next child.
-            continue;
-        }
-
-        NodeInfo info;
-
-        // Populate dummy description.
-        info.mName = std::move(name);
-        info.mParentHandle = parent.handle();
-
-        // Instantiate child.
-        auto ptr = std::make_unique<FileInode>(id, info, self);
-
-        // Inject file info.
-        ptr->fileInfo(std::move(fileInfo));
-
-        // Add child to vector.
-        children.emplace_back(ptr.get());
-
-        // Add child to index.
-        mByID.emplace(id, std::move(ptr));
+        // Cache the listing so later calls can avoid rebuilding it.
+        cache().listing(parent.handle(), listing, generation);
     }
 
-    query = transaction.query(mQueries.mRemoveInodeByID);
-
-    // Prune stale database records.
-    for (auto id : removed)
-    {
-        query.param(":id") = id;
-        query.execute();
-        query.reset();
-    }
-
-    // Commit transaction.
-    transaction.commit();
-
-    // Return children to caller.
-    return children;
+    // Instantiate the directory's children.
+    return instantiate(*listing, parent.handle());
 }
 
 void InodeDB::current()
@@ -921,6 +668,9 @@ void InodeDB::handle(FileInode& file,
     // Silence compiler.
     static_cast<void>(count);
 
+    // The parent's listing still refers to the file's old handle.
+    cache().invalidate(file.parentHandle(CachedOnly));
+
     // Persist database changes.
     transaction.commit();
 }
@@ -1048,6 +798,301 @@ ErrorOr<bool> InodeDB::hasChildren(const DirectoryInode& directory) const
     return query;
 }
 
+InodeRefVector InodeDB::instantiate(const DirectoryListing& listing,
+                                    NodeHandle parentHandle) const
+{
+    // Declared before our lock so they're released after it.
+    InodeRefVector children;
+
+    // What children have been removed from the file cache?
+    InodeIDVector removed;
+
+    {
+        auto guard = lockAll(mContext.mDatabase, *this);
+
+        auto transaction = mContext.mDatabase.transaction();
+        auto query = transaction.query(mQueries.mGetExtensionAndInodeIDByHandle);
+
+        // Convenience.
+        auto& self = const_cast<InodeDB&>(*this);
+
+        children.reserve(listing.size());
+
+        // Instantiate each child.
+        for (auto& entry : listing)
+        {
+            // Convenience.
+            auto& info = entry.mInfo;
+
+            // Child only exists locally.
+            if (info.mHandle.isUndef())
+            {
+                // Is the child already in memory?
+                auto i = mByID.find(entry.mID);
+
+                // Child's already in memory.
+                if (i != mByID.end())
+                {
+                    // Add child to vector.
+                    children.emplace_back(i->second->accessed());
+
+                    // Process next child.
+                    continue;
+                }
+
+                // Try and get our hands on the file's info.
+                auto fileInfo = fileCache().info(entry.mExtension, entry.mID);
+
+                // File's been removed from the cache.
+                if (!fileInfo)
+                {
+                    // Remember to purge stale record.
+                    removed.emplace_back(entry.mID);
+
+                    // Process next child.
+                    continue;
+                }
+
+                // Instantiate child.
+                auto ptr = std::make_unique<FileInode>(entry.mID, info, self);
+
+                // Inject file info.
+                ptr->fileInfo(std::move(fileInfo));
+
+                // Add child to vector.
+                children.emplace_back(ptr.get());
+
+                // Add child to index.
+                mByID.emplace(entry.mID, std::move(ptr));
+
+                // Process next child.
+                continue;
+            }
+
+            // Instantiate cloud child.
+            children.emplace_back(([&]() {
+                // Is the child already in memory?
+                auto h = mByHandle.find(info.mHandle);
+
+                // Child's already in memory.
+                if (h != mByHandle.end())
+                    return InodeRef(h->second->accessed());
+
+                // Child's a directory.
+                if (info.mIsDirectory)
+                    return self.add(&InodeDB::buildDirectory, info);
+
+                query.reset();
+
+                // Check if child's in the file cache.
+                query.param(":handle") = info.mHandle;
+                query.execute();
+
+                // Child's not in the file cache.
+                if (!query)
+                    return self.add(&InodeDB::buildFile, info);
+
+                // Convenience.
+                auto extension = fileExtensionDB().get(query.field("extension"));
+                auto id = query.field("id").inode();
+
+                // Try and get our hands on the file's info.
+                auto fileInfo = fileCache().info(extension, id);
+
+                // File's been removed from the cache.
+                if (!fileInfo)
+                {
+                    // Remember to purge the stale record.
+                    removed.emplace_back(id);
+
+                    // Return new child instance.
+                    return self.add(&InodeDB::buildFile, info);
+                }
+
+                // Instantiate child.
+                auto ptr = std::make_unique<FileInode>(id, info, self);
+
+                // Inject file info.
+                ptr->fileInfo(std::move(fileInfo));
+
+                // Establish reference to new child.
+                auto ref = InodeRef(ptr->accessed());
+
+                // Add child to index.
+                mByHandle.emplace(info.mHandle, ptr.get());
+                mByID.emplace(id, std::move(ptr));
+
+                // Return new child instance.
+                return ref;
+            })());
+        }
+
+        query = transaction.query(mQueries.mRemoveInodeByID);
+
+        // Prune stale database records.
+        for (auto id : removed)
+        {
+            query.param(":id") = id;
+            query.execute();
+            query.reset();
+        }
+
+        // Commit transaction.
+        transaction.commit();
+    }
+
+    // Listing referred to files no longer present in the file cache.
+    if (!removed.empty())
+        cache().invalidate(parentHandle);
+
+    // Return children to caller.
+    return children;
+}
+
+DirectoryListingPtr InodeDB::list(const DirectoryInode& parent) const
+{
+    // So we can look up strings by reference.
+    struct StringPtrLess {
+        bool operator()(const std::string* lhs,
+                        const std::string* rhs) const
+        {
+            return *lhs < *rhs;
+        }
+    }; // StringPtrLess
+
+    // Convenience.
+    using StringPtrToNodeInfoPtrMap =
+      std::map<const std::string*,
+               NodeInfoList::iterator,
+               StringPtrLess>;
+
+    // Stores the description of each of this node's children.
+    NodeInfoList storage;
+
+    // Maps a child's name to its description.
+    StringPtrToNodeInfoPtrMap descriptions;
+
+    // Insert dummy for purposes of duplicate detection.
+    storage.emplace_back();
+
+    // What children are present in the cloud?
+    client().each([&](NodeInfo description) {
+        // Have we seen a child with this name before?
+        auto i = descriptions.find(&description.mName);
+
+        // Haven't seen a child with this name before.
+        if (i == descriptions.end())
+        {
+            auto j = storage.end();
+
+            // Latch the child's description.
+            j = storage.emplace(j, std::move(description));
+
+            // Add child to index.
+            descriptions[&j->mName] = j;
+
+            // Process the next child.
+            return;
+        }
+
+        // We've already detected a duplicate with this name.
+        if (i->second == storage.begin())
+            return;
+
+        // Remove existing child's description.
+        storage.erase(i->second);
+
+        // Mark name as a duplicate.
+        i->second = storage.begin();
+    }, parent.handle());
+
+    auto guard = lockAll(mContext.mDatabase, *this);
+
+    auto transaction = mContext.mDatabase.transaction();
+    auto query = transaction.query(mQueries.mGetChildrenByParentHandle);
+
+    // What children are present on disk?
+    query.param(":parent_handle") = parent.handle();
+    query.execute();
+
+    // Describes the children that only exist locally.
+    DirectoryListing local;
+
+    // What children have been removed or replaced?
+    InodeIDVector removed;
+
+    for ( ; query; ++query)
+    {
+        auto id = query.field("id").inode();
+        auto name = query.field("name").string();
+
+        // Have we already seen a cloud child with this name?
+        auto i = descriptions.find(&name);
+
+        // A child with this name is present in the cloud.
+        if (i != descriptions.end())
+        {
+            // Child was a duplicate.
+            if (i->second == storage.begin())
+                continue;
+
+            // Cloud child has replaced this local child.
+            removed.emplace_back(id);
+
+            // Process next local child.
+            continue;
+        }
+
+        DirectoryListingEntry entry;
+
+        // Child exists only locally.
+        entry.mExtension = fileExtensionDB().get(query.field("extension"));
+        entry.mID = id;
+        entry.mInfo.mName = std::move(name);
+        entry.mInfo.mParentHandle = parent.handle();
+
+        local.emplace_back(std::move(entry));
+    }
+
+    // Pop dummy marker.
+    storage.pop_front();
+
+    // Describes the directory's children.
+    DirectoryListing listing;
+
+    listing.reserve(storage.size() + local.size());
+
+    // Describe cloud children.
+    for (auto& info : storage)
+    {
+        DirectoryListingEntry entry;
+
+        entry.mInfo = std::move(info);
+
+        listing.emplace_back(std::move(entry));
+    }
+
+    // Describe local children.
+    std::move(local.begin(), local.end(), std::back_inserter(listing));
+
+    query = transaction.query(mQueries.mRemoveInodeByID);
+
+    // Prune stale database records.
+    for (auto id : removed)
+    {
+        query.param(":id") = id;
+        query.execute();
+        query.reset();
+    }
+
+    // Commit transaction.
+    transaction.commit();
+
+    // Return listing to caller.
+    return std::make_shared<const DirectoryListing>(std::move(listing));
+}
+
+
 ErrorOr<MakeInodeResult> InodeDB::makeDirectory(const platform::Mount&,
                                                 const std::string& name,
                                                 DirectoryInodeRef parent)
@@ -1075,6 +1120,9 @@ ErrorOr<MakeInodeResult> InodeDB::makeDirectory(const platform::Mount&,
     if (!ref)
         ref = add(&InodeDB::buildDirectory, info);
 
+    // The parent's listing no longer reflects its content.
+    cache().invalidate(parent->handle());
+
     // Return result to caller.
     return std::make_tuple(std::move(ref), std::move(info));
 }
@@ -1131,6 +1179,9 @@ ErrorOr<MakeInodeResult> InodeDB::makeFile(const platform::Mount& mount,
     // Let the inode know about its attributes.
     ref->fileInfo(*fileInfo);
 
+    // The parent's listing no longer reflects its content.
+    cache().invalidate(parent->handle());
+
     // Persist database changes.
     transaction.commit();
 
@@ -2299,6 +2350,9 @@ void InodeDB::EventObserver::operator()(NodeEventQueue& events)
 
         // Handle the event.
         (this->*handler)(event);
+
+        // The parent's listing no longer describes the node accurately.
+        mInodeDB.cache().invalidate(event.parentHandle());
     }
 
     // Persist database changes.
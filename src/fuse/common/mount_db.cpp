@@ -49,12 +49,14 @@ MountDB::Queries::Queries(Database& mDatabase)
                 "  :name, "
                 "  :path, "
                 "  :persistent, "
-                "  :read_only "
+                "  :read_only, "
+                "  :high_throughput "
                 ")";
 
     mGetMountByPath = "select * from mounts where path = :path";
 
     mGetMountFlagsByPath = "select enable_at_startup "
+                           "     , high_throughput "
                            "     , name "
                            "     , persistent "
                            "     , read_only "
@@ -83,6 +85,7 @@ MountDB::Queries::Queries(Database& mDatabase)
 
     mSetMountFlagsByPath = "update mounts "
                            "   set enable_at_startup = :enable_at_startup "
+                           "     , high_throughput = :high_throughput "
                            "     , name = :name "
                            "     , persistent = :persistent "
                            "     , read_only = :read_only "
@@ -15,6 +15,7 @@ bool MountFlags::operator==(const MountFlags& rhs) const
 {
     return mName == rhs.mName
            && mEnableAtStartup == rhs.mEnableAtStartup
+           && mHighThroughput == rhs.mHighThroughput
            && mPersistent == rhs.mPersistent
            && mReadOnly == rhs.mReadOnly;
 }
@@ -30,6 +31,7 @@ try
     MountFlags flags;
 
     flags.mEnableAtStartup = query.field("enable_at_startup");
+    flags.mHighThroughput = query.field("high_throughput");
     flags.mName = query.field("name").string();
     flags.mPersistent = query.field("persistent");
     flags.mReadOnly = query.field("read_only");
@@ -53,6 +55,7 @@ try
     assert(!mEnableAtStartup || mPersistent);
 
     query.param(":enable_at_startup") = mEnableAtStartup;
+    query.param(":high_throughput") = mHighThroughput;
     query.param(":name") = mName;
     query.param(":persistent") = mPersistent;
     query.param(":read_only") = mReadOnly;
@@ -1,4 +1,6 @@
 #include <fstream>
+#include <set>
+#include <string>
 
 #include <mega/fuse/common/error_or.h>
 #include <mega/fuse/common/mount_event_type.h>
@@ -31,6 +33,8 @@ struct FUSECommonTests
 
 static handle fsidOf(const Path& path);
 
+static std::set<std::string> listNames(const Path& path);
+
 static bool makeFile(const Path& path, const std::string& data);
 
 static bool makeFile(const Path& path, std::size_t size);
@@ -342,6 +346,60 @@ TEST_F(FUSECommonTests, file_cache_load)
     std::filebuf x;
 }
 
+TEST_F(FUSECommonTests, listing_reflects_cloud_add)
+{
+    // Make sure the directory's listing has been cached.
+    ASSERT_EQ(listNames(MountPathW()).count("sdx"), 0u);
+    ASSERT_EQ(listNames(MountPathW()).count("sdx"), 0u);
+
+    auto handle = ClientW()->makeDirectory("sdx", "/x/s");
+    ASSERT_TRUE(handle);
+
+    EXPECT_TRUE(waitFor([&]() {
+        return listNames(MountPathW()).count("sdx") > 0;
+    }, mDefaultTimeout));
+}
+
+TEST_F(FUSECommonTests, listing_reflects_cloud_remove)
+{
+    // Make sure the directory's listing has been cached.
+    ASSERT_EQ(listNames(MountPathW()).count("sf0"), 1u);
+    ASSERT_EQ(listNames(MountPathW()).count("sf0"), 1u);
+
+    ASSERT_EQ(ClientW()->remove("/x/s/sf0"), API_OK);
+
+    EXPECT_TRUE(waitFor([&]() {
+        return !listNames(MountPathW()).count("sf0");
+    }, mDefaultTimeout));
+}
+
+TEST_F(FUSECommonTests, listing_reflects_cloud_rename)
+{
+    // Make sure the directory's listing has been cached.
+    ASSERT_EQ(listNames(MountPathW()).count("sf0"), 1u);
+    ASSERT_EQ(listNames(MountPathW()).count("sf0"), 1u);
+
+    ASSERT_EQ(ClientW()->move("sfx", "/x/s/sf0", "/x/s"), API_OK);
+
+    EXPECT_TRUE(waitFor([&]() {
+        auto names = listNames(MountPathW());
+
+        return !names.count("sf0") && names.count("sfx");
+    }, mDefaultTimeout));
+}
+
+TEST_F(FUSECommonTests, listing_reflects_local_add)
+{
+    // Make sure the directory's listing has been cached.
+    ASSERT_EQ(listNames(MountPathW()).count("sfx"), 0u);
+    ASSERT_EQ(listNames(MountPathW()).count("sfx"), 0u);
+
+    ASSERT_TRUE(makeFile(MountPathW() / "sfx", 32));
+
+    // The new file should be listed immediately.
+    EXPECT_EQ(listNames(MountPathW()).count("sfx"), 1u);
+}
+
 TEST_F(FUSECommonTests, reload)
 {
     // Create a new client so not to interfere with future tests.
@@ -614,6 +672,30 @@ handle fsidOf(const Path& path)
                            FSLogging::logOnError);
 }
 
+std::set<std::string> listNames(const Path& path)
+{
+    std::set<std::string> names;
+    std::error_code error;
+
+    auto i = fs::directory_iterator(path.path(), error);
+    auto j = fs::directory_iterator();
+
+    // Couldn't open the directory for iteration.
+    if (error)
+        return names;
+
+    for ( ; i != j; i.increment(error))
+    {
+        // Couldn't retrieve the next entry.
+        if (error)
+            break;
+
+        names.emplace(i->path().filename().u8string());
+    }
+
+    return names;
+}
+
 bool makeFile(const Path& path, const std::string& data)
 {
     std::ofstream ostream(path.string(), std::ios::binary | std::ios::trunc);
@@ -0,0 +1,203 @@
+#include <chrono>
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+#include <mega/fuse/common/directory_listing.h>
+#include <mega/fuse/common/inode_cache.h>
+#include <mega/fuse/common/inode_cache_flags.h>
+#include <mega/fuse/common/inode_id.h>
+
+#include <mega/types.h>
+
+namespace mega
+{
+namespace fuse
+{
+namespace testing
+{
+
+class FUSEInodeCacheTests
+  : public ::testing::Test
+{
+protected:
+    // Convenience.
+    static DirectoryListingPtr children(std::uint64_t first, std::size_t count)
+    {
+        DirectoryListing listing;
+
+        while (count--)
+        {
+            DirectoryListingEntry entry;
+
+            entry.mID = InodeID(first++);
+
+            listing.emplace_back(std::move(entry));
+        }
+
+        return std::make_shared<const DirectoryListing>(std::move(listing));
+    }
+
+    // Make sure the cleaner never runs during a test.
+    static InodeCacheFlags flags(std::size_t maxListingSize)
+    {
+        InodeCacheFlags flags;
+
+        flags.mCleanInterval = std::chrono::hours(24);
+        flags.mMaxListingSize = maxListingSize;
+
+        return flags;
+    }
+
+    // Convenience.
+    static NodeHandle handle(std::uint64_t value)
+    {
+        return NodeHandle().set6byte(value);
+    }
+
+    // What children does a listing describe?
+    static InodeIDVector ids(const DirectoryListing& listing)
+    {
+        InodeIDVector ids;
+
+        for (auto& entry : listing)
+            ids.emplace_back(entry.mID);
+
+        return ids;
+    }
+}; // FUSEInodeCacheTests
+
+TEST_F(FUSEInodeCacheTests, listing_hit)
+{
+    InodeCache cache(flags(64));
+
+    std::uint64_t generation = 0u;
+
+    // Listing isn't in the cache.
+    ASSERT_FALSE(cache.listing(handle(1), generation));
+    ASSERT_NE(generation, 0u);
+
+    // Cache the directory's listing.
+    cache.listing(handle(1), children(16, 4), generation);
+
+    // Listing should now be in the cache.
+    auto listing = cache.listing(handle(1), generation);
+
+    ASSERT_TRUE(listing);
+    EXPECT_EQ(ids(*listing), ids(*children(16, 4)));
+}
+
+TEST_F(FUSEInodeCacheTests, listing_invalidated)
+{
+    InodeCache cache(flags(64));
+
+    std::uint64_t generation = 0u;
+
+    ASSERT_FALSE(cache.listing(handle(1), generation));
+
+    cache.listing(handle(1), children(16, 4), generation);
+
+    ASSERT_TRUE(cache.listing(handle(1), generation));
+
+    // A child's been added, removed or renamed.
+    cache.invalidate(handle(1));
+
+    // Listing must be rebuilt.
+    ASSERT_FALSE(cache.listing(handle(1), generation));
+
+    cache.listing(handle(1), children(16, 3), generation);
+
+    auto listing = cache.listing(handle(1), generation);
+
+    ASSERT_TRUE(listing);
+    EXPECT_EQ(ids(*listing), ids(*children(16, 3)));
+}
+
+TEST_F(FUSEInodeCacheTests, listing_stale_discarded)
+{
+    InodeCache cache(flags(64));
+
+    std::uint64_t generation = 0u;
+
+    ASSERT_FALSE(cache.listing(handle(1), generation));
+
+    // Directory's content changed while its listing was being built.
+    cache.invalidate(handle(1));
+
+    // Stale listing should be discarded.
+    cache.listing(handle(1), children(16, 4), generation);
+
+    EXPECT_FALSE(cache.listing(handle(1), generation));
+}
+
+TEST_F(FUSEInodeCacheTests, listing_evicted)
+{
+    // Each listing contributes its children plus one to the cache.
+    InodeCache cache(flags(8));
+
+    std::uint64_t generation = 0u;
+
+    // Cache two listings, filling the cache.
+    ASSERT_FALSE(cache.listing(handle(1), generation));
+    cache.listing(handle(1), children(16, 3), generation);
+
+    ASSERT_FALSE(cache.listing(handle(2), generation));
+    cache.listing(handle(2), children(32, 3), generation);
+
+    // Mark the first listing as most recently used.
+    ASSERT_TRUE(cache.listing(handle(1), generation));
+
+    // Cache a third listing, exceeding the cache's limit.
+    ASSERT_FALSE(cache.listing(handle(3), generation));
+    cache.listing(handle(3), children(48, 2), generation);
+
+    // The least recently used listing should've been evicted.
+    EXPECT_TRUE(cache.listing(handle(1), generation));
+    EXPECT_TRUE(cache.listing(handle(3), generation));
+    EXPECT_FALSE(cache.listing(handle(2), generation));
+}
+
+TEST_F(FUSEInodeCacheTests, listing_too_large)
+{
+    InodeCache cache(flags(8));
+
+    std::uint64_t generation = 0u;
+
+    ASSERT_FALSE(cache.listing(handle(1), generation));
+
+    // Listing's too large to be cached.
+    cache.listing(handle(1), children(16, 8), generation);
+
+    EXPECT_FALSE(cache.listing(handle(1), generation));
+}
+
+TEST_F(FUSEInodeCacheTests, listing_statistics)
+{
+    InodeCache cache(flags(64));
+
+    std::uint64_t generation = 0u;
+
+    // Miss, build and then hit the listing twice.
+    ASSERT_FALSE(cache.listing(handle(1), generation));
+    cache.listing(handle(1), children(16, 4), generation);
+
+    ASSERT_TRUE(cache.listing(handle(1), generation));
+    ASSERT_TRUE(cache.listing(handle(1), generation));
+
+    // Invalidate and rebuild the listing.
+    cache.invalidate(handle(1));
+
+    ASSERT_FALSE(cache.listing(handle(1), generation));
+    cache.listing(handle(1), children(16, 3), generation);
+
+    auto statistics = cache.listingStatistics();
+
+    EXPECT_EQ(statistics.mHits, 2u);
+    EXPECT_EQ(statistics.mInvalidations, 1u);
+    EXPECT_EQ(statistics.mRebuilds, 2u);
+}
+
+} // testing
+} // fuse
+} // mega
+
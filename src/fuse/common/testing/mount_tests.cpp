@@ -1062,6 +1062,7 @@ TEST_F(FUSEMountTests, flags_succeeds)
     ASSERT_EQ(mount.mFlags, *flags0);
 
     flags0->mEnableAtStartup = true;
+    flags0->mHighThroughput = true;
     flags0->mName = "t";
     flags0->mReadOnly = true;
     flags0->mPersistent = true;
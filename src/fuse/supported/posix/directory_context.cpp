@@ -51,6 +51,16 @@ DirectoryContext* DirectoryContext::directory()
     return this;
 }
 
+InodeRef DirectoryContext::child(std::size_t index) const
+{
+    assert(index >= 2 && index < size());
+
+    // Populate entries if necessary.
+    populate();
+
+    return mChildren[index - 2];
+}
+
 InodeInfo DirectoryContext::get(std::size_t index) const
 {
     assert(index < size());
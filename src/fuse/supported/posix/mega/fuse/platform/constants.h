@@ -11,8 +11,27 @@ namespace fuse
 namespace platform
 {
 
-constexpr auto AttributeTimeout = 120.0;
-constexpr auto EntryTimeout = 120.0;
+// How long the kernel may cache an inode's entry and attributes.
+//
+// Inodes that have been modified recently receive the minimum timeout
+// while the timeout of stable inodes grows toward the maximum.
+constexpr auto MaximumCacheTimeout = 120.0;
+constexpr auto MaximumCacheTimeoutHighThroughput = 3600.0;
+constexpr auto MinimumCacheTimeout = 1.0;
+
+// How many background requests the kernel may have in flight
+// when a mount's using the high-throughput profile.
+constexpr auto HighThroughputMaxBackground = 64u;
+constexpr auto HighThroughputCongestionThreshold = 48u;
+
+// Smallest write size we ask for when big writes are enabled.
+constexpr auto HighThroughputMaxWrite = 128u * 1024u;
+
+// Largest write the kernel will ever send (FUSE_MAX_MAX_PAGES pages.)
+constexpr auto KernelMaxWrite = 256u * 4096u;
+
+// How many entries reported by readdir will be remembered per mount.
+constexpr auto MaxListedEntries = 16384u;
 
 extern const std::string FilesystemName;
 
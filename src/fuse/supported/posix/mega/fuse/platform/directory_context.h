@@ -42,6 +42,9 @@ public:
     // Check if this context represents a directory.
     DirectoryContext* directory() override;
 
+    // Retrieve a reference to a specific child.
+    InodeRef child(std::size_t index) const;
+
     // Retrieve information about a specific directory entry.
     InodeInfo get(std::size_t index) const;
 
@@ -1,14 +1,19 @@
 #pragma once
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <mega/fuse/common/activity_monitor.h>
 #include <mega/fuse/common/inode_forward.h>
-#include <mega/fuse/common/inode_forward.h>
+#include <mega/fuse/common/inode_id.h>
 #include <mega/fuse/common/mount_inode_id_forward.h>
 #include <mega/fuse/common/mount.h>
+#include <mega/fuse/common/ref.h>
 #include <mega/fuse/common/tags.h>
 #include <mega/fuse/common/task_executor_flags_forward.h>
 #include <mega/fuse/common/task_executor.h>
@@ -66,6 +71,14 @@ class Mount final
         mExecutor.execute(std::move(wrapper_), spawnWorker);
     }
 
+    // Remember that readdir has reported a child.
+    void listed(InodeRef child,
+                const std::string& name,
+                InodeID parent);
+
+    // Retrieve (and forget) a child recently reported by readdir.
+    InodeRef listed(const std::string& name, InodeID parent);
+
     void lookup(Request request,
                 MountInodeID parent,
                 const std::string& name);
@@ -81,6 +94,9 @@ class Mount final
     void forget_multi(Request request,
                       const std::vector<fuse_forget_data>& forgets);
 
+    // Forget that readdir has reported a child.
+    void forgetListed(const std::string& name, InodeID parent);
+
     void fsync(Request request,
                MountInodeID inode,
                bool onlyData,
@@ -127,6 +143,9 @@ class Mount final
                     MountInodeID inode,
                     fuse_file_info& info);
 
+    // Describe an inode to FUSE and pin it in memory.
+    void replyEntry(Request request, InodeRef ref);
+
     void rename(Request request,
                 MountInodeID sourceParent,
                 const std::string& sourceName,
@@ -155,6 +174,21 @@ class Mount final
                off_t offset,
                fuse_file_info& info);
 
+    // Does this mount use the high-throughput session profile?
+    const bool mHighThroughput;
+
+    // Which children have recently been reported by readdir?
+    //
+    // libfuse's 2.x API can't answer READDIRPLUS requests so the kernel
+    // follows each listing with a lookup of every entry. When the mount
+    // uses the high-throughput profile, readdir remembers what it reported
+    // so that those lookups can be satisfied without consulting the
+    // client or the inode database.
+    std::map<std::pair<InodeID, std::string>, InodeRef> mListedEntries;
+
+    // Serializes access to mListedEntries.
+    std::mutex mListedEntriesLock;
+
     // Tracks whether any requests are in progress.
     ActivityMonitor mActivities;
 
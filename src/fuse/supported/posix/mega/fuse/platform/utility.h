@@ -24,6 +24,9 @@ using PathVector = std::vector<std::string>;
 
 bool abort(const std::string& path);
 
+// How long may the kernel cache this inode's entry and attributes?
+double cacheTimeout(const InodeInfo& info, bool highThroughput);
+
 PathVector filesystems(FilesystemPredicate predicate = nullptr);
 
 FileDescriptorPair pipe(bool closeReaderOnFork,
@@ -35,7 +38,8 @@ void translate(struct stat& attributes,
 
 void translate(fuse_entry_param& entry,
                MountInodeID id,
-               const InodeInfo& info);
+               const InodeInfo& info,
+               double timeout);
 
 int translate(Error result);
 
@@ -119,10 +119,64 @@ void Mount::doUnlink(Request request,
     request.replyError(translate(result));
 }
 
+void Mount::listed(InodeRef child,
+                   const std::string& name,
+                   InodeID parent)
+{
+    std::lock_guard<std::mutex> guard(mListedEntriesLock);
+
+    // Make sure we don't remember too many entries.
+    if (mListedEntries.size() >= MaxListedEntries)
+        mListedEntries.clear();
+
+    mListedEntries[std::make_pair(parent, name)] = std::move(child);
+}
+
+InodeRef Mount::listed(const std::string& name, InodeID parent)
+{
+    std::unique_lock<std::mutex> lock(mListedEntriesLock);
+
+    // Has readdir recently reported this entry?
+    auto i = mListedEntries.find(std::make_pair(parent, name));
+
+    // Entry hasn't been reported.
+    if (i == mListedEntries.end())
+        return InodeRef();
+
+    // Entries are only useful for a single lookup.
+    auto child = std::move(i->second);
+
+    mListedEntries.erase(i);
+
+    lock.unlock();
+
+    // Make sure the child is still where readdir said it was.
+    if (child->removed())
+        return InodeRef();
+
+    auto info = child->info();
+
+    if (info.mName != name || info.mParentID != parent)
+        return InodeRef();
+
+    return child;
+}
+
 void Mount::lookup(Request request,
                    MountInodeID parent,
                    const std::string& name)
 {
+    // Specified name is way too long.
+    if (name.size() > MaxNameLength)
+        return request.replyError(ENAMETOOLONG);
+
+    // Has readdir recently reported this child?
+    auto childRef = listed(name, map(parent));
+
+    // Child's been reported so there's no need to search for it.
+    if (childRef)
+        return replyEntry(request, std::move(childRef));
+
     // Look up the parent.
     auto ref = get(parent);
 
@@ -136,34 +190,13 @@ void Mount::lookup(Request request,
     if (!directoryRef)
         return request.replyError(ENOTDIR);
 
-    // Specified name is way too long.
-    if (name.size() > MaxNameLength)
-        return request.replyError(ENAMETOOLONG);
-
-    auto childRef = directoryRef->get(name);
+    childRef = directoryRef->get(name);
 
     // Child doesn't exist.
     if (!childRef)
         return request.replyError(ENOENT);
 
-    auto info = childRef->info();
-
-    // Mount's not writable.
-    if (!writable())
-        info.mPermissions = RDONLY;
-
-    pin(childRef, info);
-
-    auto entry = fuse_entry_param();
-
-    std::memset(&entry, 0, sizeof(entry));
-
-    entry.attr_timeout = AttributeTimeout;
-    entry.entry_timeout = EntryTimeout;
-
-    translate(entry, map(info.mID), info);
-
-    request.replyEntry(entry);
+    replyEntry(request, std::move(childRef));
 }
 
 void Mount::flush(Request request,
@@ -209,6 +242,13 @@ void Mount::forget_multi(Request request,
     request.replyNone();
 }
 
+void Mount::forgetListed(const std::string& name, InodeID parent)
+{
+    std::lock_guard<std::mutex> guard(mListedEntriesLock);
+
+    mListedEntries.erase(std::make_pair(parent, name));
+}
+
 void Mount::fsync(Request request,
                   MountInodeID inode,
                   bool,
@@ -248,7 +288,8 @@ void Mount::getattr(Request request,
 
     translate(attributes, inode, info);
 
-    request.replyAttributes(attributes, AttributeTimeout);
+    request.replyAttributes(attributes,
+                            cacheTimeout(info, mHighThroughput));
 }
 
 void Mount::mkdir(Request request,
@@ -300,7 +341,10 @@ void Mount::mknod(Request request,
     // Translate description into something meaningful to FUSE.
     auto entry = fuse_entry_param();
 
-    translate(entry, MountInodeID(info.mID), info);
+    translate(entry,
+              MountInodeID(info.mID),
+              info,
+              cacheTimeout(info, mHighThroughput));
 
     // Pin inode in memory.
     pin(std::move(std::get<0>(*result)), info);
@@ -482,9 +526,15 @@ void Mount::readdir(Request request,
         if (!request.addDirEntry(attributes,
                                  buffer,
                                  info.mName,
-                                 ++m,
+                                 m + 1,
                                  size - buffer.size()))
             break;
+
+        // Remember the child so the kernel's lookup will be cheap.
+        if (mHighThroughput && m >= 2)
+            listed(context->child(m), info.mName, info.mParentID);
+
+        ++m;
     }
 
     // Report directory entries to FUSE.
@@ -522,6 +572,28 @@ void Mount::releasedir(Request request,
     request.replyOk();
 }
 
+void Mount::replyEntry(Request request, InodeRef ref)
+{
+    auto info = ref->info();
+
+    // Mount's not writable.
+    if (!writable())
+        info.mPermissions = RDONLY;
+
+    pin(ref, info);
+
+    auto entry = fuse_entry_param();
+
+    std::memset(&entry, 0, sizeof(entry));
+
+    translate(entry,
+              map(info.mID),
+              info,
+              cacheTimeout(info, mHighThroughput));
+
+    request.replyEntry(entry);
+}
+
 void Mount::rename(Request request,
                    MountInodeID sourceParent,
                    const std::string& sourceName,
@@ -691,10 +763,13 @@ void Mount::setattr(Request request,
         return request.replyError(result);
 
     // Retrieve a current description of this node.
-    translate(attributes, inode, ref->info());
+    auto info = ref->info();
+
+    translate(attributes, inode, info);
 
     // Forward description to userspace.
-    request.replyAttributes(attributes, AttributeTimeout);
+    request.replyAttributes(attributes,
+                            cacheTimeout(info, mHighThroughput));
 }
 
 void Mount::statfs(Request request, MountInodeID inode)
@@ -787,6 +862,9 @@ void Mount::write(Request request,
 
 Mount::Mount(const MountInfo& info, MountDB& mountDB)
   : fuse::Mount(info, mountDB)
+  , mHighThroughput(info.mFlags.mHighThroughput)
+  , mListedEntries()
+  , mListedEntriesLock()
   , mActivities()
   , mExecutor(mountDB.executorFlags())
   , mSession(*this)
@@ -846,6 +924,8 @@ void Mount::invalidateEntry(const std::string& name,
     assert(child);
     assert(parent);
 
+    forgetListed(name, parent);
+
     mInvalidator.invalidateEntry(mActivities,
                                  map(child),
                                  name,
@@ -856,6 +936,8 @@ void Mount::invalidateEntry(const std::string& name, InodeID parent)
 {
     assert(parent);
 
+    forgetListed(name, parent);
+
     mInvalidator.invalidateEntry(mActivities, map(parent), name);
 }
 
@@ -0,0 +1,220 @@
+#!/usr/bin/env bash
+
+# Measures how quickly a MEGA-FS mount can list and stream data.
+#
+# The mount itself is expected to already exist. The integration tests'
+# mock client or megacli's "fuse mount add [-high-throughput]" can be used
+# to create one. Running this script once against a mount using the normal
+# profile and once against a mount using the high-throughput profile gives
+# a direct comparison of the two.
+
+# A pipeline only succeeds if all of its parts succeed.
+set -o pipefail
+
+# User didn't specify which mount we should benchmark.
+ERROR_BAD_ARGUMENTS=1
+
+# Couldn't locate (or access) a directory we need.
+ERROR_DIRECTORY_NOT_FOUND=3
+
+# Couldn't locate a program that we need.
+ERROR_PROGRAM_NOT_FOUND=4
+
+# Couldn't populate the benchmark directory.
+ERROR_COULDNT_POPULATE=5
+
+# Everything executed successfully.
+ERROR_SUCCESS=0
+
+# How many files should we create for the listing benchmark?
+NUM_FILES=${NUM_FILES:-5000}
+
+# How large should the file used for the streaming benchmark be?
+STREAM_SIZE=${STREAM_SIZE:-256M}
+
+# How many times should each listing be repeated?
+NUM_LISTINGS=${NUM_LISTINGS:-5}
+
+# die(message, result)
+#
+# Print MESSAGE to the standard error output and terminate the
+# program, returning RESULT to the shell.
+die()
+{
+    local message="$1"
+    local result=$2
+
+    printf "%s: %s\n" ERROR "$message" >&2
+
+    exit $result
+}
+
+# ensure_directory(path)
+#
+# Checks that PATH exists and denotes a directory. If not, this function
+# terminates the program and returns the error ERROR_DIRECTORY_NOT_FOUND to
+# the shell.
+ensure_directory()
+{
+    local path="$1"
+
+    test -d "$path" \
+      || die "Couldn't access directory \"$path\"." \
+             ${ERROR_DIRECTORY_NOT_FOUND}
+}
+
+# ensure_program(program)
+#
+# Checks that PROGRAM is present in the shell's search path and if not,
+# terminates the program and returns the error ERROR_PROGRAM_NOT_FOUND to
+# the shell.
+ensure_program()
+{
+    local program="$1"
+
+    command -v "$program" &> /dev/null \
+      || die "Couldn't find required program \"$program.\"" \
+             ${ERROR_PROGRAM_NOT_FOUND}
+}
+
+# ensure_programs()
+#
+# Checks that all programs required by this script are present in the
+# shell's search path. If any program we need isn't present, this function
+# will terminate the program and return the error ERROR_PROGRAM_NOT_FOUND to
+# the shell.
+ensure_programs()
+{
+    # So we can generate and time our listings.
+    ensure_program date
+    ensure_program ls
+    ensure_program seq
+    ensure_program touch
+
+    # So we can make sure the kernel's caches are cold.
+    ensure_program sync
+
+    # So we can measure streaming performance.
+    ensure_program fio
+}
+
+# drop_caches()
+#
+# Try and make sure that the kernel's page and dentry caches are cold.
+# This requires root privileges and is silently skipped otherwise.
+drop_caches()
+{
+    sync
+    echo 3 > /proc/sys/vm/drop_caches 2> /dev/null || true
+}
+
+# elapsed_ms(command...)
+#
+# Execute COMMAND and print how many milliseconds it took to complete.
+elapsed_ms()
+{
+    local begin=$(date +%s%N)
+
+    "$@" > /dev/null 2>&1
+
+    local end=$(date +%s%N)
+
+    echo $(( (end - begin) / 1000000 ))
+}
+
+# benchmark_listing(path)
+#
+# Populate a directory below PATH and measure how long it takes to list.
+benchmark_listing()
+{
+    local path="$1/listing"
+
+    # Populate the directory if necessary.
+    if ! test -d "$path"; then
+        mkdir "$path" \
+          || die "Couldn't create \"$path\"." ${ERROR_COULDNT_POPULATE}
+
+        for i in $(seq 1 $NUM_FILES); do
+            touch "$path/file-$i" \
+              || die "Couldn't create \"$path/file-$i\"." \
+                     ${ERROR_COULDNT_POPULATE}
+        done
+    fi
+
+    drop_caches
+
+    printf "ls -l (cold, %u entries): %u ms\n" \
+           $NUM_FILES \
+           $(elapsed_ms ls -l "$path")
+
+    for i in $(seq 1 $NUM_LISTINGS); do
+        printf "ls -l (warm #%u): %u ms\n" \
+               $i \
+               $(elapsed_ms ls -l "$path")
+    done
+}
+
+# benchmark_streaming(path)
+#
+# Measure write and read throughput of a single file below PATH.
+benchmark_streaming()
+{
+    local path="$1/streaming"
+
+    mkdir -p "$path" \
+      || die "Couldn't create \"$path\"." ${ERROR_COULDNT_POPULATE}
+
+    fio --name=sequential-write \
+        --filename="$path/stream" \
+        --rw=write \
+        --bs=1M \
+        --size=$STREAM_SIZE \
+        --end_fsync=1 \
+        --group_reporting
+
+    drop_caches
+
+    fio --name=sequential-read \
+        --filename="$path/stream" \
+        --rw=read \
+        --bs=1M \
+        --size=$STREAM_SIZE \
+        --group_reporting
+
+    fio --name=random-read \
+        --filename="$path/stream" \
+        --rw=randread \
+        --bs=4k \
+        --size=$STREAM_SIZE \
+        --runtime=30 \
+        --time_based \
+        --group_reporting
+}
+
+# main(arguments)
+#
+# Main entry point.
+main()
+{
+    # Make sure the programs we need are in the shell's search path.
+    ensure_programs
+
+    # Clarity.
+    local path="$1"
+
+    # The user hasn't specified which mount we should benchmark.
+    test $# -eq 1 -a -n "$path" \
+      || die "You didn't specify which mount we should benchmark." \
+             ${ERROR_BAD_ARGUMENTS}
+
+    # Make sure we can access the path the user's specified.
+    ensure_directory "$path"
+
+    benchmark_listing "$path"
+    benchmark_streaming "$path"
+
+    return $ERROR_SUCCESS
+}
+
+# Transfer control to our entry point.
+main "$@"
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <vector>
@@ -25,6 +26,8 @@ static Mount& mount(fuse_req_t request);
 
 static Mount& mount(void* context);
 
+static void negotiateHighThroughput(fuse_conn_info& connection);
+
 const fuse_lowlevel_ops Session::mOperations = {
     /*           init */ &init,
     /*        destroy */ nullptr,
@@ -97,7 +100,7 @@ void Session::access(fuse_req_t request,
                            mask);
 }
 
-void Session::init(void*, fuse_conn_info* connection)
+void Session::init(void* context, fuse_conn_info* connection)
 {
 #define ENTRY(name) {#name, name}
     const std::map<std::string, unsigned int> capabilities = {
@@ -117,6 +120,10 @@ void Session::init(void*, fuse_conn_info* connection)
 
     connection->want |= FUSE_CAP_ATOMIC_O_TRUNC;
 
+    // Mount would like the kernel to move data in larger chunks.
+    if (mount(context).mHighThroughput)
+        negotiateHighThroughput(*connection);
+
     for (auto& entry : capabilities)
     {
         auto capable = (connection->capable & entry.second) > 0;
@@ -124,6 +131,11 @@ void Session::init(void*, fuse_conn_info* connection)
 
         FUSEDebugF("init: %u%u %s", capable, wanted, entry.first.c_str());
     }
+
+    FUSEDebugF("init: max_background: %u, max_readahead: %u, max_write: %u",
+               connection->max_background,
+               connection->max_readahead,
+               connection->max_write);
 }
 
 void Session::lookup(fuse_req_t request,
@@ -750,6 +762,28 @@ std::string Session::nextRequest()
     }
 }
 
+void negotiateHighThroughput(fuse_conn_info& connection)
+{
+    // Let the kernel issue reads in parallel and send writes larger than
+    // a single page.
+    //
+    // Note that we don't ask for splice: libfuse 2.x only splices replies
+    // built from file descriptors and we always reply from memory.
+    connection.want |= connection.capable & (FUSE_CAP_ASYNC_READ
+                                             | FUSE_CAP_BIG_WRITES);
+
+    // Ask for writes at least as large as HighThroughputMaxWrite.
+    //
+    // libfuse shrinks this to fit its receive buffer after we return.
+    connection.max_write = std::min(std::max(connection.max_write,
+                                             HighThroughputMaxWrite),
+                                    KernelMaxWrite);
+
+    // Let more readahead and writeback requests be in flight.
+    connection.max_background = HighThroughputMaxBackground;
+    connection.congestion_threshold = HighThroughputCongestionThreshold;
+}
+
 Mount& mount(fuse_req_t request)
 {
     return mount(fuse_req_userdata(request));
@@ -1,5 +1,6 @@
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 
@@ -11,6 +12,8 @@
 #include <mega/fuse/platform/file_descriptor.h>
 #include <mega/fuse/platform/utility.h>
 
+#include <mega/utils.h>
+
 namespace mega
 {
 namespace fuse
@@ -18,6 +21,23 @@ namespace fuse
 namespace platform
 {
 
+double cacheTimeout(const InodeInfo& info, bool highThroughput)
+{
+    auto maximum = MaximumCacheTimeout;
+
+    if (highThroughput)
+        maximum = MaximumCacheTimeoutHighThroughput;
+
+    // How long has it been since the inode was last modified?
+    auto age = static_cast<double>(m_time(nullptr) - info.mModified);
+
+    // Inodes that have changed recently are likely to change again.
+    //
+    // Note that we can be generous with stable inodes as the kernel's
+    // caches are invalidated explicitly when a change is observed.
+    return std::clamp(age / 10.0, MinimumCacheTimeout, maximum);
+}
+
 FileDescriptorPair pipe(bool closeReaderOnFork,
                         bool closeWriterOnFork)
 {
@@ -76,10 +96,11 @@ void translate(struct stat& attributes,
 
 void translate(fuse_entry_param& entry,
                MountInodeID id,
-               const InodeInfo& info)
+               const InodeInfo& info,
+               double timeout)
 {
-    entry.attr_timeout = AttributeTimeout;
-    entry.entry_timeout = EntryTimeout;
+    entry.attr_timeout = timeout;
+    entry.entry_timeout = timeout;
     entry.generation = 0;
     entry.ino = id.get();
 
@@ -25,6 +25,7 @@
 #include "mega/command.h"
 #include "mega/megaclient.h"
 #include "mega/megaapp.h"
+#include "megafs.h"
 
 #ifdef USE_MEDIAINFO
 #include "MediaInfo/MediaInfo.h"
@@ -72,6 +73,166 @@ MediaFileInfo::MediaFileInfo()
     LOG_debug << "MediaInfo version: " << GetMediaInfoVersion();
 }
 
+const unsigned MediaFileInfo::EXTRACTION_THREADS = 2;
+
+MediaPropertiesExtractor::MediaPropertiesExtractor(std::shared_ptr<Waiter> waiter, unsigned threadCount, Extract extract)
+    : mExtract(std::move(extract))
+    , mWaiter(std::move(waiter))
+{
+    assert(threadCount > 0);
+
+    if (!mExtract)
+    {
+        mExtract = [](Job& job, FileSystemAccess& fsAccess) {
+            job.vp.extractMediaPropertyFileAttributes(job.path, &fsAccess);
+        };
+    }
+
+    while (threadCount--)
+    {
+        try
+        {
+            mThreads.emplace_back([this]() { loop(); });
+        }
+        catch (std::system_error& e)
+        {
+            LOG_err << "Failed to start media extraction thread: " << e.what();
+        }
+    }
+}
+
+MediaPropertiesExtractor::~MediaPropertiesExtractor()
+{
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mStopping = true;
+    }
+
+    mCV.notify_all();
+
+    for (auto& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+void MediaPropertiesExtractor::push(std::unique_ptr<Job> job)
+{
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mPending.emplace_back(std::move(job));
+    }
+
+    mCV.notify_one();
+}
+
+std::unique_ptr<MediaPropertiesExtractor::Job> MediaPropertiesExtractor::pop()
+{
+    std::lock_guard<std::mutex> guard(mMutex);
+
+    if (mFinished.empty())
+    {
+        return nullptr;
+    }
+
+    auto job = std::move(mFinished.front());
+    mFinished.pop_front();
+
+    return job;
+}
+
+void MediaPropertiesExtractor::loop()
+{
+    // each thread has its own so that files can be opened concurrently
+    FSACCESS_CLASS fsAccess;
+
+    for (;;)
+    {
+        std::unique_ptr<Job> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCV.wait(lock, [this]() { return mStopping || !mPending.empty(); });
+
+            // jobs still pending are of no interest to anyone once we're stopping
+            if (mStopping)
+            {
+                return;
+            }
+
+            job = std::move(mPending.front());
+            mPending.pop_front();
+        }
+
+        mExtract(*job, fsAccess);
+
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            mFinished.emplace_back(std::move(job));
+        }
+
+        if (mWaiter)
+        {
+            mWaiter->notify();
+        }
+    }
+}
+
+void MediaFileInfo::queueMediaPropertiesExtraction(MegaClient* client, const LocalPath& localFilename, NodeOrUploadHandle handle, uint32_t fakey[4])
+{
+    if (!extractor)
+    {
+        extractor.reset(new MediaPropertiesExtractor(client->waiter, EXTRACTION_THREADS));
+    }
+
+    std::unique_ptr<MediaPropertiesExtractor::Job> job(new MediaPropertiesExtractor::Job());
+    job->path = localFilename;
+    job->handle = handle;
+    memcpy(job->fakey, fakey, sizeof(job->fakey));
+
+    extractor->push(std::move(job));
+}
+
+int MediaFileInfo::checkevents(MegaClient* client)
+{
+    if (!extractor)
+    {
+        return 0;
+    }
+
+    int r = 0;
+
+    while (auto job = extractor->pop())
+    {
+        r = Waiter::NEEDEXEC;
+
+        if (job->handle.isNodeHandle())
+        {
+            sendOrQueueMediaPropertiesFileAttributesForExistingFile(job->vp, job->fakey, client, job->handle.nodeHandle());
+            continue;
+        }
+
+        UploadHandle uploadHandle = job->handle.uploadHandle();
+        auto uploadFAPtr = client->fileAttributesUploading.lookupExisting(uploadHandle);
+
+        if (!uploadFAPtr)
+        {
+            LOG_debug << "Media attributes extracted for an upload that no longer exists";
+            continue;
+        }
+
+        if (!queueMediaPropertiesFileAttributesForUpload(job->vp, job->fakey, client, uploadHandle, uploadFAPtr->transfer))
+        {
+            // reduce the number of required attributes to let the upload continue
+            uploadFAPtr->pendingfa.erase(fatype(fa_media));
+        }
+
+        client->checkfacompletion(uploadHandle);
+    }
+
+    return r;
+}
+
 void MediaFileInfo::requestCodecMappingsOneTime(MegaClient* client, const LocalPath& ifSuitableFilename)
 {
     if (!mediaCodecsReceived && !mediaCodecsRequested)
@@ -1753,6 +1753,8 @@ MegaError *SynchronousRequestListener::getError() const
 //Transfer callbacks
 void MegaTransferListener::onTransferStart(MegaApi *, MegaTransfer *)
 { }
+void MegaTransferListener::onTransfersStart(MegaApi*, MegaTransferList*)
+{ }
 void MegaTransferListener::onTransferFinish(MegaApi*, MegaTransfer *, MegaError*)
 { }
 void MegaTransferListener::onTransferUpdate(MegaApi *, MegaTransfer *)
@@ -3596,6 +3598,11 @@ void MegaApi::startUpload(const char *localPath, MegaNode *parent, const char *f
                        false /*forceNewUpload*/, FS_UNKNOWN, convertToCancelToken(cancelToken), listener);
 }
 
+void MegaApi::startUploads(MegaStringList* localPaths, MegaNode* parent, const char* appData, bool startFirst, MegaCancelToken* cancelToken, bool notifyEachStart, MegaTransferListener* listener)
+{
+    pImpl->startUploads(startFirst, localPaths, parent, appData, convertToCancelToken(cancelToken), notifyEachStart, listener);
+}
+
 void MegaApi::startUploadForChat(const char *localPath, MegaNode *parent, const char *appData, bool isSourceTemporary, const char* fileName, MegaTransferListener *listener)
 {
     pImpl->startUpload(true /*startFirst*/, localPath, parent, fileName, NULL /*targetUser*/, INVALID_CUSTOM_MOD_TIME /*mtime*/,
@@ -3608,6 +3615,11 @@ void MegaApi::startDownload(MegaNode* node, const char* localPath, const char *c
     pImpl->startDownload(startFirst, node, localPath, customName, 0 /*folderTransferTag*/, appData, convertToCancelToken(cancelToken), collisionCheck, collisionResolution, undelete, listener);
 }
 
+void MegaApi::startDownloads(MegaNodeList* nodes, const char* localFolder, const char* appData, bool startFirst, MegaCancelToken* cancelToken, int collisionCheck, int collisionResolution, bool notifyEachStart, MegaTransferListener* listener)
+{
+    pImpl->startDownloads(startFirst, nodes, localFolder, appData, convertToCancelToken(cancelToken), collisionCheck, collisionResolution, notifyEachStart, listener);
+}
+
 void MegaApi::cancelTransfer(MegaTransfer *t, MegaRequestListener *listener)
 {
     pImpl->cancelTransfer(t, listener);
@@ -4625,6 +4637,16 @@ unsigned long long MegaApi::getNumNodesAtCacheLRU() const
     return pImpl->getNumNodesAtCacheLRU();
 }
 
+bool MegaApi::setFileAttributeCache(const char* path, long long maxSize)
+{
+    return pImpl->setFileAttributeCache(path, maxSize);
+}
+
+double MegaApi::getFileAttributeCacheHitRate()
+{
+    return pImpl->getFileAttributeCacheHitRate();
+}
+
 long long MegaApi::getTotalDownloadedBytes()
 {
     return pImpl->getTotalDownloadedBytes();
@@ -5827,6 +5849,11 @@ MegaSetElement* MegaApi::getSetElement(MegaHandle sid, MegaHandle eid)
     return pImpl->getSetElement(sid, eid);
 }
 
+MegaSetElementList* MegaApi::getSetElementsByNode(MegaHandle nodeHandle)
+{
+    return pImpl->getSetElementsByNode(nodeHandle);
+}
+
 bool MegaApi::isExportedSet(MegaHandle sid)
 {
     return pImpl->isExportedSet(sid);
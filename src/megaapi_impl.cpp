@@ -8711,6 +8711,27 @@ void MegaApiImpl::abortPendingActions(error preverror)
             fireOnTransferFinish(transfer, std::make_unique<MegaErrorPrivate>(preverror));
         }
 
+        // clear batches still waiting in the request queue
+        set<std::shared_ptr<TransferBatch>> batches;
+        {
+            std::lock_guard<std::mutex> g(pendingTransferBatchesMutex);
+            batches.swap(pendingTransferBatches);
+        }
+
+        for (auto& batch : batches)
+        {
+            currentTransferBatch = batch.get();
+            while (MegaTransferPrivate *transfer = batch->queue.pop())
+            {
+                fireOnTransferStart(transfer);
+                transfer->setState(MegaTransfer::STATE_FAILED);
+                fireOnTransferFinish(transfer, std::make_unique<MegaErrorPrivate>(preverror));
+            }
+            currentTransferBatch = nullptr;
+
+            fireOnTransfersStart(*batch);
+        }
+
         // clear existing transfers
         while (!transferMap.empty())
         {
@@ -9352,6 +9373,44 @@ void MegaApiImpl::startUpload(bool startFirst, const char* localPath, MegaNode*
     waiter->notify();
 }
 
+void MegaApiImpl::startUploads(bool startFirst, MegaStringList* localPaths, MegaNode* parent, const char* appData, CancelToken cancelToken, bool notifyEachStart, MegaTransferListener* listener)
+{
+    if (!localPaths || !localPaths->size())
+    {
+        return;
+    }
+
+    auto batch = std::make_shared<TransferBatch>();
+    batch->listener = listener;
+    batch->notifyEachStart = notifyEachStart;
+
+    // Paths may live on different filesystems: determine the type once per parent directory.
+    map<LocalPath, FileSystemType> fsTypes;
+
+    for (int i = 0; i < localPaths->size(); ++i)
+    {
+        const char* localPath = localPaths->get(i);
+        FileSystemType fsType = FS_UNKNOWN;
+
+        if (localPath)
+        {
+            LocalPath parentPath = LocalPath::fromAbsolutePath(localPath).parentPath();
+            auto it = fsTypes.find(parentPath);
+
+            if (it == fsTypes.end())
+            {
+                it = fsTypes.emplace(parentPath, fsAccess->getlocalfstype(parentPath)).first;
+            }
+
+            fsType = it->second;
+        }
+
+        batch->queue.push(createUploadTransfer(startFirst, localPath, parent, nullptr, nullptr, MegaApi::INVALID_CUSTOM_MOD_TIME, 0, false, appData, false, false, fsType, cancelToken, listener));
+    }
+
+    startTransferBatch(std::move(batch));
+}
+
 void MegaApiImpl::startUploadForSupport(const char* localPath, bool isSourceFileTemporary, FileSystemType fsType, MegaTransferListener* listener)
 {
     MegaTransferPrivate* transfer = createUploadTransfer(true, localPath, nullptr, nullptr, MegaClient::SUPPORT_USER_HANDLE.c_str(), MegaApi::INVALID_CUSTOM_MOD_TIME, 0, false, nullptr, isSourceFileTemporary, false, fsType, CancelToken(), listener);
@@ -9367,6 +9426,70 @@ void MegaApiImpl::startDownload (bool startFirst, MegaNode *node, const char* lo
     waiter->notify();
 }
 
+void MegaApiImpl::startDownloads(bool startFirst, MegaNodeList* nodes, const char* localFolder, const char* appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool notifyEachStart, MegaTransferListener* listener)
+{
+    if (!nodes || !nodes->size())
+    {
+        return;
+    }
+
+    auto batch = std::make_shared<TransferBatch>();
+    batch->listener = listener;
+    batch->notifyEachStart = notifyEachStart;
+
+    // Every file goes to the same folder, so determine its filesystem type once.
+    auto fsType = localFolder
+                  ? fsAccess->getlocalfstype(LocalPath::fromAbsolutePath(localFolder))
+                  : FS_UNKNOWN;
+
+    for (int i = 0; i < nodes->size(); ++i)
+    {
+        batch->queue.push(createDownloadTransfer(startFirst, nodes->get(i), localFolder, nullptr, 0, appData, cancelToken, collisionCheck, collisionResolution, false, listener, fsType));
+    }
+
+    startTransferBatch(std::move(batch));
+}
+
+void MegaApiImpl::startTransferBatch(std::shared_ptr<TransferBatch> batch)
+{
+    {
+        std::lock_guard<std::mutex> g(pendingTransferBatchesMutex);
+        pendingTransferBatches.insert(batch);
+    }
+
+    MegaRequestPrivate* request = new MegaRequestPrivate(MegaRequest::TYPE_EXECUTE_ON_THREAD, nullptr);
+    request->functionToExecute = std::make_shared<ExecuteOnce>([this, batch]() {
+        // Keeps removeTransferListener() from racing with the batch's listener.
+        SdkMutexGuard guard(sdkMutex);
+
+        {
+            std::lock_guard<std::mutex> g(pendingTransferBatchesMutex);
+
+            // Batch was aborted while it was queued.
+            if (!pendingTransferBatches.erase(batch))
+            {
+                return;
+            }
+        }
+
+        // Transfers started individually before the batch go first.
+        while (!transferQueue.empty() && sendPendingTransfers(nullptr))
+        {
+        }
+
+        // The batch is processed in one shot: one lock of sdkMutex and one transfer DB commit.
+        currentTransferBatch = batch.get();
+        sendPendingTransfers(&batch->queue);
+        currentTransferBatch = nullptr;
+
+        fireOnTransfersStart(*batch);
+    });
+
+    // Unlike executeOnThread(), queue at the back so the batch doesn't overtake earlier requests.
+    requestQueue.push(request);
+    waiter->notify();
+}
+
 MegaTransferPrivate* MegaApiImpl::createDownloadTransfer(bool startFirst, MegaNode *node, const char* localPath, const char *customName, int folderTransferTag, const char *appData, CancelToken cancelToken, int collisionCheck, int collisionResolution, bool undelete, MegaTransferListener *listener, FileSystemType fsType)
 {
     assert(!undelete || node);
@@ -9529,70 +9652,14 @@ int MegaApiImpl::syncPathState(string* platformEncoded)
         return cached_ts;
     }
 
-    handle containingSyncId = client->syncs.getSyncIdContainingActivePath(localpath);
-
-    if (containingSyncId == UNDEF) return MegaApi::STATE_IGNORED;
-
-    // Avoid blocking on the mutex for a long time, as we may be blocking windows explorer (or another platform's equivalent) from opening or displaying a window, unrelated to sync folders
-    // We try to lock the SDK mutex.  If we can't get it in 10ms then we return a simple default, and subsequent requests try to lock the mutex but don't wait.
-    std::unique_lock<std::timed_mutex> g(client->syncs.mLocalNodeChangeMutex, std::defer_lock);
-    if ((!syncPathStateLockTimeout && !g.try_lock_for(std::chrono::milliseconds(10))) ||
-        (syncPathStateLockTimeout && !g.try_lock()))
+    // the sync thread publishes tree states as it reports them,
+    // so we never wait for (or are blocked by) a sync pass in progress
+    treestate_t ts;
+    if (!client->syncs.getSyncStateForLocalPath(localpath, ts))
     {
-        // mLocalNodeChangeMutex is not locked
-
-        if (!syncPathStateLockTimeout)
-        {
-            LOG_verbose << "Cannot get lock to report treestate for path " << localpath;
-        }
-
-        syncPathStateLockTimeout = true;
-
-        // store up to 1000 paths for lookup later when we can lock mLocalNodeChangeMutex
-        lock_guard<mutex> g(syncPathStateDeferredSetMutex);
-        if (syncPathStateDeferredSet.size() < 1024)
-        {
-            syncPathStateDeferredSet.insert(localpath);
-        }
-
         return MegaApi::STATE_IGNORED;
     }
 
-    // mLocalNodeChangeMutex is locked (and will be unlocked by unique_lock destructor)
-
-    treestate_t ts = client->syncs.getSyncStateForLocalPath(containingSyncId, localpath);
-
-    if (syncPathStateLockTimeout)
-    {
-        LOG_verbose << "Resuming reporting treestate. " << ts << " for path " << localpath;
-
-        // once we do manage to lock, return to normal operation.
-        syncPathStateLockTimeout = false;
-
-        // issue notifications for the OS to ask about the paths we skipped while we couldn't lock the mutex
-        auto tmp = std::make_shared<set<LocalPath>>();
-        {
-            lock_guard<mutex> g(syncPathStateDeferredSetMutex);
-            tmp->swap(syncPathStateDeferredSet);
-        }
-        LOG_verbose << "Issuing updates for OS path icon ovelays for . " << tmp->size() << " paths";
-        auto mc = client;
-        client->syncs.queueSync([tmp, mc](){
-            LOG_verbose << "Processing updates for OS path icon ovelays for . " << tmp->size() << " paths";
-            for (auto& p : *tmp)
-            {
-                treestate_t ts;
-                nodetype_t nt;
-                SyncConfig sc;
-                if (mc->syncs.getSyncStateForLocalPath(p, ts, nt, sc))
-                {
-                    mc->app->syncupdate_treestate(sc, p, ts, nt);
-                }
-            }
-            LOG_verbose << "Completed updates for OS path icon ovelays for . " << tmp->size() << " paths";
-        }, "syncPathState catchup after glitches");
-    }
-
     mRecentlyRequestedOverlayIconPaths.addOrUpdate(localpath, ts);
 
     return ts;
@@ -12379,7 +12446,8 @@ sharedNode_vector MegaApiImpl::searchInNodeManager(const MegaSearchFilter* filte
     }
 
     const NodeSearchPage& np = searchPage ? NodeSearchPage(searchPage->startingOffset(), searchPage->size()) : NodeSearchPage(0, 0);
-    sharedNode_vector results = client->mNodeManager.searchNodes(nf, order, cancelToken, np);
+    // results are copied into MegaNodes right away, so don't load them into memory
+    sharedNode_vector results = client->mNodeManager.searchNodes(nf, order, cancelToken, np, true);
     return results;
 }
 
@@ -14910,6 +14978,7 @@ void MegaApiImpl::request_error(error e)
     if (e == API_ESID)
     {
         client->locallogout(true, keepSyncConfigsFile);
+        removeNodeSnapshots(nullptr);
     }
 
     request->performRequest = [this, request]()
@@ -15099,6 +15168,8 @@ void MegaApiImpl::logout_result(error e, MegaRequestPrivate* request)
         mLastKnownRootNode.reset();
         mLastKnownVaultNode.reset();
         mLastKnownRubbishNode.reset();
+
+        removeNodeSnapshots(nullptr);
     }
     fireOnRequestFinish(request, std::make_unique<MegaErrorPrivate>(e));
 }
@@ -15331,6 +15402,9 @@ void MegaApiImpl::nodes_updated(sharedNode_vector* nodes, int count)
         return;
     }
 
+    // Before the app hears about the changes, so it can't see stale nodes.
+    removeNodeSnapshots(nodes);
+
     MegaNodeList *nodeList = NULL;
     if (nodes != NULL)
     {
@@ -16105,6 +16179,7 @@ void MegaApiImpl::whyamiblocked_result(int code)
         {
             bool keepSyncConfigsFile = true;
             client->locallogout(true, keepSyncConfigsFile);
+            removeNodeSnapshots(nullptr);
 
             MegaRequestPrivate *logoutRequest = new MegaRequestPrivate(MegaRequest::TYPE_LOGOUT);
             logoutRequest->setFlag(false);
@@ -16556,6 +16631,18 @@ bool MegaApiImpl::removeTransferListener(MegaTransferListener* listener)
 
     transferQueue.removeListener(listener);
 
+    {
+        std::lock_guard<std::mutex> g(pendingTransferBatchesMutex);
+        for (auto& batch : pendingTransferBatches)
+        {
+            batch->queue.removeListener(listener);
+            if (batch->listener == listener)
+            {
+                batch->listener = nullptr;
+            }
+        }
+    }
+
     return removed;
 }
 
@@ -16725,12 +16812,43 @@ void MegaApiImpl::fireOnTransferStart(MegaTransferPrivate *transfer)
     }
 
     MegaTransferListener* listener = transfer->getListener();
+    if (listener && currentTransferBatch && listener == currentTransferBatch->listener)
+    {
+        currentTransferBatch->started.emplace_back(transfer->copy());
+
+        if (!currentTransferBatch->notifyEachStart)
+        {
+            return;
+        }
+    }
+
     if(listener)
     {
         listener->onTransferStart(api, transfer);
     }
 }
 
+void MegaApiImpl::fireOnTransfersStart(TransferBatch& batch)
+{
+    assert(threadId == std::this_thread::get_id());
+
+    if (batch.listener && !batch.started.empty())
+    {
+        vector<MegaTransfer*> started;
+        started.reserve(batch.started.size());
+
+        for (auto& transfer : batch.started)
+        {
+            started.emplace_back(transfer.get());
+        }
+
+        MegaTransferListPrivate transfers(started.data(), static_cast<int>(started.size()));
+        batch.listener->onTransfersStart(api, &transfers);
+    }
+
+    batch.started.clear();
+}
+
 void MegaApiImpl::fireOnTransferFinish(MegaTransferPrivate *transfer, unique_ptr<MegaErrorPrivate> e)
 {
     assert(threadId == std::this_thread::get_id());
@@ -18059,7 +18177,8 @@ MegaNodeList *MegaApiImpl::getChildren(const MegaSearchFilter* filter, int order
     NodeSearchFilter nf;
     nf.copyFrom(*filter);
     const NodeSearchPage& np = searchPage ? NodeSearchPage(searchPage->startingOffset(), searchPage->size()) : NodeSearchPage(0u, 0u);
-    sharedNode_vector results = client->mNodeManager.getChildren(nf, order, cancelToken, np);
+    // results are copied into MegaNodes right away, so don't load them into memory
+    sharedNode_vector results = client->mNodeManager.getChildren(nf, order, cancelToken, np, true);
 
     return new MegaNodeListPrivate(results);
 }
@@ -18306,6 +18425,12 @@ MegaNode* MegaApiImpl::getParentNode(MegaNode* n)
 {
     if(!n) return NULL;
 
+    // return without locking the main mutex if possible.
+    if (unique_ptr<MegaNode> snapshot{getNodeSnapshot(n->getHandle())})
+    {
+        return getNodeByHandle(snapshot->getParentHandle());
+    }
+
     SdkMutexGuard g(sdkMutex);
     std::shared_ptr<Node> node = client->nodebyhandle(n->getHandle());
     if(!node)
@@ -18385,8 +18510,67 @@ MegaNode* MegaApiImpl::getNodeByPathOfType(const char* path, MegaNode* node, int
 MegaNode* MegaApiImpl::getNodeByHandle(handle handle)
 {
     if(handle == UNDEF) return NULL;
+
+    // return without locking the main mutex if possible.
+    if (auto* snapshot = getNodeSnapshot(handle))
+    {
+        return snapshot;
+    }
+
     SdkMutexGuard g(sdkMutex);
-    return MegaNodePrivate::fromNode(client->nodebyhandle(handle).get());
+    MegaNode* node = MegaNodePrivate::fromNode(client->nodebyhandle(handle).get());
+
+    // Nodes still waiting for their key can be decrypted without being reported.
+    if (node && node->isNodeKeyDecrypted())
+    {
+        addNodeSnapshot(*node);
+    }
+
+    return node;
+}
+
+MegaNode* MegaApiImpl::getNodeSnapshot(handle h)
+{
+    lock_guard<mutex> g(mNodeSnapshotsMutex);
+
+    auto i = mNodeSnapshots.find(h);
+
+    if (i == mNodeSnapshots.end())
+    {
+        return nullptr;
+    }
+
+    return i->second->copy();
+}
+
+void MegaApiImpl::addNodeSnapshot(MegaNode& node)
+{
+    // sdkMutex must be held so that we can't race with nodes_updated.
+    lock_guard<mutex> g(mNodeSnapshotsMutex);
+
+    // Keep memory bounded, snapshots are cheap to recreate.
+    if (mNodeSnapshots.size() >= MAX_NODE_SNAPSHOTS)
+    {
+        mNodeSnapshots.clear();
+    }
+
+    mNodeSnapshots[node.getHandle()].reset(node.copy());
+}
+
+void MegaApiImpl::removeNodeSnapshots(const sharedNode_vector* nodes)
+{
+    lock_guard<mutex> g(mNodeSnapshotsMutex);
+
+    if (!nodes)
+    {
+        mNodeSnapshots.clear();
+        return;
+    }
+
+    for (auto& node : *nodes)
+    {
+        mNodeSnapshots.erase(node->nodehandle);
+    }
 }
 
 MegaContactRequest *MegaApiImpl::getContactRequestByHandle(MegaHandle handle)
@@ -18582,6 +18766,10 @@ unsigned MegaApiImpl::sendPendingTransfers(TransferQueue *queue, MegaRecursiveOp
     // passed to the SDK.
     bool canSplit = !queue;
 
+    // Batches usually upload many files to the same parent, so remember the last one we looked up.
+    handle lastParentHandle = UNDEF;
+    std::shared_ptr<Node> lastParent;
+
     while (MegaTransferPrivate *transfer = auxQueue.pop())
     {
         error e = API_OK;
@@ -18621,7 +18809,13 @@ unsigned MegaApiImpl::sendPendingTransfers(TransferQueue *queue, MegaRecursiveOp
                 const char* fileName = transfer->getFileName();
                 int64_t mtime = transfer->getTime();
                 bool isSourceTemporary = transfer->isSourceFileTemporary();
-                std::shared_ptr<Node> parent = client->nodebyhandle(transfer->getParentHandle());
+                if (transfer->getParentHandle() != lastParentHandle)
+                {
+                    lastParentHandle = transfer->getParentHandle();
+                    lastParent = client->nodebyhandle(lastParentHandle);
+                }
+
+                std::shared_ptr<Node> parent = lastParent;
                 bool startFirst = transfer->shouldStartFirst();
 
                 // This bool below is a bit tricky: for example, this would be true for uploadForSupport: targetUser param on createUploadTransfer is populated with MegaClient::SUPPORT_USER_HANDLE (length = 11),
@@ -19593,6 +19787,7 @@ error MegaApiImpl::performRequest_login(MegaRequestPrivate* request)
 
             error e = API_OK;
             client->locallogout(false, true);
+            removeNodeSnapshots(nullptr);
             if (sessionKey)
             {
                 client->login(Base64::atob(string(sessionKey)));
@@ -20697,6 +20892,7 @@ error MegaApiImpl::performRequest_logout(MegaRequestPrivate* request)
             else
             {
                 client->locallogout(false, true);
+                removeNodeSnapshots(nullptr);
                 client->restag = request->getTag();
                 logout_result(API_OK, request);
             }
@@ -21734,6 +21930,7 @@ error MegaApiImpl::performRequest_createAccount(MegaRequestPrivate* request)
                 requestMap[reqtag] = request;
 
                 client->locallogout(false, true);
+                removeNodeSnapshots(nullptr);
 
                 if (resumeProcess)
                 {
@@ -22458,6 +22655,13 @@ void MegaApiImpl::cancelTransfers(int direction, MegaRequestListener* listener)
 
             // 1. Set all intermediate layer MegaTransfer object cancel tokens
             transferQueue.setAllCancelled(cancelled, direction);
+            {
+                std::lock_guard<std::mutex> g(pendingTransferBatchesMutex);
+                for (auto& batch : pendingTransferBatches)
+                {
+                    batch->queue.setAllCancelled(cancelled, direction);
+                }
+            }
             for (auto& t : transferMap)
             {
                 if (t.second->getType() == direction
@@ -25567,6 +25771,27 @@ unsigned long long MegaApiImpl::getNumNodesAtCacheLRU() const
     return client->mNodeManager.getNumNodesAtCacheLRU();
 }
 
+bool MegaApiImpl::setFileAttributeCache(const char* path, long long maxSize)
+{
+    SdkMutexGuard g(sdkMutex);
+
+    if (path && maxSize <= 0)
+    {
+        return false;
+    }
+
+    return client->faCache.enable(path ? LocalPath::fromAbsolutePath(path) : LocalPath(), maxSize);
+}
+
+double MegaApiImpl::getFileAttributeCacheHitRate()
+{
+    SdkMutexGuard g(sdkMutex);
+
+    auto requests = client->faCache.hits + client->faCache.misses;
+
+    return requests ? static_cast<double>(client->faCache.hits) / static_cast<double>(requests) : 0;
+}
+
 long long MegaApiImpl::getTotalDownloadedBytes()
 {
     return totalDownloadedBytes;
@@ -26347,6 +26572,15 @@ MegaSetElement* MegaApiImpl::getSetElement(MegaHandle sid, MegaHandle eid)
     return el ? (new MegaSetElementPrivate(*el)) : nullptr;
 }
 
+MegaSetElementList* MegaApiImpl::getSetElementsByNode(MegaHandle nodeHandle)
+{
+    SdkMutexGuard g(sdkMutex);
+
+    auto elements = client->getSetElementsByNode(nodeHandle);
+
+    return new MegaSetElementListPrivate(elements.data(), static_cast<int>(elements.size()));
+}
+
 MegaSetListPrivate::MegaSetListPrivate(const Set *const* sets, int count)
 {
     if (sets && count)
@@ -38658,6 +38892,11 @@ size_t MegaFuseInodeCacheFlagsPrivate::getCleanSizeThreshold() const
     return mFlags.mCleanSizeThreshold;
 }
 
+size_t MegaFuseInodeCacheFlagsPrivate::getMaxListingSize() const
+{
+    return mFlags.mMaxListingSize;
+}
+
 size_t MegaFuseInodeCacheFlagsPrivate::getMaxSize() const
 {
     return mFlags.mMaxSize;
@@ -38678,6 +38917,11 @@ void MegaFuseInodeCacheFlagsPrivate::setCleanSizeThreshold(std::size_t size)
     mFlags.mCleanSizeThreshold = size;
 }
 
+void MegaFuseInodeCacheFlagsPrivate::setMaxListingSize(std::size_t size)
+{
+    mFlags.mMaxListingSize = size;
+}
+
 void MegaFuseInodeCacheFlagsPrivate::setMaxSize(std::size_t size)
 {
     mFlags.mMaxSize = size;
@@ -38832,6 +39076,11 @@ const fuse::MountFlags& MegaMountFlagsPrivate::getFlags() const
     return mFlags;
 }
 
+bool MegaMountFlagsPrivate::getHighThroughput() const
+{
+    return mFlags.mHighThroughput;
+}
+
 const char* MegaMountFlagsPrivate::getName() const
 {
     return mFlags.mName.c_str();
@@ -38853,6 +39102,11 @@ void MegaMountFlagsPrivate::setEnableAtStartup(bool enable)
     mFlags.mPersistent |= true;
 }
 
+void MegaMountFlagsPrivate::setHighThroughput(bool highThroughput)
+{
+    mFlags.mHighThroughput = highThroughput;
+}
+
 void MegaMountFlagsPrivate::setName(const char* name)
 {
     assert(name);
@@ -85,6 +85,12 @@ const unsigned MegaClient::MAX_RAIDTRANSFERS_FOR_MOBILE = std::max<unsigned>(MAX
 // i.e., there must be at least this number of raid transfers to let us predict whether the next download transfer will be raided or non-raided
 const unsigned MegaClient::MEANINGFUL_PORTION_OF_MAXTRANSFERS_QUEUE_FOR_RAID_PREDICTIVE_SYSTEM = std::max<unsigned>(MAXTRANSFERS / 6, 1);
 
+// maximum number of transfers whose progress is waiting to be written to the transfer cache
+const size_t MegaClient::TRANSFERCACHE_MAX_DIRTY = 64;
+
+// maximum time progress may wait to be written to the transfer cache
+const dstime MegaClient::TRANSFERCACHE_FLUSH_DS = 30;
+
 // maximum number of queued putfa before halting the upload queue
 const int MegaClient::MAXQUEUEDFA = 30;
 
@@ -1601,6 +1607,7 @@ void MegaClient::init()
     pendingcs_serverBusySent = false;
 
     btcs.reset();
+    btcsUnordered.reset();
     btsc.reset();
     btpfa.reset();
     btbadhost.reset();
@@ -1643,6 +1650,7 @@ MegaClient::MegaClient(MegaApp* a, shared_ptr<Waiter> w, HttpIO* h, DbAccess* d,
    , useralerts(*this)
    , btugexpiration(rng)
    , btcs(rng)
+   , btcsUnordered(rng)
    , btbadhost(rng)
    , btworkinglock(rng)
    , btreqstat(rng)
@@ -1651,16 +1659,20 @@ MegaClient::MegaClient(MegaApp* a, shared_ptr<Waiter> w, HttpIO* h, DbAccess* d,
    , fsaccess(new FSACCESS_CLASS())
    , dbaccess(d)
    , mNodeManager(*this)
+   , faCache(*fsaccess)
 #ifdef ENABLE_SYNC
     , syncs(*this)
 #endif
    , reqs(rng)
+   , reqsUnordered(rng)
    , mKeyManager(*this)
    , mClientType(clientType)
    , mJourneyId(fsaccess, dbaccess ? dbaccess->rootPath() : LocalPath())
    , mFuseClientAdapter(*this)
    , mFuseService(mFuseClientAdapter)
 {
+    reqs.unorderedLane = &reqsUnordered;
+
     mNodeManager.reset();
     sctable.reset();
     pendingsccommit = false;
@@ -2155,6 +2167,15 @@ void MegaClient::exec()
             activatefa();
         }
 
+        while (!faCacheHits.empty())
+        {
+            auto hit = std::move(faCacheHits.front());
+            faCacheHits.pop_front();
+
+            restag = hit.tag;
+            app->fa_complete(hit.nodehandle, hit.type, hit.data.data(), static_cast<uint32_t>(hit.data.size()));
+        }
+
         if (fafcs.size())
         {
             // file attribute fetching (handled in parallel on a per-cluster basis)
@@ -2374,44 +2395,12 @@ void MegaClient::exec()
                             else
                             {
                                 // request failed
-                                JSON json;
-                                json.pos = pendingcs->in.c_str();
-                                std::string requestError;
-                                error e;
-                                bool valid = json.storeobject(&requestError);
-                                if (valid)
-                                {
-                                    if (strncmp(requestError.c_str(), "{\"err\":", 7) == 0)
-                                    {
-                                        e = (error)atoi(requestError.c_str() + 7);
-                                    }
-                                    else
-                                    {
-                                        e = (error)atoi(requestError.c_str());
-                                    }
-                                }
-                                else
-                                {
-                                    e = API_EINTERNAL;
-                                    requestError = std::to_string(e);
-                                }
-
-                                if (!e)
-                                {
-                                    e = API_EINTERNAL;
-                                    requestError = std::to_string(e);
-                                }
-
-                                if (e == API_EBLOCKED && sid.size())
-                                {
-                                    block();
-                                }
-
                                 // A failed request implies any retry in progress has ended.
                                 if (csretrying)
                                     app->notify_retry(0, RETRY_NONE);
 
-                                app->request_error(e);
+                                std::string requestError;
+                                processRequestError(pendingcs->in, requestError);
                                 delete pendingcs;
                                 pendingcs = NULL;
                                 csretrying = false;
@@ -2468,10 +2457,7 @@ void MegaClient::exec()
                         abortlockrequest();
                         if (pendingcs->sslcheckfailed)
                         {
-                            sendevent(99453, "Invalid public key");
-                            sslfakeissuer = pendingcs->sslfakeissuer;
-                            app->request_error(API_ESSL);
-                            sslfakeissuer.clear();
+                            reportSslCheckFailure(*pendingcs);
 
                             if (!retryessl)
                             {
@@ -2524,24 +2510,7 @@ void MegaClient::exec()
                     string idempotenceId;
                     *pendingcs->out = reqs.serverrequest(pendingcs->includesFetchingNodes, v3, this, idempotenceId);
 
-                    pendingcs->posturl = httpio->APIURL;
-                    pendingcs->posturl.append("cs?id=");
-                    pendingcs->posturl.append(idempotenceId);
-                    pendingcs->posturl.append(getAuthURI());
-                    pendingcs->posturl.append(appkey);
-
-                    pendingcs->posturl.append(v3 ? "&v=3" : "&v=2");
-
-                    if (lang.size())
-                    {
-                        pendingcs->posturl.append("&");
-                        pendingcs->posturl.append(lang);
-                    }
-                    if (trackJourneyId())
-                    {
-                        pendingcs->posturl.append("&j=");
-                        pendingcs->posturl.append(mJourneyId.getValue());
-                    }
+                    pendingcs->posturl = csurl(idempotenceId, v3);
                     pendingcs->type = REQ_JSON;
 
                     if (pendingcs->includesFetchingNodes && !mNodeManager.hasCacheLoaded())
@@ -2562,6 +2531,8 @@ void MegaClient::exec()
             break;
         }
 
+        execunorderedcs();
+
         // handle the request for the last 50 UserAlerts
         if (pendingscUserAlerts)
         {
@@ -2980,10 +2951,16 @@ void MegaClient::exec()
                     (*it)->doio(this, committer);
                 }
             }
+
+            transfercacheflush(&committer, false);
         }
         else
         {
             LOG_debug << "skipping slots doio while blocked";
+
+            // progress made before we were blocked still needs writing out
+            TransferDbCommitter committer(tctable);
+            transfercacheflush(&committer, false);
         }
 
 #ifdef ENABLE_SYNC
@@ -3098,7 +3075,8 @@ void MegaClient::exec()
 
         httpio->updatedownloadspeed();
         httpio->updateuploadspeed();
-    } while (httpio->doio() || execdirectreads() || (!pendingcs && reqs.readyToSend() && btcs.armed()));
+    } while (httpio->doio() || execdirectreads() || (!pendingcs && reqs.readyToSend() && btcs.armed())
+             || (!pendingcsUnordered && reqsUnordered.readyToSend() && btcsUnordered.armed()));
 
 
     if (!fetchingnodes)
@@ -3180,6 +3158,12 @@ int MegaClient::preparewait()
             nds = Waiter::ds;
         }
 
+        if (!faCacheHits.empty())
+        {
+            // cached file attributes are ready to be delivered
+            nds = Waiter::ds;
+        }
+
         nexttransferretry(PUT, &nds);
         nexttransferretry(GET, &nds);
 
@@ -3209,6 +3193,11 @@ int MegaClient::preparewait()
             btcs.update(&nds);
         }
 
+        if (!pendingcsUnordered)
+        {
+            btcsUnordered.update(&nds);
+        }
+
         // retry failed server-client requests
         if (!pendingsc && !pendingscUserAlerts && scsn.ready() && !mBlocked)
         {
@@ -3429,6 +3418,9 @@ int MegaClient::checkevents()
     {
         r |= gfx->checkevents(waiter.get());
     }
+#ifdef USE_MEDIAINFO
+    r |= mediaFileInfo.checkevents(this);
+#endif
     return r;
 }
 
@@ -3463,6 +3455,8 @@ bool MegaClient::abortbackoff(bool includexfers)
                         }
                     }
                 }
+
+                transferlist.backoffsAborted(static_cast<direction_t>(d));
             }
 
             for (handledrn_map::iterator it = hdrns.begin(); it != hdrns.end();)
@@ -3485,6 +3479,11 @@ bool MegaClient::abortbackoff(bool includexfers)
         r = true;
     }
 
+    if (btcsUnordered.arm())
+    {
+        r = true;
+    }
+
     if (btbadhost.arm())
     {
         r = true;
@@ -3953,6 +3952,12 @@ void MegaClient::dispatchTransfers()
                         nexttransfer->chunkmacs.clear();
                     }
 
+                    if (nexttransfer->type == GET && nexttransfer->size)
+                    {
+                        // connections complete out of order, so reserve the file's space up front
+                        ts->fa->fpreallocate(nexttransfer->size);
+                    }
+
                     ts->progressreported = nexttransfer->progresscompleted;
 
                     if (nexttransfer->type == PUT)
@@ -4199,8 +4204,7 @@ void MegaClient::freeq(direction_t d)
         delete transferPtr.second;
     }
     multi_transfers[d].clear();
-    transferlist.transfers[GET].clear();
-    transferlist.transfers[PUT].clear();
+    transferlist.clear();
 }
 
 bool MegaClient::isFetchingNodesPendingCS()
@@ -4208,6 +4212,188 @@ bool MegaClient::isFetchingNodesPendingCS()
     return pendingcs && pendingcs->includesFetchingNodes;
 }
 
+string MegaClient::csurl(const string& idempotenceId, bool v3)
+{
+    string url = httpio->APIURL;
+
+    url.append("cs?id=");
+    url.append(idempotenceId);
+    url.append(getAuthURI());
+    url.append(appkey);
+
+    url.append(v3 ? "&v=3" : "&v=2");
+
+    if (lang.size())
+    {
+        url.append("&");
+        url.append(lang);
+    }
+    if (trackJourneyId())
+    {
+        url.append("&j=");
+        url.append(mJourneyId.getValue());
+    }
+
+    return url;
+}
+
+// the unordered lane has its own connection and backoff, so a slow or
+// locked batch of ordered commands doesn't hold these back (and vice versa).
+// its commands never carry seqtags, so there's no need to coordinate with
+// actionpacket processing: results are delivered as soon as they arrive.
+void MegaClient::execunorderedcs()
+{
+    if (pendingcsUnordered)
+    {
+        switch (static_cast<reqstatus_t>(pendingcsUnordered->status))
+        {
+            case REQ_SUCCESS:
+                if (pendingcsUnordered->in != "-3" && pendingcsUnordered->in != "-4")
+                {
+                    string in = std::move(pendingcsUnordered->in);
+
+                    delete pendingcsUnordered;
+                    pendingcsUnordered = nullptr;
+                    btcsUnordered.reset();
+
+                    if (*in.c_str() == '[')
+                    {
+                        reqsUnordered.serverresponse(std::move(in), this);
+                    }
+                    else
+                    {
+                        // request failed as a whole
+                        string requestError;
+                        processRequestError(in, requestError);
+                        reqsUnordered.servererror(requestError, this);
+                    }
+                    break;
+                }
+
+            // fall through
+            case REQ_FAILURE:
+            {
+                if (pendingcsUnordered->sslcheckfailed)
+                {
+                    reportSslCheckFailure(*pendingcsUnordered);
+
+                    if (!retryessl)
+                    {
+                        delete pendingcsUnordered;
+                        pendingcsUnordered = nullptr;
+                        btcsUnordered.reset();
+
+                        reqsUnordered.servererror(std::to_string(API_ESSL), this);
+                        break;
+                    }
+                }
+
+                retryreason_t reason = RETRY_UNKNOWN;
+
+                if (pendingcsUnordered->in == "-3")
+                {
+                    reason = RETRY_API_LOCK;
+                }
+                else if (pendingcsUnordered->in == "-4")
+                {
+                    reason = RETRY_RATE_LIMIT;
+                }
+                else if (pendingcsUnordered->httpstatus == 500)
+                {
+                    reason = RETRY_SERVERS_BUSY;
+                }
+                else if (!pendingcsUnordered->httpstatus)
+                {
+                    reason = RETRY_CONNECTIVITY;
+                }
+
+                delete pendingcsUnordered;
+                pendingcsUnordered = nullptr;
+
+                // resent unchanged (for idempotence) once the backoff expires
+                btcsUnordered.backoff();
+                LOG_warn << "Retrying unordered cs request in " << btcsUnordered.retryin() << " ds";
+                reqsUnordered.inflightFailure(reason);
+                break;
+            }
+
+            default:
+                return;
+        }
+    }
+
+    if (!btcsUnordered.armed())
+    {
+        return;
+    }
+
+    if (!reqsUnordered.readyToSend())
+    {
+        btcsUnordered.reset();
+        return;
+    }
+
+    pendingcsUnordered = new HttpReq();
+    pendingcsUnordered->protect = true;
+    pendingcsUnordered->logname = clientname + "csu ";
+
+    bool fetchingNodes;
+    bool v3;
+    string idempotenceId;
+    *pendingcsUnordered->out = reqsUnordered.serverrequest(fetchingNodes, v3, this, idempotenceId);
+    assert(!fetchingNodes);
+
+    pendingcsUnordered->posturl = csurl(idempotenceId, v3);
+    pendingcsUnordered->type = REQ_JSON;
+    pendingcsUnordered->post(this);
+}
+
+error MegaClient::processRequestError(const string& in, string& requestError)
+{
+    JSON json;
+    json.pos = in.c_str();
+    error e;
+    bool valid = json.storeobject(&requestError);
+    if (valid)
+    {
+        if (strncmp(requestError.c_str(), "{\"err\":", 7) == 0)
+        {
+            e = (error)atoi(requestError.c_str() + 7);
+        }
+        else
+        {
+            e = (error)atoi(requestError.c_str());
+        }
+    }
+    else
+    {
+        e = API_EINTERNAL;
+        requestError = std::to_string(e);
+    }
+
+    if (!e)
+    {
+        e = API_EINTERNAL;
+        requestError = std::to_string(e);
+    }
+
+    if (e == API_EBLOCKED && sid.size())
+    {
+        block();
+    }
+
+    app->request_error(e);
+    return e;
+}
+
+void MegaClient::reportSslCheckFailure(const HttpReq& req)
+{
+    sendevent(99453, "Invalid public key");
+    sslfakeissuer = req.sslfakeissuer;
+    app->request_error(API_ESSL);
+    sslfakeissuer.clear();
+}
+
 // determine next scheduled transfer retry
 void MegaClient::nexttransferretry(direction_t d, dstime* dsmin)
 {
@@ -4226,6 +4412,11 @@ void MegaClient::disconnect()
         pendingcs->disconnect();
     }
 
+    if (pendingcsUnordered)
+    {
+        pendingcsUnordered->disconnect();
+    }
+
     if (pendingsc)
     {
         pendingsc->disconnect();
@@ -4440,6 +4631,7 @@ void MegaClient::locallogout(bool removecaches, bool keepSyncsConfigFile)
 #endif
     mSets.clear();
     mSetElements.clear();
+    mSetElementsByNode.clear();
     stopSetPreview();
 
 #ifdef ENABLE_CHAT
@@ -4456,6 +4648,12 @@ void MegaClient::locallogout(bool removecaches, bool keepSyncsConfigFile)
 
     disconnect();
 
+    // write out any transfers we have been holding back
+    {
+        TransferDbCommitter committer(tctable);
+        transfercacheflush(&committer, true);
+    }
+
     // commit and close the transfer cache database.
     if (tctable && tctable->getTransactionCommitter())
     {
@@ -4482,9 +4680,13 @@ void MegaClient::locallogout(bool removecaches, bool keepSyncsConfigFile)
     mNodeManager.reset();
 
     reqs.clear();
+    reqsUnordered.clear();
 
     delete pendingcs;
     pendingcs = NULL;
+
+    delete pendingcsUnordered;
+    pendingcsUnordered = nullptr;
     scsn.clear();
     mBlocked = false;
     mBlockedSet = false;
@@ -4501,6 +4703,8 @@ void MegaClient::locallogout(bool removecaches, bool keepSyncsConfigFile)
 
     queuedfa.clear();
     activefa.clear();
+    drUrlCache.clear();
+    faCacheHits.clear();
     pendinghttp.clear();
     bttimers.clear();
     xferpaused[PUT] = false;
@@ -4873,6 +5077,7 @@ bool MegaClient::procsc()
                         sendevent(99426, report.c_str(), 0);    // Treeproc performance log
 
                         // NULL vector: "notify all elements"
+                        invalidateRecentActions();
                         app->nodes_updated(NULL, int(numNodes));
                         app->users_updated(NULL, int(users.size()));
                         app->pcrs_updated(NULL, int(pcrindex.size()));
@@ -5607,6 +5812,15 @@ error MegaClient::getfa(handle h, string *fileattrstring, const string &nodekey,
         // cancel pending request
         fafc_map::iterator cit;
 
+        for (auto it = faCacheHits.begin(); it != faCacheHits.end(); ++it)
+        {
+            if (it->nodehandle == h && it->type == t)
+            {
+                faCacheHits.erase(it);
+                return API_OK;
+            }
+        }
+
         if ((cit = fafcs.find(c)) != fafcs.end())
         {
             faf_map::iterator it;
@@ -5633,6 +5847,14 @@ error MegaClient::getfa(handle h, string *fileattrstring, const string &nodekey,
     }
     else
     {
+        string data;
+
+        if (faCache.get(fah, t, data))
+        {
+            faCacheHits.push_back({h, t, reqtag, std::move(data)});
+            return API_OK;
+        }
+
         // add file attribute cluster channel and set cluster reference node handle
         FileAttributeFetchChannel** fafcp = &fafcs[c];
 
@@ -11147,7 +11369,8 @@ void MegaClient::opensctable()
             // recycle it (hence the flag DB_OPEN_FLAG_RECYCLE)
             // Similarly, for SRW, we just need to rename the existing legacy DB, and only delete the DB if there is a downgrade (SRW to NO SRW),
             // hence why we need to increase the DB version, but without affecting the upgrade from NO SRW to SRW.
-            int recycleDBVersion = (DbAccess::LEGACY_DB_VERSION == DbAccess::LAST_DB_VERSION_WITHOUT_NOD || DbAccess::LEGACY_DB_VERSION == DbAccess::LAST_DB_VERSION_WITHOUT_SRW) ?
+            // Databases predating node record headers or compression are also recycled, as their records are still read.
+            int recycleDBVersion = DbAccess::legacyDbRecyclable() ?
                                             DB_OPEN_FLAG_RECYCLE :
                                             0;
             sctable.reset(dbaccess->openTableWithNodes(rng, *fsaccess, dbname, recycleDBVersion, [this](DBError error)
@@ -12555,16 +12778,66 @@ void MegaClient::senddevcommand(const char* command,
 
 void MegaClient::transfercacheadd(Transfer *transfer, TransferDbCommitter* committer)
 {
+    // the record is up to date now
+    dirtytransfers.erase(transfer);
+
     if (tctable && !transfer->skipserialization)
     {
         if (committer) committer->addTransferCount += 1;
         tctable->checkCommitter(committer);
         tctable->put(MegaClient::CACHEDTRANSFER, transfer, &tckey);
+        ++performanceStats.transferCacheWrites;
+    }
+}
+
+void MegaClient::transfercachedirty(Transfer* transfer)
+{
+    if (!tctable || transfer->skipserialization)
+    {
+        return;
+    }
+
+    // never written yet: do it now, so the transfer can be resumed
+    if (!transfer->dbid)
+    {
+        transfercacheadd(transfer, nullptr);
+        return;
+    }
+
+    if (!dirtytransfers.insert(transfer).second)
+    {
+        ++performanceStats.transferCacheCoalesced;
+    }
+}
+
+void MegaClient::transfercacheflush(TransferDbCommitter* committer, bool force)
+{
+    if (dirtytransfers.empty())
+    {
+        transfercacheflushed = Waiter::ds;
+        return;
     }
+
+    if (!force
+        && dirtytransfers.size() < TRANSFERCACHE_MAX_DIRTY
+        && Waiter::ds - transfercacheflushed < TRANSFERCACHE_FLUSH_DS)
+    {
+        return;
+    }
+
+    // transfercacheadd() removes them from the set
+    while (!dirtytransfers.empty())
+    {
+        transfercacheadd(*dirtytransfers.begin(), committer);
+    }
+
+    transfercacheflushed = Waiter::ds;
 }
 
 void MegaClient::transfercachedel(Transfer *transfer, TransferDbCommitter* committer)
 {
+    dirtytransfers.erase(transfer);
+
     if (tctable && transfer->dbid)
     {
         if (committer) committer->removeTransferCount += 1;
@@ -14038,15 +14311,33 @@ bool MegaClient::fetchsc(DbTable* sctable)
 
     sctable->rewind();
 
-    bool hasNext = sctable->next(&id, &data, &key);
+    // read every record first, so they can be decrypted in parallel
+    vector<pair<uint32_t, string>> records;
+
+    bool hasNext = sctable->nextEncrypted(&id, &data);
     WAIT_CLASS::bumpds();
     fnstats.timeToFirstByte = Waiter::ds - fnstats.startTime;
 
+    while (hasNext)
+    {
+        records.emplace_back(id, std::move(data));
+        hasNext = sctable->nextEncrypted(&id, &data);
+    }
+
+    vector<char> decrypted;
+    decryptscrecords(records, decrypted);
+
     bool isDbUpgraded = false;      // true when legacy DB is migrated to NOD's DB schema
 
     std::map<NodeHandle, std::vector<std::shared_ptr<Node> >> delayedParents;
-    while (hasNext)
+
+    // unserialization updates the client's state, so it stays on this thread and in table order.
+    // as before, loading stops at the first record that can't be decrypted
+    for (size_t i = 0; i < records.size() && decrypted[i]; ++i)
     {
+        id = records[i].first;
+        data = std::move(records[i].second);
+
         switch (id & (DbTable::IDSPACING - 1))
         {
             case CACHEDSCSN:
@@ -14160,7 +14451,6 @@ bool MegaClient::fetchsc(DbTable* sctable)
                 break;
             }
         }
-        hasNext = sctable->next(&id, &data, &key);
     }
 
     LOG_debug << "Max dbId after resume session: " << id;
@@ -14219,6 +14509,60 @@ bool MegaClient::fetchsc(DbTable* sctable)
 }
 
 
+void MegaClient::decryptscrecords(vector<pair<uint32_t, string>>& records, vector<char>& decrypted)
+{
+    // Smaller batches aren't worth handing to other threads.
+    constexpr size_t MIN_BATCH_SIZE = 64;
+
+    decrypted.assign(records.size(), 0);
+
+    auto decrypt = [&records, &decrypted](size_t begin, size_t end, SymmCipher& cipher) {
+        for (; begin < end; ++begin)
+        {
+            decrypted[begin] = DbTable::decrypt(records[begin].first, &records[begin].second, &cipher);
+        }
+    };
+
+    auto numBatches = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                       records.size() / MIN_BATCH_SIZE);
+
+    if (numBatches < 2)
+    {
+        return decrypt(0, records.size(), key);
+    }
+
+    auto batchSize = (records.size() + numBatches - 1) / numBatches;
+
+    std::condition_variable completed;
+    std::mutex lock;
+    size_t pending = numBatches - 1;
+
+    // Hand all but the first batch to the client's worker threads.
+    for (size_t i = 1; i < numBatches; ++i)
+    {
+        auto begin = i * batchSize;
+        auto end = std::min(begin + batchSize, records.size());
+
+        mAsyncQueue.push([&, begin, end](SymmCipher& cipher) {
+            cipher.setkey(key.key);
+            decrypt(begin, end, cipher);
+
+            std::lock_guard<std::mutex> guard(lock);
+
+            if (!--pending)
+            {
+                completed.notify_one();
+            }
+        }, false);
+    }
+
+    decrypt(0, batchSize, key);
+
+    std::unique_lock<std::mutex> guard(lock);
+
+    completed.wait(guard, [&pending]() { return !pending; });
+}
+
 bool MegaClient::fetchStatusTable(DbTable* table)
 {
     uint32_t id;
@@ -14299,6 +14643,7 @@ void MegaClient::purgeOrphanTransfers(bool remove)
 
 void MegaClient::closetc(bool remove)
 {
+    dirtytransfers.clear();
     pendingtcids.clear();
     cachedfiles.clear();
     cachedfilesdbids.clear();
@@ -15671,6 +16016,7 @@ void MegaClient::purgenodesusersabortsc(bool keepOwnUser)
         delete hdrns.begin()->second;
     }
 
+    invalidateRecentActions();
     mNodeManager.cleanNodes();
 
 #ifdef ENABLE_SYNC
@@ -17350,24 +17696,6 @@ static bool nodes_ctime_greater_shared_ptr(std::shared_ptr<Node> a, std::shared_
 
 namespace action_bucket_compare
 {
-    static bool compare(const Node* a, const Node* b, MegaClient* mc)
-    {
-        if (a->owner != b->owner) return a->owner > b->owner;
-        if (a->parent != b->parent) return a->parent > b->parent;
-
-        // added/updated - distinguish by versioning
-        size_t aChildrenCount = mc->getNumberOfChildren(a->nodeHandle());
-        size_t bChildrenCount = mc->getNumberOfChildren(b->nodeHandle());
-        if (aChildrenCount != bChildrenCount) return aChildrenCount > bChildrenCount;
-
-        // media/nonmedia
-        bool a_media = mc->nodeIsMedia(a, nullptr, nullptr);
-        bool b_media = mc->nodeIsMedia(b, nullptr, nullptr);
-        if (a_media != b_media) return a_media && !b_media;
-
-        return false;
-    }
-
     static bool comparetime(const recentaction& a, const recentaction& b)
     {
         return a.time > b.time;
@@ -17501,11 +17829,184 @@ bool MegaClient::treatAsIfFileDataEqual(const FileFingerprint& fp1, const string
             isPhotoVideoAudioByName(filenameExtensionLowercaseNoDot1);
 }
 
+MegaClient::RecentNode MegaClient::makeRecentNode(const Node& n)
+{
+    // the bucketing keys are computed once per node, rather than on every comparison
+    RecentNode rn;
+    rn.handle = n.nodeHandle();
+    rn.ctime = n.ctime;
+    rn.owner = n.owner;
+    rn.parent = n.parent ? n.parent->nodeHandle() : NodeHandle();
+    rn.versions = getNumberOfChildren(n.nodeHandle());   // children of files represent previous versions
+    rn.media = nodeIsMedia(&n, nullptr, nullptr);
+    return rn;
+}
+
+bool MegaClient::isRecentActionsCandidate(const Node& n) const
+{
+    // same conditions as the database query behind NodeManager::getRecentNodes()
+    return n.type == FILENODE
+        && !(n.parent && n.parent->type == FILENODE)
+        && !n.isAncestor(mNodeManager.getRootNodeRubbish());
+}
+
+void MegaClient::loadRecentActions(unsigned maxcount, m_time_t since)
+{
+    invalidateRecentActions();
+
+    // load some spare nodes, so removals don't force a reload straight away
+    mRecentNodesLimit = maxcount ? maxcount + maxcount / 4 + 16 : 0;
+    sharedNode_vector v = mNodeManager.getRecentNodes(static_cast<unsigned>(mRecentNodesLimit), since);
+
+    for (auto& n : v)
+    {
+        m_time_t ctime = n->ctime;
+        NodeHandle h = n->nodeHandle();
+        if (mRecentNodesTime.emplace(h, ctime).second)
+        {
+            mRecentNodes.emplace(std::make_pair(ctime, h), makeRecentNode(*n));
+        }
+    }
+
+    mRecentNodesMaxCount = maxcount;
+    mRecentNodesSince = since;
+    mRecentNodesComplete = !mRecentNodesLimit || v.size() < mRecentNodesLimit;
+    mRecentNodesValid = true;
+
+    LOG_debug << "Recent actions loaded " << mRecentNodes.size() << " nodes"
+              << (mRecentNodesComplete ? "" : " (limit reached)");
+}
+
+void MegaClient::invalidateRecentActions()
+{
+    mRecentNodes.clear();
+    mRecentNodesTime.clear();
+    mRecentNodesValid = false;
+    mRecentNodesComplete = false;
+}
+
+void MegaClient::updateRecentActions(const sharedNode_vector& nodes)
+{
+    if (!mRecentNodesValid)
+    {
+        return;
+    }
+
+    if (fetchingnodes)
+    {
+        invalidateRecentActions();
+        return;
+    }
+
+    auto erase = [this](NodeHandle h)
+    {
+        auto it = mRecentNodesTime.find(h);
+        if (it == mRecentNodesTime.end()) return false;
+        mRecentNodes.erase(std::make_pair(it->second, h));
+        mRecentNodesTime.erase(it);
+        return true;
+    };
+
+    auto insert = [this](const std::shared_ptr<Node>& n)
+    {
+        if (n->ctime < mRecentNodesSince || !isRecentActionsCandidate(*n))
+        {
+            return;
+        }
+
+        // past the oldest node we hold there may be others we never loaded
+        if (!mRecentNodesComplete
+            && (mRecentNodes.empty() || n->ctime < mRecentNodes.rbegin()->first.first))
+        {
+            return;
+        }
+
+        NodeHandle h = n->nodeHandle();
+        mRecentNodesTime[h] = n->ctime;
+        mRecentNodes[std::make_pair(n->ctime, h)] = makeRecentNode(*n);
+
+        if (mRecentNodesLimit && mRecentNodes.size() > mRecentNodesLimit)
+        {
+            auto oldest = std::prev(mRecentNodes.end());
+            mRecentNodesTime.erase(oldest->first.second);
+            mRecentNodes.erase(oldest);
+            mRecentNodesComplete = false;
+        }
+    };
+
+    for (auto& n : nodes)
+    {
+        if (n->type != FILENODE)
+        {
+            // moving or removing a folder changes the eligibility of everything below it
+            if (n->changed.removed || n->changed.parent)
+            {
+                invalidateRecentActions();
+                return;
+            }
+            continue;
+        }
+
+        // a version was removed: the count of versions of the current file changes
+        if ((n->changed.removed || n->changed.parent)
+            && n->parent && n->parent->type == FILENODE
+            && erase(n->parent->nodeHandle()))
+        {
+            insert(n->parent);
+        }
+
+        erase(n->nodeHandle());
+        if (!n->changed.removed)
+        {
+            insert(n);
+        }
+    }
+}
+
 recentactions_vector MegaClient::getRecentActions(unsigned maxcount, m_time_t since)
 {
-    recentactions_vector rav;
-    sharedNode_vector v = mNodeManager.getRecentNodes(maxcount, since);
+    if (!mRecentNodesValid
+        || maxcount != mRecentNodesMaxCount
+        || since < mRecentNodesSince
+        || (!mRecentNodesComplete && mRecentNodes.size() < maxcount))
+    {
+        loadRecentActions(maxcount, since);
+    }
+
+    // most recent first, as the database query returns them
+    vector<const RecentNode*> v;
+    for (auto& entry : mRecentNodes)
+    {
+        if (entry.first.first < since || (maxcount && v.size() >= maxcount)) break;
+        v.push_back(&entry.second);
+    }
 
+    // only the nodes being returned are resolved
+    map<NodeHandle, std::shared_ptr<Node>> nodes;
+    for (auto i = v.begin(); i != v.end(); )
+    {
+        if (auto n = nodeByHandle((*i)->handle))
+        {
+            nodes.emplace((*i)->handle, std::move(n));
+            ++i;
+        }
+        else
+        {
+            i = v.erase(i);
+        }
+    }
+
+    // by owner, parent folder, added/updated and ismedia
+    auto compare = [](const RecentNode* a, const RecentNode* b)
+    {
+        if (a->owner != b->owner) return a->owner > b->owner;
+        if (a->parent != b->parent) return b->parent < a->parent;
+        if (a->versions != b->versions) return a->versions > b->versions;
+        if (a->media != b->media) return a->media && !b->media;
+        return false;
+    };
+
+    recentactions_vector rav;
     for (auto i = v.begin(); i != v.end(); )
     {
         // find the oldest node, maximum 6h
@@ -17516,24 +18017,24 @@ recentactions_vector MegaClient::getRecentActions(unsigned maxcount, m_time_t si
         }
 
         // sort the defined bucket by owner, parent folder, added/updated and ismedia
-        std::sort(i, bucketend, [this](const std::shared_ptr<Node>& n1, const std::shared_ptr<Node>& n2) { return action_bucket_compare::compare(n1.get(), n2.get(), this); });
+        std::sort(i, bucketend, compare);
 
         // split the 6h-bucket in different buckets according to their content
         for (auto j = i; j != bucketend; ++j)
         {
-            if (i == j || action_bucket_compare::compare(i->get(), j->get(), this))
+            if (i == j || compare(*i, *j))
             {
                 // add a new bucket
                 recentaction ra;
                 ra.time = (*j)->ctime;
                 ra.user = (*j)->owner;
-                ra.parent = (*j)->parent ? (*j)->parent->nodehandle : UNDEF;
-                ra.updated = getNumberOfChildren((*j)->nodeHandle());   // children of files represent previous versions
-                ra.media = nodeIsMedia(j->get(), nullptr, nullptr);
+                ra.parent = (*j)->parent.as8byte();
+                ra.updated = (*j)->versions > 0;
+                ra.media = (*j)->media;
                 rav.push_back(ra);
             }
             // add the node to the bucket
-            rav.back().nodes.push_back(*j);
+            rav.back().nodes.push_back(nodes[(*j)->handle]);
             i = j;
         }
         i = bucketend;
@@ -18478,6 +18979,8 @@ extern CodeCounter::ScopeStats computeSyncSequencesStats;
 
 std::string MegaClient::PerformanceStats::report(bool reset, HttpIO* httpio, Waiter* waiter, const RequestDispatcher& reqs)
 {
+    auto activeMs = std::chrono::duration_cast<std::chrono::milliseconds>(transfersActiveTime.sum).count();
+
     std::ostringstream s;
     s << prepareWait.report(reset) << "\n"
         << doWait.report(reset) << "\n"
@@ -18516,6 +19019,14 @@ std::string MegaClient::PerformanceStats::report(bool reset, HttpIO* httpio, Wai
         << " transfers active time: " << transfersActiveTime.report(reset) << "\n"
         << " transfer starts/finishes: " << transferStarts << " " << transferFinishes << "\n"
         << " transfer temperror/fails: " << transferTempErrors << " " << transferFails << "\n"
+        << " download writes/bytes: " << downloadWrites << " " << downloadWriteBytes
+        << " avg write size: " << (downloadWrites ? downloadWriteBytes / downloadWrites : 0)
+        << " write iops: " << (activeMs ? downloadWrites * 1000 / static_cast<uint64_t>(activeMs) : 0) << "\n"
+        << " transfer cache writes/coalesced: " << transferCacheWrites << " " << transferCacheCoalesced
+        << " writes/s: " << (activeMs ? transferCacheWrites * 1000 / static_cast<uint64_t>(activeMs) : 0)
+        << " without coalescing: " << (activeMs ? (transferCacheWrites + transferCacheCoalesced) * 1000 / static_cast<uint64_t>(activeMs) : 0) << "\n"
+        << " direct read url cache hits/misses: " << directReadUrlCacheHits << " " << directReadUrlCacheMisses
+        << " avg time to first byte: " << (directReadFirstBytes ? directReadFirstByteMs / directReadFirstBytes : 0) << " ms\n"
         << " nowait reason: immedate: " << prepwaitImmediate << " zero: " << prepwaitZero << " httpio: " << prepwaitHttpio << " fsaccess: " << prepwaitFsaccess << " nonzero waits: " << nonzeroWait << "\n";
     if (auto curlhttpio = dynamic_cast<CurlHttpIO*>(httpio))
     {
@@ -18538,6 +19049,10 @@ std::string MegaClient::PerformanceStats::report(bool reset, HttpIO* httpio, Wai
     if (reset)
     {
         transferStarts = transferFinishes = transferTempErrors = transferFails = 0;
+        downloadWrites = downloadWriteBytes = 0;
+        transferCacheWrites = transferCacheCoalesced = 0;
+        directReadUrlCacheHits = directReadUrlCacheMisses = 0;
+        directReadFirstByteMs = directReadFirstBytes = 0;
         prepwaitImmediate = prepwaitZero = prepwaitHttpio = prepwaitFsaccess = nonzeroWait = 0;
     }
     return s.str();
@@ -18882,6 +19397,7 @@ bool MegaClient::procaesp(JSON& j)
             // save new data
             mSets.swap(newSets);
             mSetElements.swap(newElements);
+            rebuildSetElementIndex();
         }
 
         ok &= j.leaveobject();
@@ -19617,6 +20133,70 @@ const elementsmap_t* MegaClient::getSetElements(handle sid) const
     return itS == mSetElements.end() ? nullptr : &itS->second;
 }
 
+vector<const SetElement*> MegaClient::getSetElementsByNode(handle nh) const
+{
+    vector<const SetElement*> elements;
+
+    auto range = mSetElementsByNode.equal_range(nh);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        elements.push_back(it->second);
+    }
+
+    return elements;
+}
+
+void MegaClient::indexSetElement(SetElement& el)
+{
+    mSetElementsByNode.emplace(el.node(), &el);
+}
+
+void MegaClient::unindexSetElement(const SetElement& el)
+{
+    auto range = mSetElementsByNode.equal_range(el.node());
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == &el)
+        {
+            mSetElementsByNode.erase(it);
+            return;
+        }
+    }
+
+    assert(false); // every Element in memory should be indexed
+}
+
+void MegaClient::rebuildSetElementIndex()
+{
+    mSetElementsByNode.clear();
+
+    for (auto& s : mSetElements)
+    {
+        for (auto& e : s.second)
+        {
+            indexSetElement(e.second);
+        }
+    }
+}
+
+void MegaClient::eraseSetElements(handle sid)
+{
+    auto its = mSetElements.find(sid);
+    if (its == mSetElements.end())
+    {
+        return;
+    }
+
+    clearsetelementnotify(sid);
+
+    for (auto& e : its->second)
+    {
+        unindexSetElement(e.second);
+    }
+
+    mSetElements.erase(its);
+}
+
 bool MegaClient::deleteSetElement(handle sid, handle eid)
 {
     auto its = mSetElements.find(sid);
@@ -19661,6 +20241,7 @@ const SetElement* MegaClient::addOrUpdateSetElement(SetElement&& el)
 
     SetElement& added = add.first->second;
     added.setChanged(SetElement::CH_EL_NEW);
+    indexSetElement(added);
     notifysetelement(&added);
 
     return &added;
@@ -20131,6 +20712,10 @@ bool MegaClient::fetchscsetelement(string* data, uint32_t id)
     SetElement& addedEl = ite.first->second;
     addedEl.resetChanges();
     addedEl.dbid = id;
+    if (ite.second)
+    {
+        indexSetElement(addedEl);
+    }
 
     return true;
 }
@@ -20170,8 +20755,7 @@ bool MegaClient::updatescsets()
                         return false;
                     }
                 }
-                clearsetelementnotify(s->id());
-                mSetElements.erase(s->id());
+                eraseSetElements(s->id());
             }
 
             if (!sctable->del(s->dbid))
@@ -20251,8 +20835,7 @@ void MegaClient::notifypurgesets()
     {
         if (s->hasChanged(Set::CH_REMOVED))
         {
-            clearsetelementnotify(s->id());
-            mSetElements.erase(s->id());
+            eraseSetElements(s->id());
             mSets.erase(s->id());
         }
         else
@@ -20276,6 +20859,7 @@ void MegaClient::notifypurgesetelements()
     {
         if (e->hasChanged(SetElement::CH_EL_REMOVED))
         {
+            unindexSetElement(*e);
             mSetElements[e->set()].erase(e->id());
         }
         else
@@ -20290,13 +20874,9 @@ void MegaClient::notifypurgesetelements()
 
 void MegaClient::clearsetelementnotify(handle sid)
 {
-    for (size_t i = setelementnotify.size(); i; --i)
-    {
-        if (setelementnotify[i - 1]->set() == sid)
-        {
-            setelementnotify.erase(setelementnotify.begin() + i - 1);
-        }
-    }
+    // a single pass, as removing a large Set would otherwise shuffle the vector once per Element
+    auto newEnd = std::remove_if(setelementnotify.begin(), setelementnotify.end(), [sid](const SetElement* e) { return e->set() == sid; });
+    setelementnotify.erase(newEnd, setelementnotify.end());
 }
 
 void MegaClient::setProFlexi(bool newProFlexi)
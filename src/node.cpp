@@ -82,7 +82,7 @@ Node::Node(MegaClient& cclient, NodeHandle h, NodeHandle ph,
 
 Node::~Node()
 {
-    if (keyApplied())
+    if (keyApplied() && !mIsSnapshot)
     {
         client->mAppliedKeyNodeCount--;
         assert(client->mAppliedKeyNodeCount >= 0);
@@ -95,10 +95,12 @@ Node::~Node()
         // the logout.
     }
 
-    // abort pending direct reads
-    client->preadabort(this);
-
-    client->mNodeManager.decreaseNumNodesInRam();
+    // snapshots never had direct reads and aren't counted as nodes in RAM
+    if (!mIsSnapshot)
+    {
+        client->preadabort(this);
+        client->mNodeManager.decreaseNumNodesInRam();
+    }
 }
 int Node::getShareType() const
 {
@@ -556,6 +558,13 @@ void Node::setkey(const byte* newkey)
 // set the node key (encrypted or decrypted)
 void Node::setKey(const string& key)
 {
+    // snapshots aren't part of the tree, so they don't count as nodes with keys applied
+    if (mIsSnapshot)
+    {
+        nodekeydata = key;
+        return;
+    }
+
     if (keyApplied()) --client->mAppliedKeyNodeCount;
     nodekeydata = key;
     if (keyApplied()) ++client->mAppliedKeyNodeCount;
@@ -565,7 +574,12 @@ void Node::setKey(const string& key)
 std::shared_ptr<Node> Node::unserialize(MegaClient& client, const std::string* d, bool fromOldCache, std::list<std::unique_ptr<NewShare>>& ownNewshares)
 {
     NodeData nd(d->data(), d->size(), NodeData::COMPONENT_ALL);
-    return nd.createNode(client, fromOldCache, ownNewshares);
+    return unserialize(client, nd, fromOldCache, ownNewshares);
+}
+
+std::shared_ptr<Node> Node::unserialize(MegaClient& client, NodeData& nodeData, bool fromOldCache, std::list<std::unique_ptr<NewShare>>& ownNewshares)
+{
+    return nodeData.createNode(client, fromOldCache, ownNewshares);
 }
 
 // serialize node - nodes with pending or RSA keys are unsupported
@@ -598,6 +612,20 @@ bool Node::serialize(string* d) const
     short numshares;
     m_off_t s;
 
+    // Reserve space for the record's header.
+    auto headerPosition = d->size();
+    d->append(NodeData::RECORD_HEADER_SIZE, '\0');
+
+    // Where does the record's body begin?
+    auto bodyPosition = d->size();
+
+    // Where can each field be found in the record's body?
+    uint32_t offsets[NodeData::NUM_RECORD_FIELDS];
+
+    auto mark = [&](NodeData::RecordField field) {
+        offsets[field] = static_cast<uint32_t>(d->size() - bodyPosition);
+    };
+
     s = type ? -type : size;
 
     d->append((char*)&s, sizeof s);
@@ -622,6 +650,8 @@ bool Node::serialize(string* d) const
     ts = (time_t)ctime;
     d->append((char*)&ts, sizeof(ts));
 
+    mark(NodeData::FIELD_KEY);
+
     if (attrstring)
     {
         auto length = 0u;
@@ -693,6 +723,8 @@ bool Node::serialize(string* d) const
         }
     }
 
+    mark(NodeData::FIELD_SHARES);
+
     d->append((char*)&numshares, sizeof numshares);
 
     if (numshares)
@@ -729,8 +761,12 @@ bool Node::serialize(string* d) const
         }
     }
 
+    mark(NodeData::FIELD_ATTRS);
+
     attrs.serialize(d);
 
+    mark(NodeData::FIELD_LINK);
+
     if (isExported)
     {
         d->append((char*) &plink->ph, MegaClient::NODEHANDLE);
@@ -742,6 +778,8 @@ bool Node::serialize(string* d) const
         }
     }
 
+    mark(NodeData::FIELD_ENCRYPTED);
+
     // Write data necessary to thaw encrypted nodes.
     if (attrstring)
     {
@@ -756,6 +794,9 @@ bool Node::serialize(string* d) const
         d->append(*attrstring, 0, length);
     }
 
+    // Now that we know where each field is, fill in the header.
+    NodeData::writeRecordHeader(*d, headerPosition, offsets);
+
     return true;
 }
 
@@ -981,25 +1022,35 @@ void Node::setfingerprint()
     {
         client->mNodeManager.removeFingerprint(this);
 
-        attr_map::iterator it = attrs.map.find('c');
+        parsefingerprint();
 
-        if (it != attrs.map.end())
-        {
-            if (!unserializefingerprint(&it->second))
-            {
-                LOG_warn << "Invalid fingerprint";
-            }
-        }
+        mFingerPrintPosition = client->mNodeManager.insertFingerprint(this);
+    }
+}
+
+void Node::parsefingerprint()
+{
+    if (type != FILENODE || nodekeydata.size() < sizeof crc)
+    {
+        return;
+    }
+
+    attr_map::iterator it = attrs.map.find('c');
 
-        // if we lack a valid FileFingerprint for this file, use file's key,
-        // size and client timestamp instead
-        if (!isvalid)
+    if (it != attrs.map.end())
+    {
+        if (!unserializefingerprint(&it->second))
         {
-            memcpy(crc.data(), nodekeydata.data(), sizeof crc);
-            mtime = ctime;
+            LOG_warn << "Invalid fingerprint";
         }
+    }
 
-        mFingerPrintPosition = client->mNodeManager.insertFingerprint(this);
+    // if we lack a valid FileFingerprint for this file, use file's key,
+    // size and client timestamp instead
+    if (!isvalid)
+    {
+        memcpy(crc.data(), nodekeydata.data(), sizeof crc);
+        mtime = ctime;
     }
 }
 
@@ -1362,6 +1413,7 @@ bool Node::setparent(std::shared_ptr<Node> p, bool updateNodeCounters)
 
     if (updateNodeCounters)
     {
+        assert(!mIsSnapshot);
         std::shared_ptr<Node> node = this->mNodePosition->second.getNodeInRam();
         assert(node);
         client->mNodeManager.updateCounter(node, oldparent);
@@ -1383,6 +1435,9 @@ const Node* Node::firstancestor() const
 
 std::shared_ptr<Node> Node::latestFileVersion() const
 {
+    // snapshots have no position in the node manager
+    assert(!mIsSnapshot);
+
     std::shared_ptr<Node> n = this->mNodePosition->second.getNodeInRam();
     if (type == FILENODE)
     {
@@ -1476,6 +1531,119 @@ bool Node::isPasswordNodeFolder() const
 }
 
 
+NodeData::NodeData(const char* ptr, size_t size, int component)
+  : mStart(ptr)
+  , mEnd(ptr + size)
+  , mComp(component)
+{
+    // Records written by older versions have no header.
+    mIndexed = readHeader();
+}
+
+void NodeData::writeRecordHeader(string& d, size_t position, const uint32_t (&offsets)[NUM_RECORD_FIELDS])
+{
+    assert(position + RECORD_HEADER_SIZE <= d.size());
+
+    char* ptr = &d[position];
+
+    m_off_t marker = RECORD_MARKER + RECORD_VERSION;
+    memcpy(ptr, &marker, sizeof(marker));
+    ptr += sizeof(marker);
+
+    *ptr++ = static_cast<char>(NUM_RECORD_FIELDS);
+
+    memcpy(ptr, offsets, sizeof(offsets));
+}
+
+bool NodeData::readHeader()
+{
+    if (!mStart || mStart + sizeof(m_off_t) + sizeof(uint8_t) > mEnd)
+    {
+        return false;
+    }
+
+    auto marker = MemAccess::get<m_off_t>(mStart);
+
+    // Legacy record.
+    if (marker < RECORD_MARKER || marker > RECORD_MARKER + std::numeric_limits<uint8_t>::max())
+    {
+        return false;
+    }
+
+    const char* ptr = mStart + sizeof(m_off_t);
+
+    // Later versions may describe more fields than we know about.
+    auto numFields = static_cast<uint8_t>(*ptr++);
+
+    if (numFields < NUM_RECORD_FIELDS || ptr + numFields * sizeof(uint32_t) > mEnd)
+    {
+        // Make sure the record's rejected.
+        mEnd = mStart;
+        return false;
+    }
+
+    memcpy(mOffsets, ptr, sizeof(mOffsets));
+    ptr += numFields * sizeof(uint32_t);
+
+    // The body is laid out exactly like a legacy record.
+    mStart = ptr;
+
+    for (auto offset : mOffsets)
+    {
+        if (mStart + offset > mEnd)
+        {
+            mEnd = mStart;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool NodeData::readAttrsIndexed()
+{
+    mReadAttempted = true;
+
+    if (mStart + sizeof(m_off_t) > mEnd)
+    {
+        return false;
+    }
+
+    /// node type
+    mSize = MemAccess::get<m_off_t>(mStart);
+    mType = (mSize < 0 && mSize >= -RUBBISHNODE) ? (nodetype_t)-mSize : FILENODE;
+
+    /// node attributes
+    const char* ptr = mAttrs.unserialize(mStart + mOffsets[FIELD_ATTRS], mEnd);
+
+    mReadSucceeded = ptr && ptr == mStart + mOffsets[FIELD_LINK];
+
+    return mReadSucceeded;
+}
+
+bool NodeData::parse()
+{
+    assert(mComp == COMPONENT_ALL);
+
+    return !readFailed();
+}
+
+bool NodeData::readFailed()
+{
+    if (mReadAttempted)
+    {
+        return !mReadSucceeded;
+    }
+
+    // Only the attributes are needed and we know where they are.
+    if (mIndexed && mComp != COMPONENT_ALL)
+    {
+        return !readAttrsIndexed();
+    }
+
+    return !readComponents();
+}
+
 bool NodeData::readComponents()
 {
     mReadAttempted = true;
@@ -1894,6 +2062,37 @@ std::unique_ptr<Node> NodeData::createNode(MegaClient& client, bool fromOldCache
     return n;
 }
 
+std::unique_ptr<Node> NodeData::createSnapshot(MegaClient& client, const std::string& nodeCounter)
+{
+    assert(mComp == COMPONENT_ALL);
+    if (readFailed() || mIsEncrypted || !mShares.empty())
+    {
+        return nullptr;
+    }
+
+    unique_ptr<Node> n = std::make_unique<Node>(client, NodeHandle().set6byte(mHandle), NodeHandle().set6byte(mParentHandle),
+                                                 mType, mSize, mUserHandle, mFileAttributes.c_str(), mCtime);
+
+    n->mIsSnapshot = true;
+    n->attrs = mAttrs;
+
+    // Node's constructor counted it, but snapshots aren't nodes in RAM
+    client.mNodeManager.decreaseNumNodesInRam();
+
+    if (mIsExported)
+    {
+        n->plink.reset(new PublicLink(mPubLinkHandle, mPubLinkCts, mPubLinkEts, mPubLinkTakenDown, mAuthKey.c_str()));
+    }
+
+    n->setKey(mNodeKey);
+    n->parsefingerprint();
+
+    // folders report their size and content from the counter
+    n->setCounter(NodeCounter(nodeCounter));
+
+    return n;
+}
+
 bool NewNode::hasZeroKey() const
 {
     return Node::hasZeroKey(nodekey);
@@ -1946,7 +2145,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
         {
             // remove existing child linkage for localname
             auto it = parent->children.find(localname);
-            if (it != parent->children.end() && it->second == this)
+            if (it != parent->children.end() && *it == this)
             {
                 parent->children.erase(it);
             }
@@ -1957,7 +2156,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
         {
             // remove existing child linkage for slocalname
             auto it = parent->schildren.find(*slocalname);
-            if (it != parent->schildren.end() && it->second == this)
+            if (it != parent->schildren.end() && *it == this)
             {
                 parent->schildren.erase(it);
             }
@@ -1973,6 +2172,21 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
         recursiveSetAndReportTreestate(TREESTATE_NONE, true, true);
     }
 
+    // our published state is linked by parent and name, so only this node needs relinking
+    bool relinkTreestate = mTreestateId && parent && newparent
+                           && (parentChange || localnameChange || shortnameChange)
+                           && !sync->mDestructorRunning;
+
+    if (relinkTreestate)
+    {
+        sync->threadSafeState->unlinkTreestate(parent->mTreestateId, localname, slocalname.get(), mTreestateId);
+    }
+    else if (parent && !newparent && !sync->mDestructorRunning)
+    {
+        // no longer part of the sync
+        unpublishTreestates();
+    }
+
     if (localnameChange)
     {
         // set new name
@@ -1998,6 +2212,24 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
         }
     }
 
+    if (relinkTreestate)
+    {
+        if (oldsync)
+        {
+            // ids belong to the sync that allocated them, so start afresh in the new one
+            unpublishTreestates();
+        }
+        else
+        {
+            if (!parent->mTreestateId)
+            {
+                parent->linkTreestate();
+            }
+
+            sync->threadSafeState->linkTreestate(parent->mTreestateId, localname, slocalname.get(), mTreestateId);
+        }
+    }
+
     // add to parent map by localname
     if (parent && (parentChange || localnameChange))
     {
@@ -2006,7 +2238,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
             assert(it == parent->children.end());   // check we are not about to orphan the old one at this location... if we do then how did we get a clash in the first place?
         #endif
 
-        parent->children[localname] = this;
+        parent->children.set(this);
     }
 
     // add to parent map by shortname
@@ -2014,7 +2246,7 @@ void LocalNode::setnameparent(LocalNode* newparent, const LocalPath& newlocalpat
     {
         // it's quite possible that the new folder still has an older LocalNode with clashing shortname, that represents a file/folder since moved, but which we don't know about yet.
         // just assign the new one, we forget the old reference.  The other LocalNode will not remove this one since the LocalNode* will not match.
-        parent->schildren[*slocalname] = this;
+        parent->schildren.set(this);
     }
 
     // reset treestate
@@ -2049,7 +2281,7 @@ void LocalNode::moveContentTo(LocalNode* ln, LocalPath& fullPath, bool setScanAg
 {
     vector<LocalNode*> workingList;
     workingList.reserve(children.size());
-    for (auto& c : children) workingList.push_back(c.second);
+    for (auto& c : children) workingList.push_back(c);
     for (auto& c : workingList)
     {
         ScopedLengthRestore restoreLen(fullPath);
@@ -2338,8 +2570,8 @@ void LocalNode::initiateScanBlocked(bool folderBlocked, bool containsFingerprint
         // Mark all immediate children as requiring refingerprinting.
         for (auto& childIt : children)
         {
-            if (childIt.second->type == FILENODE)
-                childIt.second->recomputeFingerprint = true;
+            if (childIt->type == FILENODE)
+                childIt->recomputeFingerprint = true;
         }
     }
 
@@ -2456,16 +2688,16 @@ void LocalNode::propagateAnySubtreeFlags()
 {
     for (auto& child : children)
     {
-        if (child.second->type != FILENODE)
+        if (child->type != FILENODE)
         {
             if (scanAgain == TREE_ACTION_SUBTREE)
             {
-                child.second->scanDelayUntil = std::max<dstime>(child.second->scanDelayUntil,  scanDelayUntil);
+                child->scanDelayUntil = std::max<dstime>(child->scanDelayUntil,  scanDelayUntil);
             }
 
-            child.second->scanAgain = propagateSubtreeFlag(scanAgain, child.second->scanAgain);
-            child.second->checkMovesAgain = propagateSubtreeFlag(checkMovesAgain, child.second->checkMovesAgain);
-            child.second->syncAgain = propagateSubtreeFlag(syncAgain, child.second->syncAgain);
+            child->scanAgain = propagateSubtreeFlag(scanAgain, child->scanAgain);
+            child->checkMovesAgain = propagateSubtreeFlag(checkMovesAgain, child->checkMovesAgain);
+            child->syncAgain = propagateSubtreeFlag(syncAgain, child->syncAgain);
         }
     }
     if (scanAgain == TREE_ACTION_SUBTREE) scanAgain = TREE_ACTION_HERE;
@@ -2533,7 +2765,7 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
 
             for (auto& childIt : children)
             {
-                auto& child = *childIt.second;
+                auto& child = *childIt;
 
                 bool useSyncedFP = child.oneTimeUseSyncedFingerprintInScan;
                 child.oneTimeUseSyncedFingerprintInScan = false;
@@ -2557,13 +2789,13 @@ bool LocalNode::processBackgroundFolderScan(SyncRow& row, SyncPath& fullPath)
                 if (child.scannedFingerprint.isvalid)
                 {
                     // as-scanned by this instance is more accurate if available
-                    priorScanChildren.emplace(childIt.first, child.getScannedFSDetails());
+                    priorScanChildren.emplace(childIt->localname, child.getScannedFSDetails());
                 }
                 else if (useSyncedFP && child.fsid_lastSynced != UNDEF && child.syncedFingerprint.isvalid)
                 {
                     // But otherwise, already-synced syncs on startup should not re-fingerprint
                     // files that match the synced fingerprint by fsid/size/mtime (for quick startup)
-                    priorScanChildren.emplace(childIt.first, child.getLastSyncedFSDetails());
+                    priorScanChildren.emplace(childIt->localname, child.getLastSyncedFSDetails());
                 }
             }
 
@@ -2727,7 +2959,9 @@ void LocalNode::reassignUnstableFsidsOnceOnly(const FSNode* fsnode)
 
 void LocalNode::recursiveSetAndReportTreestate(treestate_t ts, bool recurse, bool reportToApp)
 {
-    if (reportToApp && ts != mReportedSyncState)
+    bool changed = ts != mReportedSyncState;
+
+    if (changed && reportToApp)
     {
         assert(sync->syncs.onSyncThread());
         sync->syncs.mClient.app->syncupdate_treestate(sync->getConfig(), getLocalPath(), ts, type);
@@ -2735,11 +2969,17 @@ void LocalNode::recursiveSetAndReportTreestate(treestate_t ts, bool recurse, boo
 
     mReportedSyncState = ts;
 
+    if (changed)
+    {
+        // so overlay icon queries can be answered without waiting for the sync thread
+        publishTreestate();
+    }
+
     if (recurse)
     {
         for (auto& i : children)
         {
-            i.second->recursiveSetAndReportTreestate(ts, recurse, reportToApp);
+            i->recursiveSetAndReportTreestate(ts, recurse, reportToApp);
         }
     }
 }
@@ -2936,10 +3176,11 @@ LocalNode::~LocalNode()
 
 void LocalNode::deleteChildren()
 {
-    for (localnode_map::iterator it = children.begin(); it != children.end(); )
+    // delete from the back, as erasing the last entry of the children vector is cheap
+    while (!children.empty())
     {
         // the destructor removes the child from our `children` map
-        delete it++->second;
+        delete children.back();
     }
     assert(children.empty());
 }
@@ -2979,7 +3220,7 @@ void LocalNode::setSubtreeNeedsRefingerprint()
     {
         if (type != FILENODE)  // no need to set it for file versions
         {
-            child.second->setSubtreeNeedsRefingerprint();
+            child->setSubtreeNeedsRefingerprint();
         }
     }
 }
@@ -2991,6 +3232,78 @@ LocalPath LocalNode::getLocalPath() const
     return lp;
 }
 
+void LocalNode::publishTreestate()
+{
+    // nothing to forget if we were never linked
+    if (!mTreestateId && mReportedSyncState == TREESTATE_NONE)
+    {
+        return;
+    }
+
+    if (!mTreestateId)
+    {
+        linkTreestate();
+    }
+
+    sync->threadSafeState->publishTreestate(mTreestateId, mReportedSyncState);
+}
+
+void LocalNode::linkTreestate()
+{
+    assert(!mTreestateId);
+
+    uint64_t parentId = 0;
+
+    if (parent)
+    {
+        // a folder's state may be reported after its children's
+        if (!parent->mTreestateId)
+        {
+            parent->linkTreestate();
+        }
+
+        parentId = parent->mTreestateId;
+    }
+
+    mTreestateId = sync->threadSafeState->nextTreestateId();
+
+    // the sync root's name is its absolute path, so it's linked with an empty name
+    if (parent)
+    {
+        sync->threadSafeState->linkTreestate(parentId, localname, slocalname.get(), mTreestateId);
+    }
+    else
+    {
+        sync->threadSafeState->linkTreestate(parentId, LocalPath(), nullptr, mTreestateId);
+    }
+
+    if (mReportedSyncState != TREESTATE_NONE)
+    {
+        sync->threadSafeState->publishTreestate(mTreestateId, mReportedSyncState);
+    }
+}
+
+void LocalNode::unpublishTreestates()
+{
+    for (auto* child : children)
+    {
+        child->unpublishTreestates();
+    }
+
+    if (!mTreestateId)
+    {
+        return;
+    }
+
+    if (parent && parent->mTreestateId)
+    {
+        sync->threadSafeState->unlinkTreestate(parent->mTreestateId, localname, slocalname.get(), mTreestateId);
+    }
+
+    sync->threadSafeState->publishTreestate(mTreestateId, TREESTATE_NONE);
+    mTreestateId = 0;
+}
+
 void LocalNode::getlocalpath(LocalPath& path) const
 {
     path.clear();
@@ -3061,23 +3374,37 @@ string LocalNode::debugGetParentList()
 // locate child by localname or slocalname
 LocalNode* LocalNode::childbyname(LocalPath* localname)
 {
-    localnode_map::iterator it;
+    localnode_children::iterator it;
 
     if (!localname || ((it = children.find(*localname)) == children.end() && (it = schildren.find(*localname)) == schildren.end()))
     {
         return NULL;
     }
 
-    return it->second;
+    return *it;
+}
+
+size_t LocalNode::footprint() const
+{
+    size_t bytes = sizeof(*this)
+                 + children.capacity() * sizeof(LocalNode*)
+                 + schildren.capacity() * sizeof(LocalNode*);
+
+    for (auto* child : children)
+    {
+        bytes += child->footprint();
+    }
+
+    return bytes;
 }
 
 LocalNode* LocalNode::findChildWithSyncedNodeHandle(NodeHandle h)
 {
     for (auto& c : children)
     {
-        if (c.second->syncedCloudNodeHandle == h)
+        if (c->syncedCloudNodeHandle == h)
         {
-            return c.second;
+            return c;
         }
     }
     return nullptr;
@@ -3677,7 +4004,7 @@ void LocalNode::setRecomputeExclusionState(bool includingThisOne, bool scan)
 
         for (auto& childIt : node.children)
         {
-            auto& child = *childIt.second;
+            auto& child = *childIt;
 
             if (child.mExclusionState == ES_UNKNOWN)
                 continue;
@@ -25,6 +25,8 @@
 #include "mega/megaapp.h"
 #include "mega/share.h"
 
+#include <chrono>
+#include <condition_variable>
 
 namespace mega {
 
@@ -284,6 +286,13 @@ sharedNode_list NodeManager::getChildren_internal(const Node *parent, CancelToke
         return childrenList;
     }
 
+    // snapshots have no position in mNodes
+    if (parent->mIsSnapshot)
+    {
+        assert(false);
+        return childrenList;
+    }
+
     // if handles of all children are known, load missing child nodes one by one
     if (parent->mNodePosition->second.mAllChildrenHandleLoaded)
     {
@@ -380,13 +389,13 @@ sharedNode_list NodeManager::getChildren_internal(const Node *parent, CancelToke
     return childrenList;
 }
 
-sharedNode_vector NodeManager::getChildren(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page)
+sharedNode_vector NodeManager::getChildren(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, bool snapshots)
 {
     LockGuard g(mMutex);
-    return getChildren_internal(filter, order, cancelFlag, page);
+    return getChildren_internal(filter, order, cancelFlag, page, snapshots);
 }
 
-sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page)
+sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, bool snapshots)
 {
     assert(mMutex.owns_lock());
 
@@ -414,7 +423,7 @@ sharedNode_vector NodeManager::getChildren_internal(const NodeSearchFilter& filt
         return sharedNode_vector();
     }
 
-    sharedNode_vector nodes = processUnserializedNodes(nodesFromTable, cancelFlag);
+    sharedNode_vector nodes = processUnserializedNodes(nodesFromTable, cancelFlag, snapshots);
 
     return nodes;
 }
@@ -527,13 +536,13 @@ uint64_t NodeManager::getNodeCount_internal()
     return count;
 }
 
-sharedNode_vector NodeManager::searchNodes(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page)
+sharedNode_vector NodeManager::searchNodes(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, bool snapshots)
 {
     LockGuard g(mMutex);
-    return searchNodes_internal(filter, order, cancelFlag, page);
+    return searchNodes_internal(filter, order, cancelFlag, page, snapshots);
 }
 
-sharedNode_vector NodeManager::searchNodes_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page)
+sharedNode_vector NodeManager::searchNodes_internal(const NodeSearchFilter& filter, int order, CancelToken cancelFlag, const NodeSearchPage& page, bool snapshots)
 {
     assert(mMutex.owns_lock());
 
@@ -566,7 +575,7 @@ sharedNode_vector NodeManager::searchNodes_internal(const NodeSearchFilter& filt
         return sharedNode_vector();
     }
 
-    sharedNode_vector nodes = processUnserializedNodes(nodesFromTable, cancelFlag);
+    sharedNode_vector nodes = processUnserializedNodes(nodesFromTable, cancelFlag, snapshots);
 
     return nodes;
 }
@@ -734,7 +743,19 @@ sharedNode_vector NodeManager::getNodesByFingerprint_internal(FileFingerprint &f
     std::vector<std::pair<NodeHandle, NodeSerialized>> nodesFromTable;
     std::string fingerprintString;
     fingerprint.FileFingerprint::serialize(&fingerprintString);
+
+    // most fingerprints looked up aren't in the account at all
+    if (!fingerprintMayBeInDb(fingerprintString))
+    {
+        return nodes;
+    }
+
     mTable->getNodesByFingerprint(fingerprintString, nodesFromTable);
+    if (nodesFromTable.empty() && mFingerprintFilter.ready())
+    {
+        ++mFingerprintFilterStats.falsePositives;
+    }
+
     if (nodesFromTable.size())
     {
         for (const auto& nodeIt : nodesFromTable)
@@ -820,8 +841,20 @@ std::shared_ptr<Node> NodeManager::getNodeByFingerprint_internal(FileFingerprint
     NodeSerialized nodeSerialized;
     std::string fingerprintString;
     fingerprint.FileFingerprint::serialize(&fingerprintString);
+
+    // most fingerprints looked up aren't in the account at all
+    if (!fingerprintMayBeInDb(fingerprintString))
+    {
+        return nullptr;
+    }
+
     NodeHandle handle;
     mTable->getNodeByFingerprint(fingerprintString, nodeSerialized, handle);
+    if (nodeSerialized.mNode.empty() && mFingerprintFilter.ready())
+    {
+        ++mFingerprintFilterStats.falsePositives;
+    }
+
     auto itNode = mNodes.find(handle);
     std::shared_ptr<Node> node = itNode != mNodes.end() ? itNode->second.getNodeInRam() : nullptr;
     if (!node && nodeSerialized.mNode.size()) // nodes with that fingerprint found in DB
@@ -842,7 +875,7 @@ std::shared_ptr<Node> NodeManager::childNodeByNameType_internal(const Node* pare
 {
     assert(mMutex.owns_lock());
 
-    if (!mTable || mNodes.empty())
+    if (!mTable || mNodes.empty() || parent->mIsSnapshot)
     {
         assert(false);
         return nullptr;
@@ -1066,10 +1099,33 @@ sharedNode_vector NodeManager::getNodesWithSharesOrLink_internal(ShareType_t sha
 }
 
 shared_ptr<Node> NodeManager::getNodeFromNodeSerialized(const NodeSerialized &nodeSerialized)
+{
+    NodeData nodeData(nodeSerialized.mNode.data(), nodeSerialized.mNode.size(), NodeData::COMPONENT_ALL);
+
+    return getNodeFromNodeData(nodeData, nodeSerialized.mNodeCounter);
+}
+
+shared_ptr<Node> NodeManager::getNodeSnapshot(NodeData& nodeData, const std::string& nodeCounter)
 {
     assert(mMutex.owns_lock());
 
-    shared_ptr<Node> node = unserializeNode(&nodeSerialized.mNode, false);
+    shared_ptr<Node> node = nodeData.createSnapshot(mClient, nodeCounter);
+    if (!node)
+    {
+        return nullptr;
+    }
+
+    // the parent is only referenced: the snapshot isn't added to its children
+    node->parent = getNodeByHandle_internal(node->parentHandle());
+
+    return node;
+}
+
+shared_ptr<Node> NodeManager::getNodeFromNodeData(NodeData& nodeData, const std::string& nodeCounter)
+{
+    assert(mMutex.owns_lock());
+
+    shared_ptr<Node> node = unserializeNode(nodeData, false);
     if (!node)
     {
         assert(false);
@@ -1080,7 +1136,7 @@ shared_ptr<Node> NodeManager::getNodeFromNodeSerialized(const NodeSerialized &no
         return nullptr;
     }
 
-    setNodeCounter(node, NodeCounter(nodeSerialized.mNodeCounter), false, nullptr);
+    setNodeCounter(node, NodeCounter(nodeCounter), false, nullptr);
 
     // do not automatically try to reload the account if we can't unserialize.
     // (1) we might go around in circles downloading the account over and over, DDOSing MEGA, because we get the same data back each time
@@ -1322,6 +1378,8 @@ void NodeManager::cleanNodes_internal()
     assert(mMutex.owns_lock());
 
     mFingerPrints.clear();
+    mFingerprintFilter.clear();
+    mFingerprintFilterStats = FingerprintFilterStats();
     mNodes.clear();
     mCacheLRU.clear();
     mNodesInRam = 0;
@@ -1350,12 +1408,19 @@ std::shared_ptr<Node> NodeManager::getNodeFromBlob_internal(const std::string* n
 // parse serialized node and return Node object - updates nodes hash and parent
 // mismatch vector
 shared_ptr<Node> NodeManager::unserializeNode(const std::string *d, bool fromOldCache)
+{
+    NodeData nodeData(d->data(), d->size(), NodeData::COMPONENT_ALL);
+
+    return unserializeNode(nodeData, fromOldCache);
+}
+
+shared_ptr<Node> NodeManager::unserializeNode(NodeData& nodeData, bool fromOldCache)
 {
     assert(mMutex.owns_lock());
 
     std::list<std::unique_ptr<NewShare>> ownNewshares;
 
-    if (shared_ptr<Node> n = Node::unserialize(mClient, d, fromOldCache, ownNewshares))
+    if (shared_ptr<Node> n = Node::unserialize(mClient, nodeData, fromOldCache, ownNewshares))
     {
 
         auto pair = mNodes.emplace(n->nodeHandle(), NodeManagerNode(*this, n->nodeHandle()));
@@ -1420,6 +1485,9 @@ void NodeManager::notifyPurge()
     {
         mClient.applykeys();
 
+        // before the app is told, so a refresh from the callback gets the new recents
+        mClient.updateRecentActions(nodesToReport);
+
         if (!mClient.fetchingnodes)
         {
             assert(!mMutex.owns_lock());
@@ -1556,6 +1624,7 @@ bool NodeManager::loadNodes_internal()
         getChildren_internal(node.get());
     }
 
+    buildFingerprintFilter();
     mInitialized = true;
     return true;
 }
@@ -1780,6 +1849,7 @@ void NodeManager::initCompleted_internal()
     }
 
     mTable->createIndexes();
+    buildFingerprintFilter();
     mInitialized = true;
 }
 
@@ -1791,6 +1861,7 @@ bool NodeManager::ready()
 void NodeManager::insertNodeCacheLRU_internal(std::shared_ptr<Node> node)
 {
     assert(mMutex.owns_lock() && "Mutex should be locked by this thread");
+    assert(!node->mIsSnapshot);
     if (node->mNodePosition->second.mLRUPosition != mCacheLRU.end())
     {
         mCacheLRU.erase(node->mNodePosition->second.mLRUPosition);
@@ -2007,6 +2078,68 @@ uint64_t NodeManager::getNumberNodesInRam() const
     return mNodesInRam;
 }
 
+NodeManager::FingerprintFilterStats NodeManager::getFingerprintFilterStats() const
+{
+    LockGuard g(mMutex);
+    FingerprintFilterStats stats = mFingerprintFilterStats;
+    stats.memory = mFingerprintFilter.memory();
+    return stats;
+}
+
+void NodeManager::buildFingerprintFilter()
+{
+    assert(mMutex.owns_lock());
+
+    mFingerprintFilter.clear();
+
+    if (!mTable)
+    {
+        return;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+
+    // leave room for as many new fingerprints again before a rebuild is needed
+    mFingerprintFilter.reset(static_cast<size_t>(mTable->getNumberOfNodes()) * 2);
+
+    if (!mTable->getFingerprints([this](const std::string& fingerprint) { mFingerprintFilter.add(fingerprint); }))
+    {
+        LOG_warn << "Unable to build the fingerprint filter";
+        mFingerprintFilter.clear();
+        return;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+
+    LOG_debug << "Fingerprint filter built in " << elapsed.count() << " ms ("
+              << mFingerprintFilter.memory() << " bytes)";
+}
+
+bool NodeManager::fingerprintMayBeInDb(const std::string& fingerprint)
+{
+    assert(mMutex.owns_lock());
+
+    if (mFingerprintFilter.saturated())
+    {
+        buildFingerprintFilter();
+    }
+
+    if (!mFingerprintFilter.ready())
+    {
+        return true;
+    }
+
+    ++mFingerprintFilterStats.lookups;
+
+    if (mFingerprintFilter.mayContain(fingerprint))
+    {
+        return true;
+    }
+
+    ++mFingerprintFilterStats.negatives;
+    return false;
+}
+
 void NodeManager::addChild(NodeHandle parent, NodeHandle child, Node* node)
 {
     LockGuard g(mMutex);
@@ -2086,58 +2219,105 @@ sharedNode_vector NodeManager::getRootNodesAndInshares()
     return rootnodes;
 }
 
-sharedNode_vector NodeManager::processUnserializedNodes(const vector<pair<NodeHandle, NodeSerialized>>& nodesFromTable, CancelToken cancelFlag)
+sharedNode_vector NodeManager::processUnserializedNodes(const vector<pair<NodeHandle, NodeSerialized>>& nodesFromTable, CancelToken cancelFlag, bool snapshots)
+{
+    return processUnserializedNodes(nodesFromTable, NodeHandle(), cancelFlag, snapshots);
+}
+
+sharedNode_vector NodeManager::processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized> >& nodesFromTable, NodeHandle ancestorHandle, CancelToken cancelFlag, bool snapshots)
 {
     assert(mMutex.owns_lock());
 
     sharedNode_vector nodes;
 
+    // Which results aren't already in memory?
+    sharedNode_vector nodesInRAM;
+    std::vector<NodeHandle> missing;
+
+    nodesInRAM.reserve(nodesFromTable.size());
+
     for (const auto& nodeIt : nodesFromTable)
     {
-        // Check pointer and value
-        if (cancelFlag.isCancelled()) break;
+        nodesInRAM.emplace_back(getNodeInRAM(nodeIt.first));
 
-        shared_ptr<Node> n = getNodeInRAM(nodeIt.first);
-        if (!n)
+        if (!nodesInRAM.back())
         {
-            n = getNodeFromNodeSerialized(nodeIt.second);
-            if (!n)
-            {
-                nodes.clear();
-                return nodes;
-            }
+            missing.emplace_back(nodeIt.first);
         }
+    }
+
+    // filter results by subtree (nodeHandle) with a single query rather than one per node
+    std::set<NodeHandle> descendants;
 
-        nodes.push_back(n);
+    if (!ancestorHandle.isUndef() && !missing.empty()
+        && !mTable->filterByAncestor(ancestorHandle, missing, descendants, cancelFlag))
+    {
+        return nodes;
     }
 
-    return nodes;
-}
+    // Parse the records of whatever nodes we need to load.
+    std::vector<std::unique_ptr<NodeData>> records(nodesFromTable.size());
 
-sharedNode_vector NodeManager::processUnserializedNodes(const std::vector<std::pair<NodeHandle, NodeSerialized> >& nodesFromTable, NodeHandle ancestorHandle, CancelToken cancelFlag)
-{
-    assert(mMutex.owns_lock());
+    for (size_t i = 0; i < nodesFromTable.size(); ++i)
+    {
+        const auto& nodeIt = nodesFromTable[i];
 
-    sharedNode_vector nodes;
+        if (nodesInRAM[i] || (!ancestorHandle.isUndef() && !descendants.count(nodeIt.first)))
+        {
+            continue;
+        }
 
-    for (const auto& nodeIt : nodesFromTable)
+        const auto& blob = nodeIt.second.mNode;
+
+        records[i] = std::make_unique<NodeData>(blob.data(), blob.size(), NodeData::COMPONENT_ALL);
+    }
+
+    // Parsing only touches the records so other threads may use the
+    // node manager meanwhile. Nodes may be loaded or removed while we're
+    // unlocked, which is why everything is looked up again below.
+    mMutex.unlock();
+    parseNodes(records);
+    mMutex.lock();
+
+    // The node manager's been reset while we were parsing.
+    if (!mTable)
+    {
+        return nodes;
+    }
+
+    for (size_t i = 0; i < nodesFromTable.size(); ++i)
     {
         // Check pointer and value
         if (cancelFlag.isCancelled()) break;
 
-        std::shared_ptr<Node> n = getNodeInRAM(nodeIt.first);
+        const auto& nodeIt = nodesFromTable[i];
+        std::shared_ptr<Node> n = std::move(nodesInRAM[i]);
 
-        if (!ancestorHandle.isUndef())  // filter results by subtree (nodeHandle)
+        if (n)
         {
-            bool skip = n ? !n->isAncestor(ancestorHandle)
-                          : !mTable->isAncestor(nodeIt.first, ancestorHandle, cancelFlag);
+            // The node's been removed while we were parsing.
+            if (getNodeInRAM(nodeIt.first) != n) continue;
 
-            if (skip) continue;
+            if (!ancestorHandle.isUndef() && !n->isAncestor(ancestorHandle)) continue;
         }
-
-        if (!n)
+        else if (!records[i])
+        {
+            // Skipped by the subtree filter.
+            continue;
+        }
+        // The node may have been loaded while loading an earlier result.
+        else if (!(n = getNodeInRAM(nodeIt.first)))
         {
-            n = std::shared_ptr<Node> (getNodeFromNodeSerialized(nodeIt.second));
+            if (snapshots)
+            {
+                n = getNodeSnapshot(*records[i], nodeIt.second.mNodeCounter);
+            }
+
+            if (!n)
+            {
+                n = getNodeFromNodeData(*records[i], nodeIt.second.mNodeCounter);
+            }
+
             if (!n)
             {
                 nodes.clear();
@@ -2151,7 +2331,66 @@ sharedNode_vector NodeManager::processUnserializedNodes(const std::vector<std::p
     return nodes;
 }
 
-void NodeManager::putNodeInDb(Node* node) const
+void NodeManager::parseNodes(std::vector<std::unique_ptr<NodeData>>& records)
+{
+    // Smaller batches aren't worth handing to other threads.
+    constexpr size_t MIN_BATCH_SIZE = 256;
+
+    auto parse = [&records](size_t begin, size_t end) {
+        for (; begin < end; ++begin)
+        {
+            if (records[begin])
+            {
+                records[begin]->parse();
+            }
+        }
+    };
+
+    auto numThreads = std::max(1u, std::thread::hardware_concurrency());
+    auto numBatches = std::min<size_t>(numThreads, records.size() / MIN_BATCH_SIZE);
+
+    if (numBatches < 2)
+    {
+        return parse(0, records.size());
+    }
+
+    // We're called without mMutex so several threads may get here at once.
+    std::call_once(mParseQueueCreated, [&]() {
+        mParseQueue = std::make_unique<MegaClientAsyncQueue>(*mClient.waiter, numThreads - 1);
+    });
+
+    auto batchSize = (records.size() + numBatches - 1) / numBatches;
+
+    std::condition_variable completed;
+    std::mutex lock;
+    size_t pending = numBatches - 1;
+
+    // Hand all but the first batch to our worker threads.
+    for (size_t i = 1; i < numBatches; ++i)
+    {
+        auto begin = i * batchSize;
+        auto end = std::min(begin + batchSize, records.size());
+
+        mParseQueue->push([&, begin, end](SymmCipher&) {
+            parse(begin, end);
+
+            std::lock_guard<std::mutex> guard(lock);
+
+            if (!--pending)
+            {
+                completed.notify_one();
+            }
+        }, false);
+    }
+
+    parse(0, batchSize);
+
+    std::unique_lock<std::mutex> guard(lock);
+
+    completed.wait(guard, [&pending]() { return !pending; });
+}
+
+void NodeManager::putNodeInDb(Node* node)
 {
     if (!node)
     {
@@ -2172,6 +2411,13 @@ void NodeManager::putNodeInDb(Node* node) const
     }
 
     mTable->put(node);
+
+    if (node->type == FILENODE && mFingerprintFilter.ready())
+    {
+        std::string fingerprint;
+        node->FileFingerprint::serialize(&fingerprint);
+        mFingerprintFilter.add(fingerprint);
+    }
 }
 
 size_t NodeManager::nodeNotifySize() const
@@ -2201,6 +2447,76 @@ void NodeManager::FingerprintContainer::clear()
     mAllFingerprintsLoaded.clear();
 }
 
+void NodeManager::FingerprintFilter::reset(size_t capacity)
+{
+    constexpr size_t MIN_CAPACITY = 4096;
+
+    mCapacity = std::max(capacity, MIN_CAPACITY);
+    mCount = 0;
+    mBits.assign((mCapacity * BITS_PER_FINGERPRINT + 63) / 64, 0);
+}
+
+void NodeManager::FingerprintFilter::clear()
+{
+    mBits.clear();
+    mBits.shrink_to_fit();
+    mCapacity = 0;
+    mCount = 0;
+}
+
+template<typename Function>
+void NodeManager::FingerprintFilter::forEachBit(const std::string& fingerprint, Function&& function) const
+{
+    // splitmix64 finalizer
+    auto mix = [](uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    };
+
+    // double hashing: every bit is derived from two independent hashes
+    auto hash = static_cast<uint64_t>(std::hash<std::string>()(fingerprint));
+    auto h1 = mix(hash);
+    auto h2 = mix(hash ^ 0x9e3779b97f4a7c15ull) | 1;
+    auto numBits = static_cast<uint64_t>(mBits.size()) * 64;
+
+    for (unsigned i = 0; i < NUM_HASHES; ++i)
+    {
+        auto bit = (h1 + i * h2) % numBits;
+
+        if (!function(bit / 64, uint64_t(1) << (bit % 64)))
+        {
+            return;
+        }
+    }
+}
+
+void NodeManager::FingerprintFilter::add(const std::string& fingerprint)
+{
+    assert(ready());
+
+    forEachBit(fingerprint, [this](size_t word, uint64_t mask) {
+        mBits[word] |= mask;
+        return true;
+    });
+
+    ++mCount;
+}
+
+bool NodeManager::FingerprintFilter::mayContain(const std::string& fingerprint) const
+{
+    assert(ready());
+
+    bool found = true;
+
+    forEachBit(fingerprint, [this, &found](size_t word, uint64_t mask) {
+        found = (mBits[word] & mask) != 0;
+        return found;
+    });
+
+    return found;
+}
+
 void NodeManager::Rootnodes::clear()
 {
     mRootNodes.clear();
@@ -588,6 +588,40 @@ bool PosixFileAccess::ftruncate(m_off_t size)
     return false;
 }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+
+bool PosixFileAccess::fpreallocate(m_off_t size)
+{
+    // Reserve the blocks but leave the file's size alone.
+    if (!::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size))
+        return true;
+
+    // Not all filesystems support preallocation.
+    LOG_debug << "Unable to preallocate "
+              << size
+              << " byte(s) for descriptor "
+              << fd
+              << ". Error was: "
+              << errno;
+
+    return false;
+}
+
+void PosixFileAccess::fwriteback(m_off_t pos, m_off_t length)
+{
+    ::sync_file_range(fd, pos, length, SYNC_FILE_RANGE_WRITE);
+}
+
+void PosixFileAccess::fdropcache(m_off_t pos, m_off_t length)
+{
+    // The range's writeback was started by fwriteback(), so only wait for it
+    // to finish rather than starting (and waiting for) any more writing.
+    if (!::sync_file_range(fd, pos, length, SYNC_FILE_RANGE_WAIT_BEFORE))
+        posix_fadvise(fd, pos, length, POSIX_FADV_DONTNEED);
+}
+
+#endif // __linux__ && ! __ANDROID__
+
 int PosixFileAccess::stealFileDescriptor()
 {
     int toret = fd;
@@ -357,6 +357,23 @@ void RaidBufferManager::bufferWriteCompleted(unsigned connectionNum, bool succes
     }
 }
 
+std::shared_ptr<RaidBufferManager::FilePiece> RaidBufferManager::detachAsyncOutputBuffer(unsigned connectionNum)
+{
+    std::shared_ptr<FilePiece> piece;
+
+    auto aob = asyncoutputbuffers.find(connectionNum);
+    if (aob != asyncoutputbuffers.end())
+    {
+        piece.swap(aob->second);
+    }
+    return piece;
+}
+
+void RaidBufferManager::detachedBufferWriteCompleted(FilePiece& piece)
+{
+    bufferWriteCompletedAction(piece);
+}
+
 void RaidBufferManager::bufferWriteCompletedAction(FilePiece&)
 {
     // overridden for Transfers
@@ -405,6 +405,12 @@ void RequestDispatcher::sendDeferred()
 
 void RequestDispatcher::add(Command *c)
 {
+    if (c->mUnordered && unorderedLane)
+    {
+        unorderedLane->add(c);
+        return;
+    }
+
 #if defined(MEGA_MEASURE_CODE) || defined(DEBUG)
     if (deferRequests && deferRequests(c))
     {
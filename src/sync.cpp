@@ -36,7 +36,9 @@
 namespace mega {
 
 const int Sync::SCANNING_DELAY_DS = 5;
+const int Sync::TARGETED_SCANNING_DELAY_DS = 1;
 const int Sync::EXTRA_SCANNING_DELAY_DS = 150;
+const int Sync::TARGETED_SYNC_MAX_DS = 50;
 const int Sync::FILE_UPDATE_DELAY_DS = 30;
 const int Sync::FILE_UPDATE_MAX_DELAY_SECS = 60;
 const dstime Sync::RECENT_VERSION_INTERVAL_SECS = 10800;
@@ -229,6 +231,127 @@ void SyncThreadsafeState::setSyncTmpFolder(const LocalPath& tmpFolder)
     mSyncTmpFolder = tmpFolder;
 }
 
+SyncThreadsafeState::TreestateShard& SyncThreadsafeState::treestateShard(uint64_t parentId, const LocalPath& name) const
+{
+    auto& raw = name.rawValue();
+    auto hash = std::hash<std::decay_t<decltype(raw)>>()(raw) ^ std::hash<uint64_t>()(parentId);
+    return mTreestates[hash % TREESTATE_SHARDS];
+}
+
+SyncThreadsafeState::TreestateShard& SyncThreadsafeState::treestateShard(uint64_t id) const
+{
+    return mTreestates[id % TREESTATE_SHARDS];
+}
+
+uint64_t SyncThreadsafeState::nextTreestateId()
+{
+    return ++mNextTreestateId;
+}
+
+void SyncThreadsafeState::linkTreestate(uint64_t parentId, const LocalPath& name, const LocalPath* shortname, uint64_t id)
+{
+    {
+        auto& shard = treestateShard(parentId, name);
+        lock_guard<mutex> g(shard.mMutex);
+        shard.mNames[TreestateLink(parentId, name)] = id;
+    }
+
+    if (shortname)
+    {
+        auto& shard = treestateShard(parentId, *shortname);
+        lock_guard<mutex> g(shard.mMutex);
+        shard.mShortnames[TreestateLink(parentId, *shortname)] = id;
+    }
+}
+
+void SyncThreadsafeState::unlinkTreestate(uint64_t parentId, const LocalPath& name, const LocalPath* shortname, uint64_t id)
+{
+    // only remove links that still refer to id, another node may have taken the name since
+    {
+        auto& shard = treestateShard(parentId, name);
+        lock_guard<mutex> g(shard.mMutex);
+
+        auto it = shard.mNames.find(TreestateLink(parentId, name));
+        if (it != shard.mNames.end() && it->second == id)
+        {
+            shard.mNames.erase(it);
+        }
+    }
+
+    if (shortname)
+    {
+        auto& shard = treestateShard(parentId, *shortname);
+        lock_guard<mutex> g(shard.mMutex);
+
+        auto it = shard.mShortnames.find(TreestateLink(parentId, *shortname));
+        if (it != shard.mShortnames.end() && it->second == id)
+        {
+            shard.mShortnames.erase(it);
+        }
+    }
+}
+
+void SyncThreadsafeState::publishTreestate(uint64_t id, treestate_t ts)
+{
+    auto& shard = treestateShard(id);
+
+    lock_guard<mutex> g(shard.mMutex);
+
+    if (ts == TREESTATE_NONE)
+    {
+        shard.mStates.erase(id);
+    }
+    else
+    {
+        shard.mStates[id] = ts;
+    }
+}
+
+uint64_t SyncThreadsafeState::linkedTreestate(uint64_t parentId, const LocalPath& name) const
+{
+    auto& shard = treestateShard(parentId, name);
+
+    lock_guard<mutex> g(shard.mMutex);
+
+    auto link = TreestateLink(parentId, name);
+    auto it = shard.mNames.find(link);
+
+    if (it != shard.mNames.end())
+    {
+        return it->second;
+    }
+
+    // as localnodebypath() does, fall back to the shortname (only relevant on Windows)
+    it = shard.mShortnames.find(link);
+    return it == shard.mShortnames.end() ? 0 : it->second;
+}
+
+treestate_t SyncThreadsafeState::publishedTreestate(const LocalPath& relativePath) const
+{
+    // start at the sync root
+    auto id = linkedTreestate(0, LocalPath());
+
+    size_t index = 0;
+    LocalPath component;
+
+    while (id && relativePath.nextPathComponent(index, component))
+    {
+        id = linkedTreestate(id, component);
+    }
+
+    if (!id)
+    {
+        return TREESTATE_NONE;
+    }
+
+    auto& shard = treestateShard(id);
+
+    lock_guard<mutex> g(shard.mMutex);
+
+    auto it = shard.mStates.find(id);
+    return it == shard.mStates.end() ? TREESTATE_NONE : it->second;
+}
+
 void SyncThreadsafeState::addExpectedUpload(NodeHandle parentHandle, const string& name, weak_ptr<SyncUpload_inClient> wp)
 {
     lock_guard<mutex> g(mMutex);
@@ -817,17 +940,30 @@ void Sync::addstatecachechildren(uint32_t parent_dbid, idlocalnode_map* tmap, Lo
 
     auto range = tmap->equal_range(parent_dbid);
 
-    // remove processed elements as we go, so we can then clean the database at the end.
-    for (auto it = range.first; it != tmap->end() && it->first == parent_dbid; it = tmap->erase(it))
+    // add the children in name order so that p's child vectors are appended to rather than shuffled.
+    // a stable sort keeps later duplicates after earlier ones, as the old algorithm expects.
+    vector<LocalNode*> rows;
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        rows.push_back(it->second);
+    }
+
+    std::stable_sort(rows.begin(), rows.end(), [](const LocalNode* lhs, const LocalNode* rhs) {
+        return lhs->localname < rhs->localname;
+    });
+
+    // remove processed elements, so we can then clean the database at the end.
+    tmap->erase(range.first, range.second);
+
+    for (LocalNode* const l : rows)
     {
-        LocalNode* const l = it->second;
 
         auto preExisting = p->children.find(l->localname);
         if (preExisting != p->children.end())
         {
             // tidying up from prior versions of the SDK which might have duplicate LocalNodes
-            LOG_debug << "Removing duplicate LocalNode: " << preExisting->second->debugGetParentList();
-            delete preExisting->second;   // also detaches and preps removal from db
+            LOG_debug << "Removing duplicate LocalNode: " << (*preExisting)->debugGetParentList();
+            delete *preExisting;   // also detaches and preps removal from db
             assert(p->children.find(l->localname) == p->children.end());
             // l will be added in its place.  Later entries were the ones used by the old algorithm
         }
@@ -923,7 +1059,8 @@ void Sync::readstatecache()
     }
     cachenodes();
 
-    LOG_debug << syncname << "Sync " << toHandle(getConfig().mBackupId) << " loaded from db with " << numLocalNodes << " sync nodes";
+    LOG_debug << syncname << "Sync " << toHandle(getConfig().mBackupId) << " loaded from db with " << numLocalNodes << " sync nodes"
+              << " (" << localroot->footprint() / std::max(numLocalNodes, 1u) << " bytes per node)";
 
     localroot->setScanAgain(false, true, true, 0);
 }
@@ -1066,7 +1203,7 @@ void UnifiedSync::changeState(SyncError newSyncError, bool newEnableFlag, bool n
                 // However, if there are db files from a previous SRW version (i.e., the user downgraded from SRW to NO SRW and then upgraded again to SRW)
                 // we need to remove the SRW db files. The flag DB_OPEN_FLAG_RECYCLE is used for this purpose.
                 int dbFlags = DB_OPEN_FLAG_TRANSACTED; // Unused
-                if (DbAccess::LEGACY_DB_VERSION == DbAccess::LAST_DB_VERSION_WITHOUT_SRW)
+                if (DbAccess::legacyDbRecyclable())
                 {
                     dbFlags |= DB_OPEN_FLAG_RECYCLE;
                 }
@@ -1148,7 +1285,7 @@ LocalNode* Sync::localnodebypath(LocalNode* l, const LocalPath& localpath, Local
             *parent = l;
         }
 
-        localnode_map::iterator it;
+        localnode_children::iterator it;
         if ((it = l->children.find(component)) == l->children.end()
             && (it = l->schildren.find(component)) == l->schildren.end())
         {
@@ -1167,7 +1304,7 @@ LocalNode* Sync::localnodebypath(LocalNode* l, const LocalPath& localpath, Local
             return NULL;
         }
 
-        l = it->second;
+        l = *it;
     }
 
     // full match: no residual path, return corresponding LocalNode
@@ -2135,7 +2272,7 @@ bool Sync::checkLocalPathForMovesRenames(SyncRow& row, SyncRow& parentRow, SyncP
                     // and remove them if the cloud actions succeed.
                     for (auto& c : row.syncNode->children)
                     {
-                        movePtr->priorChildrenToRemove[c.second->localname] = c.second;
+                        movePtr->priorChildrenToRemove[c->localname] = c;
                     }
                 }
 
@@ -2657,9 +2794,9 @@ bool Sync::checkForCompletedCloudMoveToHere(SyncRow& row, SyncRow& parentRow, Sy
                 {
                     for (auto& c : row.syncNode->children)
                     {
-                        if (c.first == oldc.first && c.second == oldc.second)
+                        if (c->localname == oldc.first && c == oldc.second)
                         {
-                            delete c.second; // removes itself from the parent map
+                            delete c; // removes itself from the parent map
                             break;
                         }
                     }
@@ -3069,7 +3206,7 @@ bool Sync::checkCloudPathForMovesRenames(SyncRow& row, SyncRow& parentRow, SyncP
             childrenToDeleteOnFunctionExit.reset(new LocalNode(this));
             while (!row.syncNode->children.empty())
             {
-                auto* child = row.syncNode->children.begin()->second;
+                auto* child = *row.syncNode->children.begin();
                 child->setnameparent(childrenToDeleteOnFunctionExit.get(), child->localname, child->cloneShortname());
             }
         }
@@ -3136,7 +3273,7 @@ bool Sync::checkCloudPathForMovesRenames(SyncRow& row, SyncRow& parentRow, SyncP
                     // Make this new fsNode part of our sync data structure
                     parentRow.fsAddedSiblings.emplace_back(std::move(*fsNode));
                     row.fsNode = &parentRow.fsAddedSiblings.back();
-                    row.syncNode->slocalname = row.fsNode->cloneShortname();
+                    row.syncNode->setnameparent(row.syncNode->parent, row.syncNode->localname, row.fsNode->cloneShortname());
 
                     row.syncNode->setSyncedFsid(row.fsNode->fsid, syncs.localnodeBySyncedFsid, row.fsNode->localname, row.fsNode->cloneShortname());
                     row.syncNode->syncedFingerprint = row.fsNode->fingerprint;
@@ -3385,7 +3522,13 @@ dstime Sync::procscanq()
                          << (scanDescendants ? " (recursive)" : "");
         }
 
-        nearest->setScanAgain(false, true, scanDescendants, SCANNING_DELAY_DS);
+        // Folders we visit directly only wait long enough to coalesce a burst of notifications.
+        auto scanDelay = nearest->parent ? TARGETED_SCANNING_DELAY_DS : SCANNING_DELAY_DS;
+
+        nearest->setScanAgain(false, true, scanDescendants, scanDelay);
+
+        // Visit this folder directly rather than waiting for the next full pass.
+        mTargetedFolders.emplace(nearest->getLocalPath(), syncs.waiter->ds);
 
         if (nearest->rareRO().scanBlocked)
         {
@@ -3395,12 +3538,131 @@ dstime Sync::procscanq()
         }
 
         // How long the caller should wait before syncing.
-        delay = SCANNING_DELAY_DS;
+        delay = std::min<dstime>(delay, scanDelay);
     }
 
     return delay;
 }
 
+bool Sync::recursiveSyncTargetedFolders()
+{
+    assert(syncs.onSyncThread());
+
+    bool visited = false;
+
+    for (auto i = mTargetedFolders.begin(); i != mTargetedFolders.end(); )
+    {
+        LocalNode* node = localnodebypath(nullptr, i->first, nullptr, nullptr, false);
+
+        // Folders that went away or are taking too long are left to full passes,
+        // as is the sync's root, which a full pass visits directly anyway.
+        if (!node
+            || !node->parent
+            || node->type != FOLDERNODE
+            || syncs.waiter->ds > i->second + TARGETED_SYNC_MAX_DS
+            || !recursiveSyncTargetedFolder(*node))
+        {
+            i = mTargetedFolders.erase(i);
+            continue;
+        }
+
+        visited = true;
+
+        // The folder may have been removed or renamed while we synced it.
+        node = localnodebypath(nullptr, i->first, nullptr, nullptr, false);
+
+        // Keep visiting it until its subtree is in sync (eg, a scan is still running).
+        if (node && (node->scanRequired() || node->mightHaveMoves() || node->syncRequired()))
+        {
+            ++i;
+            continue;
+        }
+
+        SYNC_verbose << syncname << "Targeted sync resolved in "
+                     << syncs.waiter->ds - i->second
+                     << " ds: "
+                     << i->first;
+
+        i = mTargetedFolders.erase(i);
+    }
+
+    return visited;
+}
+
+bool Sync::recursiveSyncTargetedFolder(LocalNode& node)
+{
+    assert(syncs.onSyncThread());
+    assert(node.type == FOLDERNODE);
+    assert(node.parent);
+
+    // Every ancestor must be in sync, so that syncing this subtree
+    // on its own is equivalent to reaching it from localroot.
+    unsigned depth = 0;
+
+    for (auto* ancestor = node.parent; ancestor; ancestor = ancestor->parent)
+    {
+        if (ancestor->scanAgain >= TREE_ACTION_HERE
+            || ancestor->syncAgain >= TREE_ACTION_HERE
+            || ancestor->checkMovesAgain >= TREE_ACTION_HERE)
+        {
+            return false;
+        }
+
+        ++depth;
+    }
+
+    CloudNode cloudNode;
+    string cloudPath;
+    bool inTrash = false;
+
+    // The cloud side must still be where we last synced it.
+    if (!syncs.lookupCloudNode(node.syncedCloudNodeHandle,
+                               cloudNode,
+                               &cloudPath,
+                               &inTrash,
+                               nullptr,
+                               nullptr,
+                               nullptr,
+                               Syncs::FOLDER_ONLY)
+        || inTrash
+        || cloudNode.parentHandle != node.parent->syncedCloudNodeHandle)
+    {
+        return false;
+    }
+
+    auto localPath = node.getLocalPath();
+
+    // As must the local side.
+    auto fa = syncs.fsaccess->newfileaccess();
+
+    if (!fa->fopen(localPath, true, false, FSLogging::noLogging, nullptr, true)
+        || fa->type != FOLDERNODE
+        || fa->fsid != node.fsid_lastSynced)
+    {
+        return false;
+    }
+
+    SyncPath pathBuffer(syncs, localPath, cloudPath);
+
+    for (auto* n = &node; n->parent; n = n->parent)
+    {
+        pathBuffer.syncPath.insert(0, "/" + n->toName_of_localname);
+    }
+
+    FSNode fsNode(node.getLastSyncedFSDetails());
+    SyncRow row{&cloudNode, &node, &fsNode};
+
+    std::lock_guard<std::timed_mutex> g(syncs.mLocalNodeChangeMutex);
+
+    DBTableTransactionCommitter committer(statecachetable);
+
+    recursiveSync(row, pathBuffer, false, false, depth);
+
+    cachenodes();
+
+    return true;
+}
+
 bool Sync::movetolocaldebris(const LocalPath& localpath)
 {
     assert(syncs.onSyncThread());
@@ -4185,7 +4447,7 @@ void Syncs::getSyncStatusInfoInThread(handle backupID,
 
             // Process children, if any.
             for (auto& childIt : node.children)
-                tally(info, *childIt.second);
+                tally(info, *childIt);
         }
 
         const Sync& mSync;
@@ -4549,45 +4811,41 @@ NodeHandle Syncs::getSyncedNodeForLocalPath(const LocalPath& lp)
     return result;
 }
 
-treestate_t Syncs::getSyncStateForLocalPath(handle backupId, const LocalPath& lp)
+bool Syncs::getSyncStateForLocalPath(const LocalPath& lp, treestate_t& ts) const
 {
-    assert(!onSyncThread());
+    shared_ptr<SyncThreadsafeState> state;
+    LocalPath relativePath;
 
-    // mLocalNodeChangeMutex must already be locked!!
-    // we never have mSyncVecMutex and then lock mLocalNodeChangeMutex
-    lock_guard<std::recursive_mutex> guard(mSyncVecMutex);
-    for (auto& us : mSyncVec)
     {
-        if (us->mConfig.mBackupId == backupId && us->mSync)
+        lock_guard<std::recursive_mutex> guard(mSyncVecMutex);
+
+        for (auto& us : mSyncVec)
         {
-            if (LocalNode* match = us->mSync->localnodebypath(nullptr, lp, nullptr, nullptr, true))
+            size_t subpathIndex = 0;
+
+            if (us->mSync && us->mConfig.mLocalPath.isContainingPathOf(lp, &subpathIndex))
             {
-                return match->checkTreestate(false);
+                auto debrisPath = us->mConfig.mLocalPath;
+                debrisPath.appendWithSeparator(LocalPath::fromRelativePath(DEBRISFOLDER), false);
+                if (debrisPath.isContainingPathOf(lp))
+                {
+                    return false;
+                }
+
+                state = us->mSync->threadSafeState;
+                relativePath = lp.subpathFrom(subpathIndex);
+                break;
             }
-            return TREESTATE_NONE;
         }
     }
-    return TREESTATE_NONE;
-}
 
-bool Syncs::getSyncStateForLocalPath(const LocalPath& lp, treestate_t& ts, nodetype_t& nt, SyncConfig& sc)
-{
-    assert(onSyncThread());
-    for (auto& us : mSyncVec)
+    if (!state)
     {
-        if (us->mSync && us->mConfig.mLocalPath.isContainingPathOf(lp))
-        {
-            if (LocalNode* match = us->mSync->localnodebypath(nullptr, lp, nullptr, nullptr, true))
-            {
-                ts = match->checkTreestate(false);
-                nt = match->type;
-                sc = us->mConfig;
-                return true;
-            }
-            return false;
-        }
+        return false;
     }
-    return false;
+
+    ts = state->publishedTreestate(relativePath);
+    return true;
 }
 
 error Syncs::syncConfigStoreAdd(const SyncConfig& config)
@@ -4824,7 +5082,7 @@ error Syncs::syncConfigStoreLoad(SyncConfigVector& configs)
                     // However, if there are db files from a previous SRW version (i.e., the user downgraded from SRW to NO SRW and then upgraded again to SRW)
                     // we need to remove the SRW db files. The flag DB_OPEN_FLAG_RECYCLE is used for this purpose.
                     int dbFlags = DB_OPEN_FLAG_TRANSACTED; // Unused
-                    if (DbAccess::LEGACY_DB_VERSION == DbAccess::LAST_DB_VERSION_WITHOUT_SRW)
+                    if (DbAccess::legacyDbRecyclable())
                     {
                         dbFlags |= DB_OPEN_FLAG_RECYCLE;
                     }
@@ -6487,18 +6745,17 @@ void SyncRow::inferOrCalculateChildSyncRows(bool wasSynced, vector<SyncRow>& chi
 
             for (auto &childIt : syncNode->children)
             {
-                assert(childIt.first == childIt.second->localname);
                 if (belowRemovedFsNode)
                 {
-                    if (childIt.second->fsid_asScanned != UNDEF)
+                    if (childIt->fsid_asScanned != UNDEF)
                     {
-                        childIt.second->setScannedFsid(UNDEF, localnodeByScannedFsid, LocalPath(), FileFingerprint());
-                        childIt.second->scannedFingerprint = FileFingerprint();
+                        childIt->setScannedFsid(UNDEF, localnodeByScannedFsid, LocalPath(), FileFingerprint());
+                        childIt->scannedFingerprint = FileFingerprint();
                     }
                 }
-                else if (childIt.second->fsid_asScanned != UNDEF)
+                else if (childIt->fsid_asScanned != UNDEF)
                 {
-                    fsChildren.emplace_back(childIt.second->getScannedFSDetails());
+                    fsChildren.emplace_back(childIt->getScannedFSDetails());
                 }
             }
 
@@ -6934,7 +7191,7 @@ auto Sync::computeSyncTriplets(vector<CloudNode>& cloudNodes, const LocalNode& s
     triplets.reserve(cloudNodes.size() + syncParent.children.size() + fsNodes.size());
 
     for (auto& cn : cloudNodes)          triplets.emplace_back(&cn, nullptr, nullptr);
-    for (auto& sn : syncParent.children) triplets.emplace_back(nullptr, sn.second, nullptr);
+    for (auto& sn : syncParent.children) triplets.emplace_back(nullptr, sn, nullptr);
     for (auto& fsn : fsNodes)            triplets.emplace_back(nullptr, nullptr, &fsn);
 
     auto tripletCompare = [this](const SyncRow& lhs, const SyncRow& rhs) -> int {
@@ -7043,7 +7300,7 @@ bool Sync::inferRegeneratableTriplets(vector<CloudNode>& cloudChildren, const Lo
     {
 
         CloudNode compareTo;
-        compareTo.handle = child.second->syncedCloudNodeHandle;
+        compareTo.handle = child->syncedCloudNodeHandle;
         auto iters = std::equal_range(cloudChildren.begin(), cloudChildren.end(), compareTo, cloudHandleLess);
 
         if (std::distance(iters.first, iters.second) != 1)
@@ -7061,15 +7318,15 @@ bool Sync::inferRegeneratableTriplets(vector<CloudNode>& cloudChildren, const Lo
             return false;
         }
 
-        if (child.second->fsid_asScanned == UNDEF ||
-           (!child.second->scannedFingerprint.isvalid && child.second->type == FILENODE))
+        if (child->fsid_asScanned == UNDEF ||
+           (!child->scannedFingerprint.isvalid && child->type == FILENODE))
         {
             // we haven't scanned yet, or the scans don't match up with LocalNodes yet
             return false;
         }
 
-        inferredFsNodes.push_back(child.second->getScannedFSDetails());
-        inferredRows.emplace_back(node, child.second, &inferredFsNodes.back());
+        inferredFsNodes.push_back(child->getScannedFSDetails());
+        inferredRows.emplace_back(node, child, &inferredFsNodes.back());
     }
     return true;
 }
@@ -7430,7 +7687,7 @@ bool Sync::recursiveSync(SyncRow& row, SyncPath& fullPath, bool belowRemovedClou
                                 cs.reserve(s->children.size());
                                 for (auto& i : s->children)
                                 {
-                                    cs.push_back(i.second);
+                                    cs.push_back(i);
                                 }
                                 // this technique might seem a bit roundabout, but deletion will cause these to
                                 // remove themselves from s->children. // we can't have that happening while we iterate that map.
@@ -7630,27 +7887,25 @@ bool Sync::recursiveSync(SyncRow& row, SyncPath& fullPath, bool belowRemovedClou
     // flags let us know if future actions are needed at this level
     for (auto& child : row.syncNode->children)
     {
-        assert(child.first == child.second->localname);
-
-        if (child.second->exclusionState() == ES_EXCLUDED)
+        if (child->exclusionState() == ES_EXCLUDED)
         {
             continue;
         }
 
-        if (child.second->type > FILENODE)
+        if (child->type > FILENODE)
         {
-            row.syncNode->scanAgain = updateTreestateFromChild(row.syncNode->scanAgain, child.second->scanAgain);
-            row.syncNode->syncAgain = updateTreestateFromChild(row.syncNode->syncAgain, child.second->syncAgain);
+            row.syncNode->scanAgain = updateTreestateFromChild(row.syncNode->scanAgain, child->scanAgain);
+            row.syncNode->syncAgain = updateTreestateFromChild(row.syncNode->syncAgain, child->syncAgain);
         }
-        row.syncNode->checkMovesAgain = updateTreestateFromChild(row.syncNode->checkMovesAgain, child.second->checkMovesAgain);
-        row.syncNode->conflicts = updateTreestateFromChild(row.syncNode->conflicts, child.second->conflicts);
+        row.syncNode->checkMovesAgain = updateTreestateFromChild(row.syncNode->checkMovesAgain, child->checkMovesAgain);
+        row.syncNode->conflicts = updateTreestateFromChild(row.syncNode->conflicts, child->conflicts);
 
-        if (child.second->parentSetScanAgain) row.syncNode->setScanAgain(false, true, false, 0);
-        if (child.second->parentSetCheckMovesAgain) row.syncNode->setCheckMovesAgain(false, true, false);
-        if (child.second->parentSetSyncAgain) row.syncNode->setSyncAgain(false, true, false);
-        if (child.second->parentSetContainsConflicts) row.syncNode->setContainsConflicts(false, true, false);
+        if (child->parentSetScanAgain) row.syncNode->setScanAgain(false, true, false, 0);
+        if (child->parentSetCheckMovesAgain) row.syncNode->setCheckMovesAgain(false, true, false);
+        if (child->parentSetSyncAgain) row.syncNode->setSyncAgain(false, true, false);
+        if (child->parentSetContainsConflicts) row.syncNode->setContainsConflicts(false, true, false);
 
-        child.second->parentSetScanAgain = false;  // we should only use this one once
+        child->parentSetScanAgain = false;  // we should only use this one once
     }
 
     // keep sync overlay icons up to date as we recurse (including the sync root node)
@@ -8104,7 +8359,7 @@ bool Sync::syncItem_checkDownloadCompletion(SyncRow& row, SyncRow& parentRow, Sy
                 // Make this new fsNode part of our sync data structure
                 parentRow.fsAddedSiblings.emplace_back(std::move(*fsNode));
                 row.fsNode = &parentRow.fsAddedSiblings.back();
-                row.syncNode->slocalname = row.fsNode->cloneShortname();
+                row.syncNode->setnameparent(row.syncNode->parent, row.syncNode->localname, row.fsNode->cloneShortname());
             }
             else
             {
@@ -8390,7 +8645,7 @@ bool Sync::syncItem(SyncRow& row, SyncRow& parentRow, SyncPath& fullPath, PerFol
                     cs.resize(s->children.size());
                     for (auto& i : s->children)
                     {
-                        cs.push_back(i.second);
+                        cs.push_back(i);
                     }
                     for (auto p : cs)
                     {
@@ -8823,9 +9078,9 @@ bool Sync::resolve_checkMoveComplete(SyncRow& row, SyncRow& parentRow, SyncPath&
         {
             for (auto& c : row.syncNode->children)
             {
-                if (c.first == oldc.first && c.second == oldc.second)
+                if (c->localname == oldc.first && c == oldc.second)
                 {
-                    delete c.second; // removes itself from the parent map
+                    delete c; // removes itself from the parent map
                     break;
                 }
             }
@@ -9677,8 +9932,8 @@ bool Sync::resolve_downsync(SyncRow& row, SyncRow& parentRow, SyncPath& fullPath
                     syncs.setSyncedFsidReused(fsfp(), fsnode->fsid);
                     syncs.setScannedFsidReused(fsfp(), fsnode->fsid);
 
-                    row.syncNode->localname = fsnode->localname;
-                    row.syncNode->slocalname = fsnode->cloneShortname();
+                    // keep the parent's child vectors ordered
+                    row.syncNode->setnameparent(row.syncNode->parent, fsnode->localname, fsnode->cloneShortname());
 
 					// setting synced variables here means we can skip a scan of the parent folder, if just the one expected notification arrives for it
                     row.syncNode->setSyncedNodeHandle(row.cloudNode->handle);
@@ -11718,6 +11973,7 @@ void Syncs::syncLoop()
     std::unique_lock<std::mutex> dummy_lock(dummy_mutex);
 
     unsigned lastRecurseMs = 0;
+    unsigned fullPassIntervalDs = 0;
     bool lastLoopEarlyExit = false;
 
     for (;;)
@@ -11736,6 +11992,13 @@ void Syncs::syncLoop()
         if (!skipWait)
         {
             auto waitDs = 10 + std::min<unsigned>(lastRecurseMs, 10000)/200;
+
+            // Folders marked by notifications are visited without the usual delay.
+            if (isAnySyncTargeted_inThread())
+            {
+                waitDs = 1;
+            }
+
             if (mClient.statecurrent && waitDs != 10)
             {
                 LOG_verbose << "starting sync wait, delay " << waitDs;
@@ -11954,6 +12217,15 @@ void Syncs::syncLoop()
         // Clear the context if the associated sync is no longer active.
         mIgnoreFileFailureContext.reset(*this);
 
+        // Sync folders marked by notifications straight away.  Full passes
+        // from each localroot still run at their usual pace, as a safety net.
+        if (!lastLoopEarlyExit &&
+            recursiveSyncTargetedFolders_inThread() &&
+            waiter->ds < mSyncFlags->recursiveSyncLastCompletedDs + fullPassIntervalDs)
+        {
+            continue;
+        }
+
         if (syncStallState &&
             (waiter->ds < mSyncFlags->recursiveSyncLastCompletedDs + 10) &&
             (waiter->ds > mSyncFlags->recursiveSyncLastCompletedDs) &&
@@ -12146,6 +12418,7 @@ void Syncs::syncLoop()
 #endif
         lastRecurseMs = unsigned(std::chrono::duration_cast<std::chrono::milliseconds>(
                         std::chrono::high_resolution_clock::now() - recurseStart).count());
+        fullPassIntervalDs = 10 + std::min<unsigned>(lastRecurseMs, 10000)/200;
 
         const int noProgressCountLoggingFrequency = 500; // Log this every 500 counts
         if (!skippedForScanning && !earlyExit && mSyncFlags->noProgressCount && (mSyncFlags->noProgressCount % noProgressCountLoggingFrequency == 0))
@@ -12253,6 +12526,91 @@ bool Syncs::isAnySyncScanning_inThread() const
     return false;
 }
 
+bool Syncs::isAnySyncTargeted_inThread() const
+{
+    assert(onSyncThread());
+
+    lock_guard<std::recursive_mutex> guard(mSyncVecMutex);
+
+    for (auto& us : mSyncVec)
+    {
+        if (Sync* sync = us->mSync.get())
+        {
+            if (!sync->mTargetedFolders.empty())
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Syncs::recursiveSyncTargetedFolders_inThread()
+{
+    assert(onSyncThread());
+
+    lock_guard<std::recursive_mutex> guard(mSyncVecMutex);
+
+    // Subtrees can only be synced on their own once the engine is steady.
+    bool steady = !mSyncFlags->isInitialPass
+                  && mSyncFlags->scanningWasComplete
+                  && mSyncFlags->movesWereComplete
+                  && !syncStallState;
+
+    bool visited = false;
+
+    // Stalls are assessed, and the collected entries reset, after each full
+    // pass.  Collect this pass's entries separately so they can't leak into
+    // the next full pass's report after they've been resolved.
+    auto stall = std::move(mSyncFlags->stall);
+
+    mSyncFlags->stall.clear();
+
+    for (auto& us : mSyncVec)
+    {
+        Sync* sync = us->mSync.get();
+
+        if (!sync)
+        {
+            continue;
+        }
+
+        if (!steady || us->mConfig.mError)
+        {
+            // The next full pass will visit these folders.
+            sync->mTargetedFolders.clear();
+            continue;
+        }
+
+        if (sync->recursiveSyncTargetedFolders())
+        {
+            visited = true;
+        }
+    }
+
+    bool stalled = !mSyncFlags->stall.empty();
+
+    mSyncFlags->stall = std::move(stall);
+
+    if (!stalled)
+    {
+        return visited;
+    }
+
+    // Let a full pass find and report whatever is stalling us.
+    LOG_debug << "Targeted sync ran into a stall, falling back to a full pass";
+
+    for (auto& us : mSyncVec)
+    {
+        if (Sync* sync = us->mSync.get())
+        {
+            sync->mTargetedFolders.clear();
+        }
+    }
+
+    return false;
+}
+
 bool Syncs::checkSyncsScanningWasComplete_inThread()
 {
     assert(onSyncThread());
@@ -12665,11 +13023,11 @@ void Syncs::proclocaltree(LocalNode* n, LocalTreeProc* tp)
 
     if (n->type > FILENODE)
     {
-        for (localnode_map::iterator it = n->children.begin(); it != n->children.end(); )
+        // Processing a child may remove it from our children.
+        vector<LocalNode*> children(n->children.begin(), n->children.end());
+
+        for (LocalNode* child : children)
         {
-            assert(it->first == it->second->localname);
-            LocalNode *child = it->second;
-            it++;
             proclocaltree(child, tp);
         }
     }
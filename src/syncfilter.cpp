@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cstdint>
@@ -6,6 +7,8 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "mega/filesystem.h"
 #include "mega/logging.h"
@@ -16,6 +19,7 @@ namespace mega
 {
 
 class Matcher;
+class Subject;
 class Target;
 
 // For convenience.
@@ -55,8 +59,14 @@ public:
     // it was defined?
     bool inheritable() const;
 
-    // True if this filter matches the string pair p.
-    virtual bool match(const RemotePathPair& p) const = 0;
+    // True if this filter matches against paths rather than names.
+    virtual bool matchesPaths() const = 0;
+
+    // True if this filter matches the specified name or path.
+    bool match(const Subject& name, const Subject& path) const;
+
+    // What matcher does this filter use?
+    const Matcher& matcher() const;
 
     virtual string debugDescription() const = 0;
 
@@ -66,9 +76,6 @@ protected:
                  const bool inclusion,
                  const bool inheritable);
 
-    // True if this filter matches the string s.
-    bool match(const string& s) const;
-
 protected:
     MatcherPtr mMatcher;
     const Target& mTarget;
@@ -85,7 +92,7 @@ public:
                const bool inclusion,
                const bool inheritable);
 
-    bool match(const RemotePathPair& p) const override;
+    bool matchesPaths() const override;
 
     string debugDescription() const override;
 }; /* NameFilter */
@@ -99,7 +106,7 @@ public:
                const bool inclusion,
                const bool inheritable);
 
-    bool match(const RemotePathPair& p) const override;
+    bool matchesPaths() const override;
 
     string debugDescription() const override;
 }; /* PathFilter */
@@ -109,8 +116,17 @@ class Matcher
 public:
     virtual ~Matcher() = default;
 
+    // True if this matcher is case sensitive.
+    virtual bool caseSensitive() const = 0;
+
+    // True if this matcher can be replaced by a table lookup.
+    //
+    // If so, key is the string that must be looked up and suffix
+    // specifies whether key must match the end of a string or all of it.
+    virtual bool indexable(std::string_view& key, bool& suffix) const;
+
     // True if this matcher matches the string s.
-    virtual bool match(const string& s) const = 0;
+    virtual bool match(const Subject& s) const = 0;
 
     virtual string debugDescription() const = 0;
 
@@ -124,8 +140,13 @@ class GlobMatcher
 public:
     GlobMatcher(const string& pattern, bool caseSensitive);
 
+    bool caseSensitive() const override;
+
+    // True if the pattern is a literal or a literal preceded by '*'.
+    bool indexable(std::string_view& key, bool& suffix) const override;
+
     // True if the wildcard pattern matches the string s.
-    bool match(const string& s) const override;
+    bool match(const Subject& s) const override;
 
     string debugDescription() const override;
 
@@ -140,8 +161,10 @@ class RegexMatcher
 public:
     RegexMatcher(const string& pattern, bool caseSensitive);
 
+    bool caseSensitive() const override;
+
     // True if the regex pattern matches the string s.
-    bool match(const string& s) const override;
+    bool match(const Subject& s) const override;
 
     string debugDescription() const override;
 
@@ -151,6 +174,86 @@ private:
     bool mCaseSensitive;
 }; /* RegexMatcher */
 
+// A string that's being matched against a chain's filters.
+class Subject
+{
+public:
+    explicit Subject(const string& text);
+
+    // The string as specified by the caller.
+    const string& text() const;
+
+    // The string in uppercase.
+    //
+    // Computed once, on first use, rather than once per filter.
+    const string& upper() const;
+
+private:
+    const string& mText;
+    mutable string mUpper;
+    mutable bool mUpperComputed;
+}; /* Subject */
+
+// Compiled form of a chain's string filters.
+//
+// Literal and suffix globs ("name", "*.ext") are resolved by table
+// lookups while all other filters are evaluated as before. The filter
+// that's reported as matching is always the last in the chain that
+// matches, exactly as if each filter had been tested in reverse order.
+class StringFilterIndex
+{
+public:
+    StringFilterIndex(const StringFilterPtrVector& filters,
+                      const bool onlyInheritable);
+
+    // Attempts to locate a match for the specified name and path.
+    ExclusionState match(const Subject& name,
+                         const Subject& path,
+                         const nodetype_t type) const;
+
+private:
+    // Positions of filters in mFilters, in ascending order.
+    using PositionVector = vector<std::size_t>;
+    using PositionMap = std::unordered_map<std::string_view, PositionVector>;
+
+    struct Table
+    {
+        // True if this table contains no filters.
+        bool empty() const;
+
+        // Filters whose pattern must match the entire string.
+        PositionMap mLiterals;
+
+        // Filters whose pattern must match the end of the string.
+        PositionMap mSuffixes;
+
+        // Distinct lengths of the keys in mSuffixes.
+        vector<std::size_t> mSuffixLengths;
+    }; // Table
+
+    // Search candidates for a filter applicable to type.
+    //
+    // best is the position of the best match so far, plus one.
+    void match(const PositionVector& candidates,
+               const nodetype_t type,
+               std::size_t& best) const;
+
+    // Search a table for a filter matching subject.
+    void match(const Table& table,
+               const string& subject,
+               const nodetype_t type,
+               std::size_t& best) const;
+
+    // The filters that we've indexed.
+    StringFilterPtrVector mFilters;
+
+    // Lookup tables, by [matches paths][case sensitive].
+    Table mTables[2][2];
+
+    // Filters that can't be resolved by a table lookup.
+    PositionVector mUnindexed;
+}; /* StringFilterIndex */
+
 class Target
 {
 public:
@@ -522,6 +625,8 @@ void FilterChain::clear()
     mFingerprint = FileFingerprint();
     mSizeFilter.reset();
     mStringFilters.clear();
+    mStringFilterIndex[0].reset();
+    mStringFilterIndex[1].reset();
 }
 
 FilterLoadResult FilterChain::load(FileSystemAccess& fsAccess, const LocalPath& path)
@@ -574,6 +679,11 @@ FilterLoadResult FilterChain::load(FileAccess& fileAccess)
         return FLR_FAILED;
     }
 
+    return load(lines);
+}
+
+FilterLoadResult FilterChain::load(const string_vector& lines)
+{
     // Temporay storage for newly loaded filters.
     StringFilterPtrVector stringFilters;
     SizeFilterPtr sizeFilter;
@@ -617,8 +727,14 @@ FilterLoadResult FilterChain::load(FileAccess& fileAccess)
         }
     }
 
+    // Compile the new filters.
+    auto stringFilterIndex = std::make_shared<StringFilterIndex>(stringFilters, false);
+    auto inheritableFilterIndex = std::make_shared<StringFilterIndex>(stringFilters, true);
+
     // Move new filters into place.
     mStringFilters = std::move(stringFilters);
+    mStringFilterIndex[0] = std::move(stringFilterIndex);
+    mStringFilterIndex[1] = std::move(inheritableFilterIndex);
     mSizeFilter = std::move(sizeFilter);
 
     LOG_info << "New exclusion rules from file are as follows";
@@ -642,23 +758,16 @@ ExclusionState FilterChain::match(const RemotePathPair& p,
 {
     if (!mLoadSucceeded) return ES_UNKNOWN;
 
-    auto i = mStringFilters.rbegin();
-    auto j = mStringFilters.rend();
+    // Which index should we consult?
+    auto& index = mStringFilterIndex[onlyInheritable];
 
-    for ( ; i != j; ++i)
+    // Can't match if we have no filters.
+    if (!index)
     {
-        if (onlyInheritable && !(*i)->inheritable())
-        {
-            continue;
-        }
-
-        if ((*i)->applicable(type) && (*i)->match(p))
-        {
-            return (*i)->inclusion() ? ES_INCLUDED : ES_EXCLUDED;
-        }
+        return ES_UNMATCHED;
     }
 
-    return ES_UNMATCHED;
+    return index->match(Subject(p.first), Subject(p.second), type);
 }
 
 ExclusionState FilterChain::match(const m_off_t s) const
@@ -763,9 +872,14 @@ StringFilter::StringFilter(MatcherPtr matcher,
 {
 }
 
-bool StringFilter::match(const string& s) const
+bool StringFilter::match(const Subject& name, const Subject& path) const
 {
-    return mMatcher->match(s);
+    return mMatcher->match(matchesPaths() ? path : name);
+}
+
+const Matcher& StringFilter::matcher() const
+{
+    return *mMatcher;
 }
 
 NameFilter::NameFilter(MatcherPtr matcher,
@@ -779,9 +893,9 @@ NameFilter::NameFilter(MatcherPtr matcher,
 {
 }
 
-bool NameFilter::match(const RemotePathPair& p) const
+bool NameFilter::matchesPaths() const
 {
-    return StringFilter::match(p.first);
+    return false;
 }
 
 string NameFilter::debugDescription() const
@@ -803,9 +917,9 @@ PathFilter::PathFilter(MatcherPtr matcher,
 {
 }
 
-bool PathFilter::match(const RemotePathPair& p) const
+bool PathFilter::matchesPaths() const
 {
-    return StringFilter::match(p.second);
+    return true;
 }
 
 string PathFilter::debugDescription() const
@@ -822,14 +936,51 @@ GlobMatcher::GlobMatcher(const string &pattern, const bool caseSensitive)
 {
 }
 
-bool GlobMatcher::match(const string& s) const
+bool Matcher::indexable(std::string_view&, bool&) const
+{
+    return false;
+}
+
+bool GlobMatcher::caseSensitive() const
+{
+    return mCaseSensitive;
+}
+
+bool GlobMatcher::indexable(std::string_view& key, bool& suffix) const
+{
+    // Where is the first wildcard in the pattern?
+    auto i = mPattern.find_first_of("*?");
+
+    // Pattern's a plain literal.
+    if (i == string::npos)
+    {
+        key = mPattern;
+        suffix = false;
+        return true;
+    }
+
+    // Pattern must be a literal preceded by a single '*'.
+    if (i != 0 || mPattern[0] != '*' || mPattern.size() < 2)
+        return false;
+
+    // Pattern contains more than one wildcard.
+    if (mPattern.find_first_of("*?", 1) != string::npos)
+        return false;
+
+    key = std::string_view(mPattern).substr(1);
+    suffix = true;
+
+    return true;
+}
+
+bool GlobMatcher::match(const Subject& s) const
 {
     if (mCaseSensitive)
     {
-        return wildcardMatch(s, mPattern);
+        return wildcardMatch(s.text(), mPattern);
     }
 
-    return wildcardMatch(toUpper(s), mPattern);
+    return wildcardMatch(s.upper(), mPattern);
 }
 
 string GlobMatcher::debugDescription() const
@@ -849,9 +1000,14 @@ RegexMatcher::RegexMatcher(const string& pattern, const bool caseSensitive)
 {
 }
 
-bool RegexMatcher::match(const string& s) const
+bool RegexMatcher::caseSensitive() const
+{
+    return mCaseSensitive;
+}
+
+bool RegexMatcher::match(const Subject& s) const
 {
-    return std::regex_match(s, mRegexp);
+    return std::regex_match(s.text(), mRegexp);
 }
 
 string RegexMatcher::debugDescription() const
@@ -864,6 +1020,183 @@ string RegexMatcher::debugDescription() const
     return s;
 }
 
+Subject::Subject(const string& text)
+  : mText(text)
+  , mUpper()
+  , mUpperComputed(false)
+{
+}
+
+const string& Subject::text() const
+{
+    return mText;
+}
+
+const string& Subject::upper() const
+{
+    if (!mUpperComputed)
+    {
+        mUpper = toUpper(mText);
+        mUpperComputed = true;
+    }
+
+    return mUpper;
+}
+
+bool StringFilterIndex::Table::empty() const
+{
+    return mLiterals.empty() && mSuffixes.empty();
+}
+
+StringFilterIndex::StringFilterIndex(const StringFilterPtrVector& filters,
+                                     const bool onlyInheritable)
+  : mFilters(filters)
+  , mTables()
+  , mUnindexed()
+{
+    for (std::size_t i = 0; i < mFilters.size(); ++i)
+    {
+        auto& filter = *mFilters[i];
+
+        // Filter can never be considered by this index.
+        if (onlyInheritable && !filter.inheritable())
+            continue;
+
+        auto& matcher = filter.matcher();
+
+        std::string_view key;
+        bool suffix = false;
+
+        // Filter must be evaluated the hard way.
+        if (!matcher.indexable(key, suffix))
+        {
+            mUnindexed.emplace_back(i);
+            continue;
+        }
+
+        auto& table = mTables[filter.matchesPaths()][matcher.caseSensitive()];
+
+        // Filter must match the entire string.
+        if (!suffix)
+        {
+            table.mLiterals[key].emplace_back(i);
+            continue;
+        }
+
+        // Filter must match the end of the string.
+        auto& positions = table.mSuffixes[key];
+
+        // Remember that we need to consider suffixes of this length.
+        if (positions.empty())
+            table.mSuffixLengths.emplace_back(key.size());
+
+        positions.emplace_back(i);
+    }
+
+    // Suffix lengths need only be considered once.
+    for (auto& row : mTables)
+    {
+        for (auto& table : row)
+        {
+            auto& lengths = table.mSuffixLengths;
+
+            std::sort(lengths.begin(), lengths.end());
+
+            lengths.erase(std::unique(lengths.begin(), lengths.end()),
+                          lengths.end());
+        }
+    }
+}
+
+ExclusionState StringFilterIndex::match(const Subject& name,
+                                        const Subject& path,
+                                        const nodetype_t type) const
+{
+    // Position of the last matching filter, plus one.
+    std::size_t best = 0;
+
+    // Consult the lookup tables.
+    for (auto matchesPaths : {false, true})
+    {
+        auto& subject = matchesPaths ? path : name;
+        auto& row = mTables[matchesPaths];
+
+        if (!row[true].empty())
+            match(row[true], subject.text(), type, best);
+
+        if (!row[false].empty())
+            match(row[false], subject.upper(), type, best);
+    }
+
+    // Evaluate any filters that might have been defined after best.
+    for (auto i = mUnindexed.rbegin(); i != mUnindexed.rend(); ++i)
+    {
+        // No remaining filter can take precedence over best.
+        if (*i < best)
+            break;
+
+        auto& filter = *mFilters[*i];
+
+        if (filter.applicable(type) && filter.match(name, path))
+        {
+            best = *i + 1;
+            break;
+        }
+    }
+
+    // No filter matched.
+    if (!best)
+        return ES_UNMATCHED;
+
+    return mFilters[best - 1]->inclusion() ? ES_INCLUDED : ES_EXCLUDED;
+}
+
+void StringFilterIndex::match(const PositionVector& candidates,
+                              const nodetype_t type,
+                              std::size_t& best) const
+{
+    // Later filters take precedence.
+    for (auto i = candidates.rbegin(); i != candidates.rend(); ++i)
+    {
+        // No remaining candidate can take precedence over best.
+        if (*i < best)
+            break;
+
+        if (mFilters[*i]->applicable(type))
+        {
+            best = *i + 1;
+            break;
+        }
+    }
+}
+
+void StringFilterIndex::match(const Table& table,
+                              const string& subject,
+                              const nodetype_t type,
+                              std::size_t& best) const
+{
+    std::string_view view(subject);
+
+    // Is there a literal that matches the entire subject?
+    auto i = table.mLiterals.find(view);
+
+    if (i != table.mLiterals.end())
+        match(i->second, type, best);
+
+    // Is there a literal that matches the end of the subject?
+    for (auto length : table.mSuffixLengths)
+    {
+        // Remaining suffixes are too long to match.
+        if (length > view.size())
+            break;
+
+        auto j = table.mSuffixes.find(view.substr(view.size() - length));
+
+        if (j != table.mSuffixes.end())
+            match(j->second, type, best);
+    }
+}
+
 bool AllTarget::applicable(const nodetype_t) const
 {
     return true;
@@ -101,6 +101,19 @@ Transfer::~Transfer()
         client->fileAttributesUploading.erase(uploadhandle);
     }
 
+    // write out any progress we held back, unless the record is about to go
+    if (client->dirtytransfers.count(this))
+    {
+        if (finished)
+        {
+            client->dirtytransfers.erase(this);
+        }
+        else
+        {
+            client->transfercacheadd(this, committer);
+        }
+    }
+
     for (file_list::iterator it = files.begin(); it != files.end(); it++)
     {
         if (finished)
@@ -585,17 +598,17 @@ void Transfer::addAnyMissingMediaFileAttributes(Node* node, /*const*/ LocalPath&
             // if we don't have the codec id mappings yet, send the request
             client->mediaFileInfo.requestCodecMappingsOneTime(client, LocalPath());
 
-            // always get the attribute string; it may indicate this version of the mediaInfo library was unable to interpret the file
-            MediaProperties vp;
-            vp.extractMediaPropertyFileAttributes(localpath, client->fsaccess.get());
-
+            // always get the attribute string; it may indicate this version of the mediaInfo library was unable to interpret the file.
+            // Opening the file can take seconds, so it's examined on a worker thread and the attribute attached once it's available.
             if (type == PUT)
             {
-                client->mediaFileInfo.queueMediaPropertiesFileAttributesForUpload(vp, attrKey, client, uploadhandle, this);
+                // hold the upload's putnodes until the attribute arrives
+                client->fileAttributesUploading.setFileAttributePending(uploadhandle, fatype(fa_media), this);
+                client->mediaFileInfo.queueMediaPropertiesExtraction(client, localpath, NodeOrUploadHandle(uploadhandle), attrKey);
             }
             else
             {
-                client->mediaFileInfo.sendOrQueueMediaPropertiesFileAttributesForExistingFile(vp, attrKey, client, node->nodeHandle());
+                client->mediaFileInfo.queueMediaPropertiesExtraction(client, localpath, NodeOrUploadHandle(node->nodeHandle()), attrKey);
             }
         }
     }
@@ -1149,6 +1162,15 @@ void DirectReadNode::dispatch()
         schedule(DirectReadSlot::TIMEOUT_DS);
         if (!pendingcmd)
         {
+            if (client->drUrlCache.get(h, tempurls, size))
+            {
+                LOG_debug << "Reusing cached temporary URLs for DirectReadNode" << " [this = " << this << "]";
+                ++client->performanceStats.directReadUrlCacheHits;
+                cmdresult(API_OK);
+                return;
+            }
+
+            ++client->performanceStats.directReadUrlCacheMisses;
             pendingcmd = new CommandDirectRead(client, this);
             client->reqs.add(pendingcmd);
         }
@@ -1228,6 +1250,12 @@ void DirectReadNode::retry(const Error& e, dstime timeleft)
         minretryds = NEVER;
     }
 
+    if (e)
+    {
+        // the URLs may be the reason for the failure
+        client->drUrlCache.invalidate(h);
+    }
+
     tempurls.clear();
 
     if (!e || !minretryds)
@@ -1287,6 +1315,75 @@ void DirectReadNode::cmdresult(const Error &e, dstime timeleft)
     }
 }
 
+bool DirectReadUrlCache::get(handle h, std::vector<std::string>& tempurls, m_off_t& size)
+{
+    auto it = mEntries.find(h);
+
+    if (it == mEntries.end())
+    {
+        return false;
+    }
+
+    if (Waiter::ds - it->second.obtained >= MAX_AGE_DS)
+    {
+        invalidate(h);
+        return false;
+    }
+
+    mLRU.splice(mLRU.end(), mLRU, it->second.lru);
+
+    tempurls = it->second.tempurls;
+    size = it->second.size;
+
+    return true;
+}
+
+void DirectReadUrlCache::put(handle h, const std::vector<std::string>& tempurls, m_off_t size)
+{
+    auto result = mEntries.emplace(h, Entry());
+    auto& entry = result.first->second;
+
+    if (result.second)
+    {
+        entry.lru = mLRU.insert(mLRU.end(), h);
+    }
+    else
+    {
+        mLRU.splice(mLRU.end(), mLRU, entry.lru);
+    }
+
+    entry.tempurls = tempurls;
+    entry.size = size;
+    entry.obtained = Waiter::ds;
+
+    if (mEntries.size() > MAX_ENTRIES)
+    {
+        invalidate(mLRU.front());
+    }
+}
+
+void DirectReadUrlCache::invalidate(handle h)
+{
+    auto it = mEntries.find(h);
+
+    if (it != mEntries.end())
+    {
+        mLRU.erase(it->second.lru);
+        mEntries.erase(it);
+    }
+}
+
+void DirectReadUrlCache::clear()
+{
+    mEntries.clear();
+    mLRU.clear();
+}
+
+size_t DirectReadUrlCache::size() const
+{
+    return mEntries.size();
+}
+
 void DirectReadNode::schedule(dstime deltads)
 {
     WAIT_CLASS::bumpds();
@@ -1330,6 +1427,16 @@ bool DirectReadSlot::processAnyOutputPieces()
             LOG_verbose << "DirectReadSlot -> Delivering assembled part ->"
                         << "len = " << len << ", speed = " << mSpeed << ", meanSpeed = " << (mMeanSpeed / 1024) << " KB/s"
                         << ", slotThroughput = " << ((calcThroughput(mSlotThroughput.first, mSlotThroughput.second) * 1000) / 1024) << " KB/s]" << " [this = " << this << "]";
+            if (!mDr->delivered)
+            {
+                auto& stats = mDr->drn->client->performanceStats;
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mDr->queuedAt).count();
+
+                LOG_debug << "DirectReadSlot -> Time to first byte: " << elapsed << " ms" << " [this = " << this << "]";
+                stats.directReadFirstByteMs += static_cast<uint64_t>(elapsed);
+                ++stats.directReadFirstBytes;
+                mDr->delivered = true;
+            }
             continueDirectRead = mDr->drn->client->app->pread_data(outputPiece->buf.datastart(), len, mPos, mSpeed, mMeanSpeed, mDr->appdata);
         }
         else
@@ -2032,10 +2139,17 @@ void TransferList::addtransfer(Transfer *transfer, TransferDbCommitter& committe
         assert(it == transfers[transfer->type].end() || it->transfer->priority != transfer->priority);
         transfers[transfer->type].insert(it, transfer);
     }
+
+    if (transfer->state != TRANSFERSTATE_PAUSED)
+    {
+        enqueueReady(transfer);
+    }
 }
 
 void TransferList::removetransfer(Transfer *transfer)
 {
+    dequeueReady(transfer);
+
     transfer_list::iterator it;
     if (getIterator(transfer, it, true))
     {
@@ -2104,6 +2218,7 @@ void TransferList::movetransfer(transfer_list::iterator it, transfer_list::itera
         transfers[transfer->type].erase(it);
         currentpriority += PRIORITY_STEP;
         transfer->priority = currentpriority;
+        reprioritizeReady(transfer);
         assert(!transfers[transfer->type].size() || transfers[transfer->type][transfers[transfer->type].size() - 1]->priority < transfer->priority);
         transfers[transfer->type].push_back(transfer);
         client->transfercacheadd(transfer, &committer);
@@ -2134,22 +2249,12 @@ void TransferList::movetransfer(transfer_list::iterator it, transfer_list::itera
     if (prevpriority == newpriority)
     {
         LOG_warn << "There is no space for the move. Adjusting priorities.";
-        int positions = dstindex;
-        uint64_t fixedPriority = transfers[transfer->type][0]->priority - PRIORITY_STEP * (positions + 1);
-        for (int i = 0; i < positions; i++)
-        {
-            Transfer *t = transfers[transfer->type][i];
-            LOG_debug << "Adjusting priority of transfer " << i << " to " << fixedPriority;
-            t->priority = fixedPriority;
-            client->transfercacheadd(t, &committer);
-            client->app->transfer_update(t);
-            fixedPriority += PRIORITY_STEP;
-        }
-        newpriority = fixedPriority;
-        LOG_debug << "Fixed priority: " << fixedPriority;
+        newpriority = makeRoom(transfer->type, size_t(srcindex), size_t(dstindex), committer);
+        LOG_debug << "Fixed priority: " << newpriority;
     }
 
     transfer->priority = newpriority;
+    reprioritizeReady(transfer);
     if (srcindex > dstindex)
     {
         prepareIncreasePriority(transfer, it, dstit, committer);
@@ -2259,6 +2364,7 @@ error TransferList::pause(Transfer *transfer, bool enable, TransferDbCommitter&
     if (!enable)
     {
         transfer->state = TRANSFERSTATE_QUEUED;
+        enqueueReady(transfer);
 
         transfer_list::iterator it;
         if (getIterator(transfer, it))
@@ -2285,6 +2391,7 @@ error TransferList::pause(Transfer *transfer, bool enable, TransferDbCommitter&
             transfer->slot = NULL;
         }
         transfer->state = TRANSFERSTATE_PAUSED;
+        dequeueReady(transfer);
         client->transfercacheadd(transfer, &committer);
         client->app->transfer_update(transfer);
         return API_OK;
@@ -2337,8 +2444,24 @@ std::array<vector<Transfer*>, 6> TransferList::nexttransfers(std::function<bool(
 
     for (direction_t direction : putget)
     {
-        for (Transfer *transfer : transfers[direction])
+        wakeBackedOff(direction, Waiter::ds);
+
+        // Walk both size categories together, in priority order.
+        // Once a category has all it's going to get, we stop walking it.
+        auto& large = mReady[TransferCategory(direction, LARGEFILE).index()];
+        auto& small = mReady[TransferCategory(direction, SMALLFILE).index()];
+
+        auto largeIt = large.begin();
+        auto smallIt = small.begin();
+
+        while (largeIt != large.end() || smallIt != small.end())
         {
+            bool fromLarge = smallIt == small.end()
+                             || (largeIt != large.end() && *largeIt < *smallIt);
+
+            auto& it = fromLarge ? largeIt : smallIt;
+            Transfer* transfer = (it++)->second;  // advance first, the entry may be removed below
+
             if (!transfer->slot)
             {
                 // check for cancellation here before we go to the trouble of requesting a download/upload URL
@@ -2353,8 +2476,22 @@ std::array<vector<Transfer*>, 6> TransferList::nexttransfers(std::function<bool(
             // don't traverse the whole list if we already have as many as we are going to get
             if (!directionContinuefunction(direction)) break;
 
-            bool continueLarge = true;
-            bool continueSmall = true;
+            if (!transfer->slot)
+            {
+                if (transfer->state == TRANSFERSTATE_PAUSED)
+                {
+                    // back in the queue when resumed
+                    dequeueReady(transfer);
+                    continue;
+                }
+
+                if (!transfer->bt.armed())
+                {
+                    // back in the queue when the backoff expires
+                    backOff(transfer);
+                    continue;
+                }
+            }
 
             if ((!transfer->slot && isReady(transfer))
                 || (transfer->asyncopencontext
@@ -2362,25 +2499,17 @@ std::array<vector<Transfer*>, 6> TransferList::nexttransfers(std::function<bool(
             {
                 TransferCategory tc(transfer);
 
-                if (tc.sizetype == LARGEFILE && continueLarge)
+                if (continuefunction(transfer))
                 {
-                    continueLarge = continuefunction(transfer);
-                    if (continueLarge)
-                    {
-                        chosenTransfers[tc.index()].push_back(transfer);
-                    }
+                    chosenTransfers[tc.index()].push_back(transfer);
                 }
-                else if (tc.sizetype == SMALLFILE && continueSmall)
+                else if (fromLarge)
                 {
-                    continueSmall = continuefunction(transfer);
-                    if (continueSmall)
-                    {
-                        chosenTransfers[tc.index()].push_back(transfer);
-                    }
+                    largeIt = large.end();
                 }
-                if (!continueLarge && !continueSmall)
+                else
                 {
-                    break;
+                    smallIt = small.end();
                 }
             }
         }
@@ -2465,10 +2594,156 @@ void TransferList::prepareDecreasePriority(Transfer *transfer, transfer_list::it
     }
 }
 
+uint64_t TransferList::makeRoom(direction_t direction, size_t srcindex, size_t dstindex, TransferDbCommitter& committer)
+{
+    auto& list = transfers[direction];
+    size_t count = list.size();
+
+    assert(dstindex < count);
+
+    // Widen a window around the destination until the priorities within it can be
+    // spread out evenly, leaving room for further moves.  Only the transfers
+    // in that window are renumbered, so this is rare and cheap on average.
+    // Past either end of the list there is always room, so we will find one.
+    for (size_t width = 2; ; width *= 2)
+    {
+        size_t lo = dstindex > width / 2 ? dstindex - width / 2 : 0;
+        size_t hi = std::min(count, dstindex + width / 2);
+
+        uint64_t lower = lo ? list[lo - 1]->priority
+                            : list[0]->priority - PRIORITY_STEP * (width + 1);
+        uint64_t upper = hi < count ? list[hi]->priority
+                                    : std::max(currentpriority, list[count - 1]->priority) + PRIORITY_STEP * (width + 1);
+
+        // the window's transfers, less the one being moved, plus its new place
+        size_t slots = hi - lo + 1 - (srcindex >= lo && srcindex < hi);
+        uint64_t spacing = (upper - lower) / (slots + 1);
+
+        if (spacing < PRIORITY_MIN_SPACING)
+        {
+            continue;
+        }
+
+        LOG_debug << "Spreading the priorities of " << slots - 1 << " transfer(s) around position " << dstindex;
+
+        uint64_t priority = lower;
+        uint64_t newpriority = 0;
+
+        for (size_t i = lo; i < hi; ++i)
+        {
+            if (i == dstindex)
+            {
+                priority += spacing;
+                newpriority = priority;
+            }
+
+            if (i == srcindex)
+            {
+                continue;
+            }
+
+            priority += spacing;
+
+            Transfer* t = list[i];
+            t->priority = priority;
+            reprioritizeReady(t);
+            client->transfercacheadd(t, &committer);
+            client->app->transfer_update(t);
+        }
+
+        currentpriority = std::max(currentpriority, priority);
+
+        assert(newpriority);
+        return newpriority;
+    }
+}
+
 bool TransferList::isReady(Transfer *transfer)
 {
     return ((transfer->state == TRANSFERSTATE_QUEUED || transfer->state == TRANSFERSTATE_RETRYING)
             && transfer->bt.armed());
 }
 
+void TransferList::backoffsAborted(direction_t direction)
+{
+    wakeBackedOff(direction, NEVER);
+}
+
+void TransferList::clear()
+{
+    for (auto& list : transfers)
+    {
+        list.clear();
+    }
+
+    for (auto& queue : mReady)
+    {
+        queue.clear();
+    }
+
+    for (auto& waiting : mBackingOff)
+    {
+        waiting.clear();
+    }
+}
+
+void TransferList::enqueueReady(Transfer* transfer)
+{
+    dequeueReady(transfer);
+
+    auto& position = transfer->readyPosition;
+
+    position.queued = true;
+    position.category = TransferCategory(transfer).index();
+    position.priority = transfer->priority;
+
+    mReady[position.category].emplace(position.priority, transfer);
+}
+
+void TransferList::dequeueReady(Transfer* transfer)
+{
+    auto& position = transfer->readyPosition;
+
+    if (position.queued)
+    {
+        mReady[position.category].erase(std::make_pair(position.priority, transfer));
+        position.queued = false;
+    }
+
+    if (position.backingOff)
+    {
+        mBackingOff[transfer->type].erase(position.wakeup);
+        position.backingOff = false;
+    }
+}
+
+void TransferList::backOff(Transfer* transfer)
+{
+    dequeueReady(transfer);
+
+    auto& position = transfer->readyPosition;
+
+    position.backingOff = true;
+    position.wakeup = mBackingOff[transfer->type].emplace(transfer->bt.nextset(), transfer);
+}
+
+void TransferList::wakeBackedOff(direction_t direction, dstime now)
+{
+    auto& waiting = mBackingOff[direction];
+
+    while (!waiting.empty() && waiting.begin()->first <= now)
+    {
+        // also removes it from waiting
+        enqueueReady(waiting.begin()->second);
+    }
+}
+
+void TransferList::reprioritizeReady(Transfer* transfer)
+{
+    if (transfer->readyPosition.queued)
+    {
+        enqueueReady(transfer);
+    }
+}
+
 } // namespace
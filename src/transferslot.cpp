@@ -73,6 +73,21 @@ const m_off_t TransferSlot::UPPER_FILESIZE_LIMIT_FOR_SMALLER_CHUNKS = 25 * 1024
 const m_off_t TransferSlot::MIN_FILESIZE_FOR_MULTIPLE_CONNECTIONS = 131072 + 1; // 128 KB + 1 -> legacy value
 const m_off_t TransferSlot::MAX_GAP_SIZE = 256 * 1024 * 1024; // 256 MB
 
+#if defined(__ANDROID__) || defined(USE_IOS)
+    const m_off_t TransferSlot::MAX_PIPELINE_SIZE = 8388608; // 8 MB
+#else
+    const m_off_t TransferSlot::MAX_PIPELINE_SIZE = 67108864; // 64 MB
+#endif
+
+#if defined(__ANDROID__) || defined(USE_IOS)
+    const m_off_t TransferSlot::MAX_PIPELINE_WRITE_SIZE = 2097152; // 2 MB
+#else
+    const m_off_t TransferSlot::MAX_PIPELINE_WRITE_SIZE = 16777216; // 16 MB
+#endif
+
+const unsigned TransferSlot::MAX_PIPELINE_WRITES = 4;
+const m_off_t TransferSlot::WRITEBACK_WINDOW = 67108864; // 64 MB
+
 TransferSlot::TransferSlot(Transfer* ctransfer)
     : fa(ctransfer->client->fsaccess->newfileaccess(), ctransfer)
     , retrybt(ctransfer->client->rng, ctransfer->client->transferSlotsBackoff)
@@ -180,30 +195,33 @@ TransferSlot::~TransferSlot()
     {
         bool cachetransfer = false; // need to save in cache
 
-        if (fa && fa->asyncavailable())
+        // finish the writes in flight from the pipeline
+        for (auto it = mPipeline.begin(); it != mPipeline.end(); )
         {
-            for (int i = 0; i < connections; i++)
+            auto& write = it->second->write;
+            if (!write)
             {
-                if (reqs[i] && reqs[i]->status == REQ_ASYNCIO && asyncIO[i])
-                {
-                    asyncIO[i]->finish();
-                    if (!asyncIO[i]->failed)
-                    {
-                        LOG_verbose << "[TransferSlot::~TransferSlot] Conn " << i << " : Async write succeeded (size: " << asyncIO[i]->dataBufferLen << ")";
-                        transferbuf.bufferWriteCompleted(i, true);
-                        cachetransfer = true;
-                    }
-                    else
-                    {
-                        LOG_verbose << "[TransferSlot::~TransferSlot] Conn " << i << " : Async write failed (size: " << asyncIO[i]->dataBufferLen << ")";
-                        transferbuf.bufferWriteCompleted(i, false);
-                    }
-                    reqs[i]->status = REQ_READY;
-                }
-                delete asyncIO[i];
-                asyncIO[i] = NULL;
+                ++it;
+                continue;
+            }
+
+            write->context->finish();
+            if (!write->context->failed)
+            {
+                LOG_verbose << "[TransferSlot::~TransferSlot] Async write succeeded at " << it->first << " (size: " << it->second->piece->buf.datalen() << ")";
+                it = retirePipelinedPiece(it, true);
+                cachetransfer = true;
+            }
+            else
+            {
+                LOG_verbose << "[TransferSlot::~TransferSlot] Async write failed at " << it->first << " (size: " << it->second->piece->buf.datalen() << ")";
+                write.reset();  // tried again synchronously below
+                ++it;
             }
+        }
 
+        if (fa && fa->asyncavailable())
+        {
             // Open the file in synchonous mode
             fa.reset(transfer->client->fsaccess->newfileaccess());
             if (!fa->fopen(transfer->localfilename, false, true, FSLogging::logOnError))
@@ -212,36 +230,48 @@ TransferSlot::~TransferSlot()
             }
         }
 
-        for (int i = 0; i < connections; i++)
+        // synchronous writes for the rest of the pipeline, once its pieces are decrypted.
+        // this comes first as pieces still on a connection may need the macs of these.
+        for (auto it = mPipeline.begin(); it != mPipeline.end(); )
         {
-            if (HttpReqDL *downloadRequest = static_cast<HttpReqDL*>(reqs[i].get()))
+            auto& entry = *it->second;
+            auto& piece = *entry.piece;
+
+            if (!entry.decrypted)
             {
-                switch (static_cast<reqstatus_t>(downloadRequest->status))
+                LOG_info << "[TransferSlot::~TransferSlot] Waiting for decryption of the block at " << piece.pos;
+                std::mutex finalizedMutex;
+                std::unique_lock<std::mutex> guard(finalizedMutex);
+                while (!entry.decrypted)
                 {
-                    case REQ_INFLIGHT:
-                        if (fa && downloadRequest && downloadRequest->status == REQ_INFLIGHT
-                            && downloadRequest->contentlength == downloadRequest->size
-                            && downloadRequest->bufpos >= SymmCipher::BLOCKSIZE)
-                        {
-                            HttpReq::http_buf_t* buf = downloadRequest->release_buf();
-                            buf->end -= buf->datalen() % RAIDSECTOR;
-                            transferbuf.submitBuffer(i, new TransferBufferManager::FilePiece(downloadRequest->dlpos, buf)); // resets size & bufpos of downloadrequest.
-                        }
-                        break;
+                    piece.finalizedCV.wait_for(guard, std::chrono::milliseconds(100));
+                }
+            }
 
-                    case REQ_DECRYPTING:
-                    {
-                        LOG_info << "[TransferSlot::~TransferSlot] Conn " << i << " : Waiting for block decryption";
-                        std::mutex finalizedMutex;
-                        std::unique_lock<std::mutex> guard(finalizedMutex);
-                        auto outputPiece = transferbuf.getAsyncOutputBufferPointer(i);
-                        outputPiece->finalizedCV.wait(guard, [&](){ return outputPiece->finalized; });
-                        downloadRequest->status = REQ_DECRYPTED;
-                        break;
-                    }
+            if (fa && fa->fwrite(piece.buf.datastart(), static_cast<unsigned>(piece.buf.datalen()), piece.pos))
+            {
+                LOG_verbose << "[TransferSlot::~TransferSlot] Sync write succeeded at " << piece.pos << " (size: " << piece.buf.datalen() << ")";
+                it = retirePipelinedPiece(it, true);
+                cachetransfer = true;
+            }
+            else
+            {
+                LOG_err << "[TransferSlot::~TransferSlot] Error caching data at: " << piece.pos << " (size: " << piece.buf.datalen() << ")";
+                it = retirePipelinedPiece(it, false);  // throws the data away so we can move on to the next one
+            }
+        }
 
-                    default:
-                        break;
+        for (int i = 0; i < connections; i++)
+        {
+            if (HttpReqDL *downloadRequest = static_cast<HttpReqDL*>(reqs[i].get()))
+            {
+                if (fa && downloadRequest->status == REQ_INFLIGHT
+                    && downloadRequest->contentlength == downloadRequest->size
+                    && downloadRequest->bufpos >= SymmCipher::BLOCKSIZE)
+                {
+                    HttpReq::http_buf_t* buf = downloadRequest->release_buf();
+                    buf->end -= buf->datalen() % RAIDSECTOR;
+                    transferbuf.submitBuffer(i, new TransferBufferManager::FilePiece(downloadRequest->dlpos, buf)); // resets size & bufpos of downloadrequest.
                 }
             }
         }
@@ -469,6 +499,271 @@ bool TransferSlot::checkDownloadTransferFinished(TransferDbCommitter& committer,
     return false;
 }
 
+bool TransferSlot::pipelineAccepts(const TransferBufferManager::FilePiece& piece) const
+{
+    if (mPipeline.empty())
+    {
+        return true;
+    }
+
+    // a piece starting part way through a chunk needs the mac of the earlier part of that chunk,
+    // which only reaches transfer->chunkmacs once the piece holding it has been written
+    if (piece.pos != ChunkedHash::chunkfloor(piece.pos))
+    {
+        return false;
+    }
+
+    return mPipelineBytes + static_cast<m_off_t>(piece.buf.datalen()) <= MAX_PIPELINE_SIZE;
+}
+
+void TransferSlot::pipelinePiece(MegaClient* client, std::shared_ptr<TransferBufferManager::FilePiece> piece)
+{
+    auto entry = std::make_shared<PipelinedPiece>();
+    entry->piece = piece;
+
+    mPipelineBytes += static_cast<m_off_t>(piece->buf.datalen());
+    mPipeline.emplace(piece->pos, entry);
+
+    // partial chunks are done here, in order, as later parts of a chunk need the mac of earlier parts
+    if (!piece->finalize(false, transfer->size, transfer->ctriv, transfer->transfercipher(), &transfer->chunkmacs))
+    {
+        entry->decrypted = true;
+        return;
+    }
+
+    // do full chunk (and chunk-remainder) decryption on a thread for throughput and to minimize mutex lock times.
+    auto transferkey = transfer->transferkey;
+    auto ctriv = transfer->ctriv;
+    auto filesize = transfer->size;
+
+    client->mAsyncQueue.push([entry, transferkey, ctriv, filesize](SymmCipher& sc)
+    {
+        sc.setkey(transferkey.data());
+        entry->piece->finalize(true, filesize, ctriv, &sc, nullptr);
+        entry->decrypted = true;
+    }, false);  // not discardable:  if we downloaded the data, don't waste it - decrypt and write as much as we can to file
+}
+
+bool TransferSlot::processPipeline(MegaClient* client, TransferDbCommitter& committer, dstime& backoff)
+{
+    bool written = false;
+    unsigned writing = 0;
+    PipelineWrite* lastWrite = nullptr;
+
+    // write in file order, as far as the pieces have been decrypted
+    for (auto it = mPipeline.begin(); it != mPipeline.end(); )
+    {
+        auto& entry = *it->second;
+
+        if (entry.write)
+        {
+            // pieces written together share their write
+            writing += entry.write.get() != lastWrite;
+            lastWrite = entry.write.get();
+            ++it;
+            continue;
+        }
+
+        if (!entry.decrypted || backoff
+            || (fa->asyncavailable() && writing == MAX_PIPELINE_WRITES))
+        {
+            break;
+        }
+
+        // merge the decrypted pieces that follow on from this one into a single write
+        auto end = std::next(it);
+        auto length = static_cast<m_off_t>(entry.piece->buf.datalen());
+
+        while (end != mPipeline.end()
+               && end->first == it->first + length
+               && end->second->decrypted
+               && !end->second->write
+               && length + static_cast<m_off_t>(end->second->piece->buf.datalen()) <= MAX_PIPELINE_WRITE_SIZE)
+        {
+            length += static_cast<m_off_t>(end->second->piece->buf.datalen());
+            ++end;
+        }
+
+        auto write = std::make_shared<PipelineWrite>();
+        auto count = std::distance(it, end);
+        const byte* data = entry.piece->buf.datastart();
+
+        if (count > 1)
+        {
+            write->data.reset(new byte[static_cast<size_t>(length)]);
+
+            auto* dest = write->data.get();
+            for (auto j = it; j != end; ++j)
+            {
+                auto& buf = j->second->piece->buf;
+                memcpy(dest, buf.datastart(), buf.datalen());
+                dest += buf.datalen();
+            }
+
+            data = write->data.get();
+        }
+
+        ++mPipelineWrites;
+        mPipelineBytesWritten += static_cast<uint64_t>(length);
+        ++client->performanceStats.downloadWrites;
+        client->performanceStats.downloadWriteBytes += static_cast<uint64_t>(length);
+
+        if (fa->asyncavailable())
+        {
+            LOG_debug << "Writing data asynchronously at " << it->first << " to " << (it->first + length) << " (size: " << length << ", pieces: " << count << ")";
+            write->context.reset(fa->asyncfwrite(data, static_cast<unsigned>(length), it->first));
+
+            for (; it != end; ++it)
+            {
+                it->second->write = write;
+            }
+
+            ++writing;
+            lastWrite = write.get();
+            continue;
+        }
+
+        if (!fa->fwrite(data, static_cast<unsigned>(length), it->first))
+        {
+            LOG_err << "Error saving finished chunk at " << it->first << " (size: " << length << ")";
+            if (!fa->retry)
+            {
+                // discard failed data so we don't retry on slot deletion
+                while (it != end)
+                {
+                    it = retirePipelinedPiece(it, false);
+                }
+                transfer->failed(API_EWRITE, committer);
+                return true;
+            }
+            lasterror = API_EWRITE;
+            backoff = 2;
+            break;
+        }
+
+        LOG_verbose << "Sync write succeeded at " << it->first << " (size: " << length << ", pieces: " << count << ")";
+        while (it != end)
+        {
+            it = retirePipelinedPiece(it, true);
+        }
+        written = true;
+    }
+
+    for (auto it = mPipeline.begin(); it != mPipeline.end(); )
+    {
+        auto& write = it->second->write;
+        if (!write || !write->context->finished)
+        {
+            ++it;
+            continue;
+        }
+
+        auto size = it->second->piece->buf.datalen();
+        if (!write->context->failed)
+        {
+            LOG_verbose << "Async write succeeded at " << it->first << " (size: " << size << ")";
+            it = retirePipelinedPiece(it, true);
+            written = true;
+            continue;
+        }
+
+        LOG_warn << "Async write failed at " << it->first << " (size: " << size << "). Retry: " << write->context->retry;
+        if (!write->context->retry)
+        {
+            // discard the failed data of every piece in this write so we don't retry on slot deletion
+            auto failed = write;
+            while (it != mPipeline.end() && it->second->write == failed)
+            {
+                it = retirePipelinedPiece(it, false);
+            }
+            transfer->failed(API_EWRITE, committer);
+            return true;
+        }
+
+        // write it again shortly
+        write.reset();
+        lasterror = API_EWRITE;
+        backoff = 2;
+        ++it;
+    }
+
+    if (written)
+    {
+        errorcount = 0;
+        transfer->failcount = 0;
+
+        writeback(updatecontiguousprogress());
+
+        if (checkDownloadTransferFinished(committer, client))
+        {
+            return true;
+        }
+
+        // only progress has changed
+        client->transfercachedirty(transfer);
+    }
+    return false;
+}
+
+void TransferSlot::writeback(m_off_t contiguous)
+{
+    if (contiguous < mWritebackPos + WRITEBACK_WINDOW)
+    {
+        return;
+    }
+
+    // keep the disk busy with this window while we wait for the previous one
+    fa->fwriteback(mWritebackPos, contiguous - mWritebackPos);
+
+    // the previous window has had a window's worth of writing to reach the disk
+    if (mWritebackPos > mDroppedPos)
+    {
+        fa->fdropcache(mDroppedPos, mWritebackPos - mDroppedPos);
+    }
+
+    mDroppedPos = mWritebackPos;
+    mWritebackPos = contiguous;
+}
+
+TransferSlot::PipelinedPieceMap::iterator TransferSlot::retirePipelinedPiece(PipelinedPieceMap::iterator it, bool written)
+{
+    auto& piece = *it->second->piece;
+
+    if (written)
+    {
+        transferbuf.detachedBufferWriteCompleted(piece);
+    }
+
+    mPipelineBytes -= static_cast<m_off_t>(piece.buf.datalen());
+    return mPipeline.erase(it);
+}
+
+TransferSlot::PipelineStats TransferSlot::pipelineStats() const
+{
+    PipelineStats stats;
+
+    for (auto& i : mPipeline)
+    {
+        if (i.second->write)
+        {
+            ++stats.writing;
+        }
+        else if (i.second->decrypted)
+        {
+            ++stats.decrypted;
+        }
+        else
+        {
+            ++stats.decrypting;
+        }
+    }
+
+    stats.bytes = mPipelineBytes;
+    stats.writes = mPipelineWrites;
+    stats.bytesWritten = mPipelineBytesWritten;
+    return stats;
+}
+
 bool TransferSlot::testForSlowRaidConnection(unsigned connectionNum, bool& incrementErrors)
 {
     if (transfer->type == GET && transferbuf.isRaid())
@@ -585,6 +880,11 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
         return transfer->failed(lasterror, committer);
     }
 
+    if (transfer->type == GET && processPipeline(client, committer, backoff))
+    {
+        return;
+    }
+
     // main loop over connections
     for (int i = connections; i--; )
     {
@@ -648,7 +948,8 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                 {
                     mReqSpeeds[i].requestProgressed(reqs[i]->size);
 
-                    if (client->orderdownloadedchunks && transfer->type == GET && !transferbuf.isRaid() && transfer->progresscompleted != static_cast<HttpReqDL*>(reqs[i].get())->dlpos)
+                    // the pipeline only holds pieces in order here, so it ends where the next piece must start
+                    if (client->orderdownloadedchunks && transfer->type == GET && !transferbuf.isRaid() && transfer->progresscompleted + mPipelineBytes != static_cast<HttpReqDL*>(reqs[i].get())->dlpos)
                     {
                         LOG_debug << "Conn " << i << " : POSTPONING UNSORTED CHUNK";
                         // postponing unsorted chunk
@@ -799,7 +1100,9 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
 
                         errorcount = 0;
                         transfer->failcount = 0;
-                        client->transfercacheadd(transfer, &committer);
+
+                        // only progress has changed
+                        client->transfercachedirty(transfer);
                         reqs[i]->status = REQ_READY;
 
                         DEBUG_TEST_HOOK_UPLOADCHUNK_SUCCEEDED(transfer, committer);  // this will return if the hook returns false
@@ -826,7 +1129,7 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                     else   // GET
                     {
                         HttpReqDL *downloadRequest = static_cast<HttpReqDL*>(reqs[i].get());
-                        if (reqs[i]->size == reqs[i]->bufpos || downloadRequest->buffer_released)   // downloadRequest->buffer_released being true indicates we're retrying this asyncIO
+                        if (reqs[i]->size == reqs[i]->bufpos || downloadRequest->buffer_released)   // downloadRequest->buffer_released being true indicates we're retrying the hand-over to the pipeline
                         {
                             if (!downloadRequest->buffer_released)
                             {
@@ -838,31 +1141,28 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                             auto outputPiece = transferbuf.getAsyncOutputBufferPointer(i);
                             if (outputPiece)
                             {
-                                p += outputPiece->buf.datalen(); // p (and progressreported) needs to be updated with this value. If raid, it will also be increased with the data waiting to be recombined
                                 mRaidChannelSwapsForSlowness = 0;
-                                bool parallelNeeded = outputPiece->finalize(false, transfer->size, transfer->ctriv, transfer->transfercipher(), &transfer->chunkmacs);
 
-                                if (parallelNeeded)
+                                if (!pipelineAccepts(*outputPiece))
                                 {
-                                    // do full chunk (and chunk-remainder) decryption on a thread for throughput and to minimize mutex lock times.
-                                    auto req = reqs[i];   // shared_ptr for shutdown safety
-                                    auto transferkey = transfer->transferkey;
-                                    auto ctriv = transfer->ctriv;
-                                    auto filesize = transfer->size;
-                                    req->status = REQ_DECRYPTING;
-
-                                    client->mAsyncQueue.push([req, i, outputPiece, transferkey, ctriv, filesize](SymmCipher& sc)
-                                    {
-                                        sc.setkey(transferkey.data());
-                                        outputPiece->finalize(true, filesize, ctriv, &sc, nullptr);
-                                        LOG_debug << "Conn " << i << " : REQ_DECRYPTED [parallel]";
-                                        req->status = REQ_DECRYPTED;
-                                    }, false);  // not discardable:  if we downloaded the data, don't waste it - decrypt and write as much as we can to file
+                                    // keep the piece on this connection until the pipeline drains a bit
+                                    LOG_verbose << "Conn " << i << " : Waiting for the download pipeline (" << mPipelineBytes << " bytes held)";
+                                    p += outputPiece->buf.datalen(); // p (and progressreported) needs to be updated with this value. If raid, it will also be increased with the data waiting to be recombined
+                                    break;
                                 }
-                                else
+
+                                // hand the piece over, so this connection can fetch the next one while the piece is decrypted and written
+                                LOG_debug << "Conn " << i << " : Piece at " << outputPiece->pos << " handed to the download pipeline (size: " << outputPiece->buf.datalen() << ")";
+                                pipelinePiece(client, transferbuf.detachAsyncOutputBuffer(i));
+                                reqs[i]->status = REQ_READY;
+
+                                if (client->orderdownloadedchunks && !transferbuf.isRaid())
                                 {
-                                    reqs[i]->status = REQ_DECRYPTED;
-                                    LOG_debug << "Conn " << i << " : REQ_DECRYPTED";
+                                    // check connections again looking for the postponed chunk that follows this one.
+                                    // their progress is counted again on the way, so start counting afresh
+                                    p = 0;
+                                    i = connections;
+                                    continue;
                                 }
                             }
                             else if (transferbuf.isRaid())
@@ -905,131 +1205,40 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                     assert(transfer->type == PUT);
                     break;
                 }
-                case REQ_DECRYPTING:
-                {
-                    assert(transfer->type == GET);
-                    // this must return the same piece we are decrypting, since we have not asked the transferbuf to discard it yet.
-                    auto outputPiece = transferbuf.getAsyncOutputBufferPointer(i);
-                    assert(outputPiece && outputPiece->buf.datalen());
-                    p += outputPiece->buf.datalen(); // This is part of the transferred bytes
-                    break;
-                }
-                case REQ_DECRYPTED:
-                {
-                        assert(transfer->type == GET);
-
-                        // this must return the same piece we just decrypted, since we have not asked the transferbuf to discard it yet.
-                        auto outputPiece = transferbuf.getAsyncOutputBufferPointer(i);
-
-                        if (fa->asyncavailable())
-                        {
-                            if (asyncIO[i])
-                            {
-                                LOG_warn << "Conn " << i << " : Retrying failed async write";
-                                delete asyncIO[i];
-                                asyncIO[i] = NULL;
-                            }
-
-                            p += outputPiece->buf.datalen();
-
-                            LOG_debug << "Conn " << i << " : Writing data asynchronously at " << outputPiece->pos << " to " << (outputPiece->pos + outputPiece->buf.datalen()) << " (size: " << outputPiece->buf.datalen() << ")";
-                            asyncIO[i] = fa->asyncfwrite(outputPiece->buf.datastart(), static_cast<unsigned>(outputPiece->buf.datalen()), outputPiece->pos);
-                            reqs[i]->status = REQ_ASYNCIO;
-                        }
-                        else
-                        {
-                            if (fa->fwrite(outputPiece->buf.datastart(), static_cast<unsigned>(outputPiece->buf.datalen()), outputPiece->pos))
-                            {
-                                LOG_verbose << "Conn " << i << " : Sync write succeeded (size: " << outputPiece->buf.datalen() << ")";
-                                transferbuf.bufferWriteCompleted(i, true);
-                                errorcount = 0;
-                                transfer->failcount = 0;
-                                updatecontiguousprogress();
-                            }
-                            else
-                            {
-                                LOG_err << "Conn " << i << " : Error saving finished chunk (size: " << outputPiece->buf.datalen() << ")";
-                                if (!fa->retry)
-                                {
-                                    transferbuf.bufferWriteCompleted(i, false);  // discard failed data so we don't retry on slot deletion
-                                    return transfer->failed(API_EWRITE, committer);
-                                }
-                                lasterror = API_EWRITE;
-                                backoff = 2;
-                                break;
-                            }
-
-                            if (checkDownloadTransferFinished(committer, client))
-                            {
-                                return;
-                            }
-
-                            client->transfercacheadd(transfer, &committer);
-                            reqs[i]->status = REQ_READY;
-                        }
-                    }
-                    break;
-
                 case REQ_ASYNCIO:
+                    // downloads write through the pipeline, so these are always reads for an upload
+                    assert(transfer->type == PUT);
                     if (asyncIO[i]->finished)
                     {
                         LOG_verbose << "Conn " << i << " : Processing finished async fs operation";
                         if (!asyncIO[i]->failed)
                         {
-                            if (transfer->type == PUT)
+                            LOG_verbose << "Conn " << i << " : Async read succeeded (size: " << asyncIO[i]->dataBufferLen << ")";
+                            m_off_t npos = asyncIO[i]->posOfBuffer + asyncIO[i]->dataBufferLen;
+                            string finaltempurl = transferbuf.tempURL(i);
+                            if (client->usealtupport && !memcmp(finaltempurl.c_str(), "http:", 5))
                             {
-                                LOG_verbose << "Conn " << i << " : Async read succeeded (size: " << asyncIO[i]->dataBufferLen << ")";
-                                m_off_t npos = asyncIO[i]->posOfBuffer + asyncIO[i]->dataBufferLen;
-                                string finaltempurl = transferbuf.tempURL(i);
-                                if (client->usealtupport && !memcmp(finaltempurl.c_str(), "http:", 5))
+                                size_t index = finaltempurl.find("/", 8);
+                                if(index != string::npos && finaltempurl.find(":", 8) == string::npos)
                                 {
-                                    size_t index = finaltempurl.find("/", 8);
-                                    if(index != string::npos && finaltempurl.find(":", 8) == string::npos)
-                                    {
-                                        finaltempurl.insert(index, ":8080");
-                                    }
+                                    finaltempurl.insert(index, ":8080");
                                 }
-
-                                auto pos = asyncIO[i]->posOfBuffer;
-                                auto req = reqs[i];    // shared_ptr so no object is deleted out from under the worker
-                                auto transferkey = transfer->transferkey;
-                                auto ctriv = transfer->ctriv;
-                                req->pos = pos;
-                                req->status = REQ_ENCRYPTING;
-
-                                client->mAsyncQueue.push([req, transferkey, ctriv, finaltempurl, pos, npos](SymmCipher& sc)
-                                    {
-                                        sc.setkey(transferkey.data());
-                                        req->prepare(finaltempurl.c_str(), &sc, ctriv, pos, npos);
-                                        req->status = REQ_PREPARED;
-                                    }, true);   // discardable - if the transfer or client are being destroyed, we won't be sending that data.
                             }
-                            else
-                            {
-                                LOG_verbose << "Conn " << i << " : Async write succeeded (size: " << asyncIO[i]->dataBufferLen << ")";
-                                transferbuf.bufferWriteCompleted(i, true);
-                                errorcount = 0;
-                                transfer->failcount = 0;
 
-                                updatecontiguousprogress();
+                            auto pos = asyncIO[i]->posOfBuffer;
+                            auto req = reqs[i];    // shared_ptr so no object is deleted out from under the worker
+                            auto transferkey = transfer->transferkey;
+                            auto ctriv = transfer->ctriv;
+                            req->pos = pos;
+                            req->status = REQ_ENCRYPTING;
 
-                                if (checkDownloadTransferFinished(committer, client))
+                            client->mAsyncQueue.push([req, transferkey, ctriv, finaltempurl, pos, npos](SymmCipher& sc)
                                 {
-                                    return;
-                                }
-
-                                client->transfercacheadd(transfer, &committer);
-                                reqs[i]->status = REQ_READY;
+                                    sc.setkey(transferkey.data());
+                                    req->prepare(finaltempurl.c_str(), &sc, ctriv, pos, npos);
+                                    req->status = REQ_PREPARED;
+                                }, true);   // discardable - if the transfer or client are being destroyed, we won't be sending that data.
 
-                                if (client->orderdownloadedchunks && !transferbuf.isRaid())
-                                {
-                                    // Check connections again looking for postponed chunks
-                                    delete asyncIO[i];
-                                    asyncIO[i] = NULL;
-                                    i = connections;
-                                    continue;
-                                }
-                            }
                             delete asyncIO[i];
                             asyncIO[i] = NULL;
                         }
@@ -1038,30 +1247,17 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                             LOG_warn << "Conn " << i << " : Async operation failed  (size: " << asyncIO[i]->dataBufferLen << "). Retry: " << asyncIO[i]->retry;
                             if (!asyncIO[i]->retry)
                             {
-                                transferbuf.bufferWriteCompleted(i, false);  // discard failed data so we don't retry on slot deletion
                                 delete asyncIO[i];
                                 asyncIO[i] = NULL;
-                                return transfer->failed(transfer->type == PUT ? API_EREAD : API_EWRITE, committer);
+                                return transfer->failed(API_EREAD, committer);
                             }
 
                             // retry shortly
-                            if (transfer->type == PUT)
-                            {
-                                lasterror = API_EREAD;
-                                reqs[i]->status = REQ_READY;
-                            }
-                            else
-                            {
-                                lasterror = API_EWRITE;
-                                reqs[i]->status = REQ_SUCCESS;
-                            }
+                            lasterror = API_EREAD;
+                            reqs[i]->status = REQ_READY;
                             backoff = 2;
                         }
                     }
-                    else if (transfer->type == GET)
-                    {
-                        p += asyncIO[i]->dataBufferLen;
-                    }
                     break;
 
                 case REQ_FAILURE:
@@ -1296,6 +1492,9 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
             cloudRaidProgress = cloudRaid->progress();
         }
         p += cloudRaidProgress;
+
+        // pieces leave their connection when handed to the pipeline, and count as completed once written
+        p += mPipelineBytes;
     }
     p += transfer->progresscompleted;
 
@@ -1318,6 +1517,11 @@ void TransferSlot::doio(MegaClient* client, TransferDbCommitter& committer)
                     LOG_verbose << "[TransferSlot::doio] " << ((transfer->type == PUT) ? "[Upload]" : "[Non CloudRaid]")
                                 << " Speed: " << (speed / 1024) << " KB/s. Mean speed: " << (meanSpeed / 1024) << " KB/s [diff = " << diff << "]" << " [new progressreported = " << p << ", last progressreported = " << progressreported << ", transfer->progresscompleted = " << transfer->progresscompleted << "] [transfer->size = " << transfer->size << "] [transfer->name = " << transfer->localfilename << "]";
                 }
+                if (transfer->type == GET && !mPipeline.empty())
+                {
+                    auto stats = pipelineStats();
+                    LOG_verbose << "[TransferSlot::doio] Download pipeline: " << stats.decrypting << " decrypting, " << stats.decrypted << " waiting to be written, " << stats.writing << " being written [bytes = " << stats.bytes << "] [writes = " << stats.writes << ", avg write size = " << (stats.writes ? stats.bytesWritten / stats.writes : 0) << "]";
+                }
                 assert(p <= transfer->size);
             }
             if (transfer->type == PUT)
@@ -2988,6 +2988,308 @@ TEST_F(SdkTest, SdkTestResumeSession)
     ASSERT_NO_FATAL_FAILURE( fetchnodes(0) );
 }
 
+/**
+ * @brief TEST_F DISABLED_SdkTestGetterLatencyUnderLoad
+ *
+ * Reports how long node getters take while the SDK thread is busy.
+ *
+ * The load is simulated by repeatedly holding the MegaApi lock, as a
+ * long exec() slice would.
+ */
+TEST_F(SdkTest, DISABLED_SdkTestGetterLatencyUnderLoad)
+{
+    LOG_info << "___TEST GetterLatencyUnderLoad___";
+
+    ASSERT_NO_FATAL_FAILURE(getAccountsForTest(1));
+
+    std::unique_ptr<MegaNode> rootnode{megaApi[0]->getRootNode()};
+    auto nh = createFolder(0, "getter-latency", rootnode.get());
+    ASSERT_NE(nh, UNDEF);
+
+    constexpr auto numCalls = 2000;
+    constexpr auto holdTime = std::chrono::milliseconds(50);
+
+    std::atomic<bool> done{false};
+
+    // Keep the SDK thread's mutex busy most of the time.
+    std::thread load([&]() {
+        std::unique_ptr<MegaApiLock> lock{megaApi[0]->getMegaApiLock(false)};
+
+        while (!done)
+        {
+            lock->lockOnce();
+            std::this_thread::sleep_for(holdTime);
+            lock->unlockOnce();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    std::vector<long long> latencies;
+    std::unique_ptr<MegaNode> node;
+    std::unique_ptr<MegaNode> parent;
+
+    for (auto i = 0; i < numCalls; ++i)
+    {
+        auto began = std::chrono::steady_clock::now();
+
+        node.reset(megaApi[0]->getNodeByHandle(nh));
+        parent.reset(megaApi[0]->getParentNode(node.get()));
+
+        auto elapsed = std::chrono::steady_clock::now() - began;
+
+        latencies.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+        // Stop early but don't assert yet: the load thread must be joined first.
+        if (!node || !parent || parent->getHandle() != rootnode->getHandle())
+        {
+            break;
+        }
+    }
+
+    done = true;
+    load.join();
+
+    ASSERT_TRUE(node);
+    ASSERT_TRUE(parent);
+    ASSERT_EQ(parent->getHandle(), rootnode->getHandle());
+
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&](size_t p) {
+        return latencies[std::min(latencies.size() - 1, latencies.size() * p / 100)];
+    };
+
+    LOG_info << numCalls
+             << " getter call(s) under load: p50 "
+             << percentile(50)
+             << "us, p90 "
+             << percentile(90)
+             << "us, p99 "
+             << percentile(99)
+             << "us, max "
+             << latencies.back()
+             << "us";
+}
+
+/**
+ * @brief TEST_F DISABLED_SdkTestBulkUploadSubmission
+ *
+ * Compares how long it takes to start a large number of small uploads
+ * one at a time and as a single batch.
+ */
+TEST_F(SdkTest, DISABLED_SdkTestBulkUploadSubmission)
+{
+    LOG_info << "___TEST BulkUploadSubmission___";
+
+    ASSERT_NO_FATAL_FAILURE(getAccountsForTest(1));
+
+    constexpr auto numFiles = 100000;
+
+    // Counts the callbacks we receive for our transfers.
+    struct Counter : public MegaTransferListener
+    {
+        std::atomic<int> started{0};
+        std::atomic<int> finished{0};
+
+        void onTransferStart(MegaApi*, MegaTransfer*) override
+        {
+            ++started;
+        }
+
+        // Batches are only reported once, when every transfer has started.
+        void onTransfersStart(MegaApi*, MegaTransferList* transfers) override
+        {
+            started += transfers->size();
+        }
+
+        void onTransferFinish(MegaApi*, MegaTransfer*, MegaError*) override
+        {
+            ++finished;
+        }
+    }; // Counter
+
+    auto folder = fs::current_path() / "bulk-upload-submission";
+
+    fs::remove_all(folder);
+    fs::create_directories(folder);
+
+    std::unique_ptr<MegaStringList> paths{MegaStringList::createInstance()};
+
+    for (auto i = 0; i < numFiles; ++i)
+    {
+        auto path = folder / ("f" + std::to_string(i));
+
+        // Distinct content so that no upload is satisfied by a copy.
+        ASSERT_TRUE(createFile(path.u8string(), false, std::to_string(i)));
+
+        paths->add(path.u8string().c_str());
+    }
+
+    std::unique_ptr<MegaNode> rootnode{megaApi[0]->getRootNode()};
+
+    auto measure = [&](const char* name, bool batch) {
+        auto target = createFolder(0, name, rootnode.get());
+        ASSERT_NE(target, UNDEF);
+
+        std::unique_ptr<MegaNode> parent{megaApi[0]->getNodeByHandle(target)};
+        std::unique_ptr<MegaCancelToken> cancelToken{MegaCancelToken::createInstance()};
+        Counter counter;
+
+        auto began = std::chrono::steady_clock::now();
+
+        if (batch)
+        {
+            megaApi[0]->startUploads(paths.get(), parent.get(), nullptr, false, cancelToken.get(), false, &counter);
+        }
+        else
+        {
+            for (auto i = 0; i < paths->size(); ++i)
+            {
+                megaApi[0]->startUpload(paths->get(i), parent.get(), nullptr, MegaApi::INVALID_CUSTOM_MOD_TIME, nullptr, false, false, cancelToken.get(), &counter);
+            }
+        }
+
+        auto submitted = std::chrono::steady_clock::now();
+
+        ASSERT_TRUE(WaitFor([&]() { return counter.started == numFiles; }, 3600 * 1000));
+
+        auto elapsed = std::chrono::steady_clock::now() - began;
+
+        LOG_info << (batch ? "Batch" : "Individual")
+                 << " submission of "
+                 << numFiles
+                 << " upload(s) returned after "
+                 << std::chrono::duration_cast<std::chrono::milliseconds>(submitted - began).count()
+                 << "ms, all started after "
+                 << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                 << "ms";
+
+        // We only care about how quickly the uploads start.
+        cancelToken->cancel();
+        megaApi[0]->cancelTransfers(MegaTransfer::TYPE_UPLOAD);
+
+        ASSERT_TRUE(WaitFor([&]() { return counter.finished == numFiles; }, 3600 * 1000));
+    };
+
+    measure("individual", false);
+    measure("batch", true);
+
+    fs::remove_all(folder);
+}
+
+/**
+ * @brief TEST_F DISABLED_SdkTestMediaUploadExecStall
+ *
+ * Reports how long the SDK thread is held up while many media uploads
+ * complete and have their media attributes extracted.
+ *
+ * The SDK thread holds the MegaApi lock for each exec() slice, so the
+ * time taken to acquire that lock is the stall an app thread sees.
+ */
+TEST_F(SdkTest, DISABLED_SdkTestMediaUploadExecStall)
+{
+    LOG_info << "___TEST MediaUploadExecStall___";
+
+    static const std::string AUDIO_FILENAME = "test_cover_png.mp3";
+
+    constexpr auto numFiles = 200;
+
+    auto source = sdk_test::getTestDataDir() / AUDIO_FILENAME;
+    ASSERT_TRUE(fs::exists(source)) << source.u8string() << " file does not exist";
+
+    ASSERT_NO_FATAL_FAILURE(getAccountsForTest(1));
+
+    auto folder = fs::current_path() / "media-upload-exec-stall";
+
+    fs::remove_all(folder);
+    fs::create_directories(folder);
+
+    std::unique_ptr<MegaStringList> paths{MegaStringList::createInstance()};
+
+    for (auto i = 0; i < numFiles; ++i)
+    {
+        auto path = folder / ("a" + std::to_string(i) + ".mp3");
+
+        ASSERT_TRUE(fs::copy_file(source, path));
+
+        // Distinct content so that no upload is satisfied by a copy.
+        ofstream file(path, ios::app | ios::binary);
+        file << i;
+
+        paths->add(path.u8string().c_str());
+    }
+
+    std::unique_ptr<MegaNode> rootnode{megaApi[0]->getRootNode()};
+    auto target = createFolder(0, "media-upload-exec-stall", rootnode.get());
+    ASSERT_NE(target, UNDEF);
+
+    std::unique_ptr<MegaNode> parent{megaApi[0]->getNodeByHandle(target)};
+
+    // Counts the uploads that have finished.
+    struct Counter : public MegaTransferListener
+    {
+        std::atomic<int> finished{0};
+        std::atomic<int> failed{0};
+
+        void onTransferFinish(MegaApi*, MegaTransfer*, MegaError* error) override
+        {
+            if (error->getErrorCode() != API_OK)
+                ++failed;
+
+            ++finished;
+        }
+    }; // Counter
+
+    Counter counter;
+
+    megaApi[0]->startUploads(paths.get(), parent.get(), nullptr, false, nullptr, true, &counter);
+
+    std::unique_ptr<MegaApiLock> lock{megaApi[0]->getMegaApiLock(false)};
+    std::vector<long long> stalls;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+
+    // Sample how long it takes to get hold of the SDK thread until every upload has completed.
+    while (counter.finished < numFiles && std::chrono::steady_clock::now() < deadline)
+    {
+        auto began = std::chrono::steady_clock::now();
+
+        lock->lockOnce();
+
+        auto elapsed = std::chrono::steady_clock::now() - began;
+
+        lock->unlockOnce();
+
+        stalls.emplace_back(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_EQ(counter.finished, numFiles);
+    ASSERT_EQ(counter.failed, 0);
+    ASSERT_FALSE(stalls.empty());
+
+    std::sort(stalls.begin(), stalls.end());
+
+    auto percentile = [&](size_t p) {
+        return stalls[std::min(stalls.size() - 1, stalls.size() * p / 100)];
+    };
+
+    LOG_info << "SDK thread stalls while "
+             << numFiles
+             << " media upload(s) completed: p50 "
+             << percentile(50)
+             << "us, p90 "
+             << percentile(90)
+             << "us, p99 "
+             << percentile(99)
+             << "us, max "
+             << stalls.back()
+             << "us";
+
+    fs::remove_all(folder);
+}
+
 /**
  * @brief TEST_F SdkTestNodeOperations
  *
@@ -811,8 +811,8 @@ public:
             for (auto& childIt : node.children)
             {
                 // But only those that've been written to disk.
-                if (childIt.second->dbid)
-                    pending.emplace_back(childIt.second);
+                if (childIt->dbid)
+                    pending.emplace_back(childIt);
             }
         }
 
@@ -924,7 +924,7 @@ private:
 
         for (auto& childIt : node.children)
         {
-            auto& child = *childIt.second;
+            auto& child = *childIt;
 
             // Skip children that haven't been written to disk.
             if (!child.dbid)
@@ -3397,10 +3397,10 @@ bool StandardClient::recursiveConfirm(Model::ModelNode* mn, LocalNode* n, int& d
     }
     for (auto& n2 : n->children)
     {
-        if (skipIgnoreFile && n2.second->isIgnoreFile())
+        if (skipIgnoreFile && n2->isIgnoreFile())
             continue;
 
-        ns.emplace(n2.second->localname.toPath(false), n2.second); // todo: should LocalNodes marked as deleted actually have been removed by now?
+        ns.emplace(n2->localname.toPath(false), n2); // todo: should LocalNodes marked as deleted actually have been removed by now?
     }
 
     int matched = 0;
@@ -10469,7 +10469,7 @@ struct TwoWaySyncSymmetryCase
 
         for (const auto& childIt : node.children)
         {
-            PrintLocalTree(*childIt.second);
+            PrintLocalTree(*childIt);
         }
     }
 
@@ -19310,5 +19310,92 @@ TEST_F(ContradictoryMoveFixture, ResolveRemotely)
     EXPECT_TRUE(c->confirmModel_mainthread(mf.root.get(), id));
 }
 
-#endif
+TEST_F(SyncTest, DISABLED_ChangeToUploadLatency)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto TIMEOUT = std::chrono::minutes(60);
+    constexpr auto numFolders = 1000u;
+    constexpr auto numFilesPerFolder = 1000u;
+    constexpr auto numSamples = 10u;
+
+    auto client = g_clientManager->getCleanStandardClient(0, makeNewTestRoot());
+
+    ASSERT_TRUE(client->resetBaseFolderMulticlient());
+    ASSERT_TRUE(client->makeCloudSubdirs("s", 0, 0));
+
+    auto root = client->fsBasePath / "s";
+
+    fs::create_directories(root);
+
+    // The bulk of the tree is excluded so that it never has to be uploaded,
+    // but the engine still tracks a LocalNode for every file.
+    ASSERT_TRUE(createFile(root / ".megaignore", "+sync:.megaignore\n-f:*.bulk\n"));
+
+    for (auto i = 0u; i < numFolders; ++i)
+    {
+        auto folder = root / ("d" + std::to_string(i));
+
+        fs::create_directories(folder);
+
+        for (auto j = 0u; j < numFilesPerFolder; ++j)
+        {
+            ASSERT_TRUE(createFile(folder / ("f" + std::to_string(j) + ".bulk"), std::string()));
+        }
+    }
+
+    auto id = client->setupSync_mainthread("s", "s", false, false);
+    ASSERT_NE(id, UNDEF);
+
+    waitonsyncs(TIMEOUT, client);
 
+    auto controller = std::make_shared<StandardSyncController>();
+
+    client->setSyncController(controller);
+
+    for (auto i = 0u; i < numSamples; ++i)
+    {
+        auto path = root / ("d" + std::to_string(i * numFolders / numSamples)) / ("sample" + std::to_string(i));
+
+        std::promise<void> uploadStarted;
+        std::atomic<bool> notified{false};
+
+        // Note when the engine decides to upload our file.
+        controller->setDeferUploadCallback([&](const fs::path& candidate) {
+            if (candidate == path && !notified.exchange(true))
+                uploadStarted.set_value();
+
+            return false;
+        });
+
+        // Make sure the callback never outlives this iteration, even if we bail early.
+        std::shared_ptr<void> resetCallback(nullptr, [&](...) {
+            controller->setDeferUploadCallback(nullptr);
+        });
+
+        auto began = steady_clock::now();
+
+        ASSERT_TRUE(createFile(path, "x"));
+
+        auto result = uploadStarted.get_future().wait_for(std::chrono::seconds(30));
+        ASSERT_EQ(result, std::future_status::ready);
+
+        auto elapsed = steady_clock::now() - began;
+
+        LOG_info << "Upload of "
+                 << path.u8string()
+                 << " started "
+                 << duration_cast<milliseconds>(elapsed).count()
+                 << "ms after it was written, in a sync of "
+                 << numFolders * numFilesPerFolder
+                 << " node(s)";
+
+        resetCallback.reset();
+
+        waitonsyncs(DEFAULTWAIT, client);
+    }
+}
+
+#endif
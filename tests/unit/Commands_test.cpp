@@ -26,6 +26,8 @@
 #include <mega/megaclient.h>
 #include <mega/types.h>
 
+#include "utils.h"
+
 using namespace std;
 using namespace mega;
 
@@ -255,3 +257,103 @@ TEST(Commands, CommandQueryAds)
     command.procresult(r);
 }
 */
+
+namespace {
+
+// Records the errors the client reports for whole requests.
+class RequestErrorApp : public MegaApp
+{
+public:
+    void request_error(error e) override
+    {
+        mRequestErrors.push_back(e);
+    }
+
+    vector<error> mRequestErrors;
+};
+
+// A command for the unordered lane that records its result.
+class UnorderedCommand : public Command
+{
+public:
+    explicit UnorderedCommand(vector<error>& results)
+      : mResults(results)
+    {
+        cmd("uq");
+        mUnordered = true;
+    }
+
+    bool procresult(Result r, JSON&) override
+    {
+        mResults.push_back(r.wasErrorOrOK() ? error(r.errorOrOK()) : API_OK);
+        return true;
+    }
+
+private:
+    vector<error>& mResults;
+};
+
+// Send a batch with one command on the unordered lane, and return the request in flight.
+HttpReq* sendUnordered(MegaClient& client, vector<error>& results)
+{
+    client.reqs.add(new UnorderedCommand(results));
+    client.execunorderedcs();
+    return client.pendingcsUnordered;
+}
+
+} // anonymous
+
+TEST(Commands, UnorderedLaneReportsRequestErrors)
+{
+    RequestErrorApp app;
+    auto client = mt::makeClient(app);
+    vector<error> results;
+
+    // A bare error code.
+    auto* req = sendUnordered(*client, results);
+    ASSERT_NE(req, nullptr);
+
+    req->in = "-15";
+    req->status = REQ_SUCCESS;
+    client->execunorderedcs();
+
+    EXPECT_EQ(client->pendingcsUnordered, nullptr);
+    ASSERT_EQ(app.mRequestErrors.size(), 1u);
+    EXPECT_EQ(app.mRequestErrors[0], API_ESID);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0], API_ESID);
+
+    // An error object is not mistaken for an internal error.
+    req = sendUnordered(*client, results);
+    ASSERT_NE(req, nullptr);
+
+    req->in = "{\"err\":-9}";
+    req->status = REQ_SUCCESS;
+    client->execunorderedcs();
+
+    ASSERT_EQ(app.mRequestErrors.size(), 2u);
+    EXPECT_EQ(app.mRequestErrors[1], API_ENOENT);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[1], API_ENOENT);
+}
+
+TEST(Commands, UnorderedLaneStopsOnSslCheckFailure)
+{
+    RequestErrorApp app;
+    auto client = mt::makeClient(app);
+    vector<error> results;
+
+    auto* req = sendUnordered(*client, results);
+    ASSERT_NE(req, nullptr);
+
+    req->sslcheckfailed = true;
+    req->status = REQ_FAILURE;
+    client->execunorderedcs();
+
+    // Not retried: the commands fail and the app is told.
+    EXPECT_EQ(client->pendingcsUnordered, nullptr);
+    ASSERT_EQ(app.mRequestErrors.size(), 1u);
+    EXPECT_EQ(app.mRequestErrors[0], API_ESSL);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0], API_ESSL);
+}
@@ -59,6 +59,10 @@ public:
     {
         return false;
     }
+    bool getFingerprints(std::function<void(const std::string&)>) override
+    {
+        return false;
+    }
     bool getNodesByOrigFingerprint(const std::string&, std::vector<std::pair<mega::NodeHandle, mega::NodeSerialized>>&) override
     {
         return false;
@@ -139,6 +143,10 @@ public:
     {
         return false;
     }
+    bool filterByAncestor(mega::NodeHandle, const std::vector<mega::NodeHandle>&, std::set<mega::NodeHandle>&, mega::CancelToken) override
+    {
+        return false;
+    }
     uint64_t getNumberOfNodes() override
     {
         return false;
@@ -0,0 +1,223 @@
+/**
+ * @file FileAttributeCache_test.cpp
+ * @brief Unit tests for the on-disk file attribute cache
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mega/base64.h>
+#include <mega/fileattributefetch.h>
+#include <mega/filesystem.h>
+#include <mega/gfx.h>
+#include <mega/megaapp.h>
+#include <mega/megaclient.h>
+#include "megafs.h"
+
+#include "utils.h"
+
+namespace FileAttributeCacheTests
+{
+
+using namespace mega;
+
+class FileAttributeCacheTest
+  : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(mFsAccess.cwd(mPath));
+
+        mPath.appendWithSeparator(LocalPath::fromRelativePath("fa_cache_test"), false);
+
+        mFsAccess.emptydirlocal(mPath);
+        mFsAccess.rmdirlocal(mPath);
+    }
+
+    void TearDown() override
+    {
+        mFsAccess.emptydirlocal(mPath);
+        mFsAccess.rmdirlocal(mPath);
+    }
+
+    // Cache an attribute of the specified size.
+    static void put(FileAttributeCache& cache, handle fah, size_t size)
+    {
+        std::string data(size, static_cast<char>('a' + fah));
+
+        cache.put(fah, GfxProc::THUMBNAIL, data.data(), data.size());
+    }
+
+    FSACCESS_CLASS mFsAccess;
+    LocalPath mPath;
+}; // FileAttributeCacheTest
+
+TEST_F(FileAttributeCacheTest, EvictsLeastRecentlyUsed)
+{
+    FileAttributeCache cache(mFsAccess);
+    std::string data;
+
+    ASSERT_TRUE(cache.enable(mPath, 300));
+
+    put(cache, 1, 100);
+    put(cache, 2, 100);
+    put(cache, 3, 100);
+
+    ASSERT_TRUE(cache.get(1, GfxProc::THUMBNAIL, data));
+    EXPECT_EQ(data, std::string(100, 'b'));
+
+    // Previews are cached separately.
+    EXPECT_FALSE(cache.get(1, GfxProc::PREVIEW, data));
+
+    // Attribute 2 is now the least recently used.
+    put(cache, 4, 100);
+
+    EXPECT_EQ(cache.size(), 300);
+    EXPECT_FALSE(cache.get(2, GfxProc::THUMBNAIL, data));
+    EXPECT_TRUE(cache.get(3, GfxProc::THUMBNAIL, data));
+    EXPECT_TRUE(cache.get(4, GfxProc::THUMBNAIL, data));
+
+    EXPECT_EQ(cache.hits, 3u);
+    EXPECT_EQ(cache.misses, 2u);
+}
+
+TEST_F(FileAttributeCacheTest, SurvivesRestart)
+{
+    {
+        FileAttributeCache cache(mFsAccess);
+
+        ASSERT_TRUE(cache.enable(mPath, 1000));
+
+        put(cache, 1, 100);
+        put(cache, 2, 200);
+    }
+
+    // Make sure attribute 1 is the least recently used.
+    handle fah = 1;
+    auto path = mPath;
+
+    path.appendWithSeparator(LocalPath::fromRelativePath(std::string(Base64Str<sizeof(fah)>((const byte*)&fah)) + ".0"), false);
+    ASSERT_TRUE(mFsAccess.setmtimelocal(path, m_time() - 60));
+
+    FileAttributeCache cache(mFsAccess);
+    std::string data;
+
+    // Only what fits in the new budget is kept.
+    ASSERT_TRUE(cache.enable(mPath, 250));
+
+    EXPECT_EQ(cache.size(), 200);
+    EXPECT_TRUE(cache.get(2, GfxProc::THUMBNAIL, data));
+    EXPECT_EQ(data, std::string(200, 'c'));
+
+    // Disabling the cache doesn't remove it.
+    ASSERT_TRUE(cache.enable(LocalPath(), 0));
+    EXPECT_FALSE(cache.enabled());
+    EXPECT_FALSE(cache.get(2, GfxProc::THUMBNAIL, data));
+}
+
+TEST_F(FileAttributeCacheTest, IgnoresForeignFiles)
+{
+    {
+        FileAttributeCache cache(mFsAccess);
+
+        ASSERT_TRUE(cache.enable(mPath, 1000));
+
+        put(cache, 1, 100);
+    }
+
+    // Files that don't look like attributes must never be adopted.
+    std::string data(500, 'x');
+
+    for (auto name : {"notes.txt", "AAAAAAAAAAA.x", "AAAAAAAAAAA.99999"})
+    {
+        auto path = mPath;
+
+        path.appendWithSeparator(LocalPath::fromRelativePath(name), false);
+
+        auto fa = mFsAccess.newfileaccess();
+
+        ASSERT_TRUE(fa->fopen(path, false, true, FSLogging::logOnError));
+        ASSERT_TRUE(fa->fwrite(reinterpret_cast<const byte*>(data.data()),
+                               static_cast<unsigned>(data.size()),
+                               0));
+    }
+
+    FileAttributeCache cache(mFsAccess);
+
+    // A budget that the foreign files would exceed.
+    ASSERT_TRUE(cache.enable(mPath, 150));
+    EXPECT_EQ(cache.size(), 100);
+    EXPECT_TRUE(cache.get(1, GfxProc::THUMBNAIL, data));
+
+    // Filling the cache doesn't evict the foreign files either.
+    put(cache, 2, 100);
+
+    for (auto name : {"notes.txt", "AAAAAAAAAAA.x", "AAAAAAAAAAA.99999"})
+    {
+        auto path = mPath;
+
+        path.appendWithSeparator(LocalPath::fromRelativePath(name), false);
+
+        EXPECT_TRUE(mFsAccess.newfileaccess()->isfile(path)) << name;
+    }
+}
+
+TEST_F(FileAttributeCacheTest, SkipsAttributesThatFailedToDecrypt)
+{
+    struct App
+      : MegaApp
+    {
+        void fa_complete(handle, fatype, const char*, uint32_t) override
+        {
+            ++numCompleted;
+        }
+
+        int numCompleted = 0;
+    } app;
+
+    auto client = mt::makeClient(app);
+
+    ASSERT_TRUE(client->faCache.enable(mPath, 1000));
+
+    FileAttributeFetchChannel channel(client.get());
+    FileAttributeFetch fetch(1, std::string(FILENODEKEYLENGTH, 'k'), GfxProc::THUMBNAIL, 0);
+    std::string data(32, 'a');
+
+    // The application still hears about the attribute but it isn't cached.
+    channel.complete(2, fetch, false, data.data(), static_cast<uint32_t>(data.size()));
+
+    EXPECT_EQ(app.numCompleted, 1);
+    EXPECT_EQ(client->faCache.size(), 0);
+    EXPECT_FALSE(client->faCache.get(2, GfxProc::THUMBNAIL, data));
+
+    // Attributes that were decrypted are cached.
+    channel.complete(3, fetch, true, data.data(), static_cast<uint32_t>(data.size()));
+
+    EXPECT_EQ(app.numCompleted, 2);
+    EXPECT_EQ(client->faCache.size(), 32);
+
+    std::string cached;
+
+    ASSERT_TRUE(client->faCache.get(3, GfxProc::THUMBNAIL, cached));
+    EXPECT_EQ(cached, data);
+}
+
+} // FileAttributeCacheTests
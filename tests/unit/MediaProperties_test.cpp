@@ -17,9 +17,13 @@
  */
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include <gtest/gtest.h>
 
+#include <mega/logging.h>
 #include <mega/mediafileattribute.h>
 
 namespace
@@ -87,3 +91,70 @@ TEST(MediaProperties, unserialize_32bit)
     const mega::MediaProperties newMp{d};
     checkMediaProperties(mp, newMp);
 }
+
+#ifdef USE_MEDIAINFO
+
+TEST(MediaProperties, extraction_does_not_block_caller)
+{
+    using namespace std::chrono;
+    using mega::MediaPropertiesExtractor;
+
+    constexpr unsigned numFiles = 20;
+    constexpr unsigned numThreads = 2;
+
+    std::atomic<unsigned> active{0};
+    std::atomic<unsigned> maxActive{0};
+
+    // Pretend each file takes a while to examine.
+    auto extract = [&](MediaPropertiesExtractor::Job& job, mega::FileSystemAccess&) {
+        auto current = ++active;
+        auto seen = maxActive.load();
+
+        while (current > seen && !maxActive.compare_exchange_weak(seen, current))
+            ;
+
+        std::this_thread::sleep_for(milliseconds(100));
+        job.vp.width = job.fakey[0];
+        --active;
+    };
+
+    MediaPropertiesExtractor extractor(nullptr, numThreads, extract);
+
+    auto began = steady_clock::now();
+
+    for (unsigned i = 0; i < numFiles; ++i)
+    {
+        std::unique_ptr<MediaPropertiesExtractor::Job> job(new MediaPropertiesExtractor::Job());
+        job->fakey[0] = i;
+        extractor.push(std::move(job));
+    }
+
+    // This is how long the client's exec loop would have been held up.
+    auto stall = steady_clock::now() - began;
+
+    std::vector<bool> received(numFiles);
+    unsigned numReceived = 0;
+
+    while (numReceived < numFiles && steady_clock::now() - began < seconds(30))
+    {
+        if (auto job = extractor.pop())
+        {
+            ASSERT_LT(job->vp.width, numFiles);
+            ASSERT_FALSE(received[job->vp.width]);
+            received[job->vp.width] = true;
+            ++numReceived;
+            continue;
+        }
+
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+
+    LOG_info << "Queueing " << numFiles << " media extraction(s) stalled the caller for "
+             << duration_cast<microseconds>(stall).count() << "us";
+
+    EXPECT_EQ(numReceived, numFiles);
+    EXPECT_LE(maxActive.load(), numThreads);
+    EXPECT_LT(stall, milliseconds(100));
+}
+
+#endif // USE_MEDIAINFO
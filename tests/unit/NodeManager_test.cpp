@@ -0,0 +1,639 @@
+/**
+ * @file NodeManager_test.cpp
+ * @brief Unit tests for node searches and recent actions served from the account database
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <chrono>
+#include <fstream>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include <mega/megaclient.h>
+#include <mega/megaapp.h>
+#include <mega/utils.h>
+
+#include "utils.h"
+#include "mega.h"
+
+namespace NodeManagerTests
+{
+
+using namespace mega;
+
+class NodeManagerTest
+  : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto dbAccess = new SqliteDbAccess(LocalPath::fromAbsolutePath("."));
+
+        client = mt::makeClient(app, dbAccess);
+        client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+        // So our database doesn't collide with the one used by other tests.
+        client->sid[24] = 'N';
+        client->sid[25] = 'M';
+
+        client->opensctable();
+        client->mNodeManager.setCacheLRUMaxSize(LRU_SIZE);
+
+        root = add(ROOTNODE, NodeHandle(), "", true);
+        folderA = add(FOLDERNODE, root, "A", true);
+        folderB = add(FOLDERNODE, root, "B", true);
+    }
+
+    void TearDown() override
+    {
+        client->removeCaches();
+    }
+
+    // Add a node to the node manager and persist it to the database.
+    //
+    // Nodes that aren't kept are only written to the database.
+    NodeHandle add(nodetype_t type,
+                   NodeHandle parent,
+                   const std::string& name,
+                   bool keep,
+                   m_off_t size = -1,
+                   const NodeCounter& counter = NodeCounter())
+    {
+        auto parentNode = client->mNodeManager.getNodeByHandle(parent);
+        auto& node = mt::makeNode(*client, type, NodeHandle().set6byte(mNextHandle++), parentNode.get());
+
+        if (!name.empty())
+        {
+            node.attrs.map['n'] = name;
+        }
+
+        // A file's fingerprint is determined by its size.
+        node.size = size;
+        node.setCounter(counter);
+
+        auto handle = node.nodeHandle();
+        std::shared_ptr<Node> owner(&node);
+
+        client->mNodeManager.addNode(owner, keep, !keep, mMissingParentNodes);
+        client->mNodeManager.saveNodeInDb(&node);
+
+        return handle;
+    }
+
+    // Add a file created at ctime below parent.
+    //
+    // Persisted files are only written to the database, like add() does
+    // with nodes that aren't kept. The others only exist in memory.
+    std::shared_ptr<Node> addRecent(NodeHandle parent, m_time_t ctime, bool persist = true)
+    {
+        auto parentNode = client->mNodeManager.getNodeByHandle(parent);
+        auto handle = NodeHandle().set6byte(mNextHandle++);
+        auto& node = mt::makeNode(*client, FILENODE, handle, parentNode.get());
+
+        node.attrs.map['n'] = "file-" + std::to_string(handle.as8byte()) + ".txt";
+        node.ctime = ctime;
+
+        std::shared_ptr<Node> owner(&node);
+
+        client->mNodeManager.addNode(owner, false, persist, mMissingParentNodes);
+
+        if (persist)
+        {
+            client->mNodeManager.saveNodeInDb(&node);
+        }
+
+        return owner;
+    }
+
+    // Count the nodes across all of the recent action buckets.
+    static size_t count(const recentactions_vector& actions)
+    {
+        size_t numNodes = 0;
+
+        for (auto& action : actions)
+        {
+            numNodes += action.nodes.size();
+        }
+
+        return numNodes;
+    }
+
+    // Add numFiles matching files below parent and return their handles.
+    std::set<NodeHandle> populate(NodeHandle parent, unsigned int numFiles)
+    {
+        std::set<NodeHandle> handles;
+
+        for (auto i = 0u; i < numFiles; ++i)
+        {
+            auto name = "img-" + std::to_string(mNextHandle) + ".jpg";
+
+            handles.emplace(add(FILENODE, parent, name, false));
+        }
+
+        return handles;
+    }
+
+    // Search for "img" below ancestor and return the handles we found.
+    std::set<NodeHandle> search(NodeHandle ancestor)
+    {
+        auto nodes = client->mNodeManager.search(ancestor,
+                                                 "img",
+                                                 true,
+                                                 Node::Flags(),
+                                                 Node::Flags(),
+                                                 Node::Flags(),
+                                                 CancelToken());
+
+        std::set<NodeHandle> handles;
+
+        for (auto& node : nodes)
+        {
+            handles.emplace(node->nodeHandle());
+        }
+
+        return handles;
+    }
+
+    // List parent's children, optionally as snapshots.
+    sharedNode_vector children(NodeHandle parent, bool snapshots)
+    {
+        NodeSearchFilter filter;
+
+        filter.byAncestors({parent.as8byte(), UNDEF, UNDEF});
+
+        return client->mNodeManager.getChildren(filter,
+                                                0,
+                                                CancelToken(),
+                                                NodeSearchPage(0, 0),
+                                                snapshots);
+    }
+
+    static constexpr uint32_t LRU_SIZE = 8;
+
+    MegaApp app;
+    std::shared_ptr<MegaClient> client;
+    NodeHandle root;
+    NodeHandle folderA;
+    NodeHandle folderB;
+
+private:
+    NodeManager::MissingParentNodes mMissingParentNodes;
+    uint64_t mNextHandle = 1;
+}; // NodeManagerTest
+
+TEST_F(NodeManagerTest, SearchIsLimitedToSubtree)
+{
+    auto expected = populate(folderA, 600);
+    auto nested = add(FOLDERNODE, folderA, "nested", false);
+
+    // Files below a nested folder are still below A.
+    auto deeper = populate(nested, 300);
+    expected.insert(deeper.begin(), deeper.end());
+
+    // Files below B should never be reported.
+    auto unexpected = populate(folderB, 600);
+
+    // Most of the matching files are only present in the database.
+    ASSERT_LT(client->mNodeManager.getNumberNodesInRam(), expected.size());
+
+    EXPECT_EQ(search(folderA), expected);
+    EXPECT_EQ(search(folderB), unexpected);
+    EXPECT_EQ(search(nested), deeper);
+
+    expected.insert(unexpected.begin(), unexpected.end());
+
+    EXPECT_EQ(search(root), expected);
+}
+
+TEST_F(NodeManagerTest, SnapshotsAreNotCached)
+{
+    auto expected = populate(folderA, 100);
+    auto inRAM = client->mNodeManager.getNumberNodesInRam();
+
+    {
+        auto nodes = children(folderA, true);
+
+        std::set<NodeHandle> found;
+
+        for (auto& node : nodes)
+        {
+            // Snapshots carry the node's data and know their parent.
+            EXPECT_EQ(node->displayname(), "img-" + std::to_string(node->nodeHandle().as8byte()) + ".jpg");
+            ASSERT_TRUE(node->parent);
+            EXPECT_EQ(node->parent->nodeHandle(), folderA);
+
+            found.emplace(node->nodeHandle());
+        }
+
+        EXPECT_EQ(found, expected);
+
+        // Snapshots aren't counted as nodes in memory, even while they're alive.
+        EXPECT_EQ(client->mNodeManager.getNumberNodesInRam(), inRAM);
+    }
+
+    // Nothing was loaded into memory by the listing.
+    EXPECT_EQ(client->mNodeManager.getNumberNodesInRam(), inRAM);
+
+    // Whereas a regular listing loads every child.
+    EXPECT_EQ(children(folderA, false).size(), expected.size());
+    EXPECT_GT(client->mNodeManager.getNumberNodesInRam(), inRAM);
+}
+
+TEST_F(NodeManagerTest, FolderSnapshotsCarryCounter)
+{
+    NodeCounter counter;
+
+    counter.files = 3;
+    counter.folders = 2;
+    counter.storage = 4096;
+    counter.versions = 1;
+    counter.versionStorage = 1024;
+
+    auto folder = add(FOLDERNODE, folderA, "C", false, -1, counter);
+
+    auto nodes = children(folderA, true);
+
+    ASSERT_EQ(nodes.size(), 1u);
+    EXPECT_TRUE(nodes[0]->mIsSnapshot);
+    EXPECT_EQ(nodes[0]->nodeHandle(), folder);
+
+    // A folder's size and content are only known from its counter.
+    EXPECT_EQ(nodes[0]->getCounter().serialize(), counter.serialize());
+}
+
+// A fingerprint matching files added with the specified size.
+static FileFingerprint fingerprint(m_off_t size)
+{
+    FileFingerprint fingerprint;
+
+    fingerprint.size = size;
+
+    return fingerprint;
+}
+
+TEST_F(NodeManagerTest, FingerprintFilter)
+{
+    for (auto i = 0; i < 100; ++i)
+    {
+        add(FILENODE, folderA, "file", false, 1000 + i);
+    }
+
+    // Builds the filter.
+    client->mNodeManager.initCompleted();
+
+    auto present = fingerprint(1050);
+    auto absent = fingerprint(5);
+
+    EXPECT_TRUE(client->mNodeManager.getNodeByFingerprint(present));
+    EXPECT_FALSE(client->mNodeManager.getNodeByFingerprint(absent));
+
+    auto stats = client->mNodeManager.getFingerprintFilterStats();
+
+    EXPECT_GT(stats.memory, 0u);
+    EXPECT_EQ(stats.lookups, 2u);
+    EXPECT_EQ(stats.negatives + stats.falsePositives, 1u);
+
+    // Files added after the filter was built are found, too.
+    auto added = add(FILENODE, folderB, "file", false, 5);
+    auto nodes = client->mNodeManager.getNodesByFingerprint(absent);
+
+    ASSERT_EQ(nodes.size(), 1u);
+    EXPECT_EQ(nodes.front()->nodeHandle(), added);
+}
+
+TEST_F(NodeManagerTest, DISABLED_FingerprintFilterBenchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numFiles = 200000;
+    constexpr auto numLookups = 100000;
+
+    client->sctable->begin();
+
+    for (auto i = 0; i < numFiles; ++i)
+    {
+        add(FILENODE, folderA, "file", false, i);
+    }
+
+    client->sctable->commit();
+    client->mNodeManager.initCompleted();
+
+    auto found = 0u;
+    auto began = steady_clock::now();
+
+    // Mostly look up fingerprints that aren't in the account, like
+    // upload and sync dedup checks do.
+    for (auto i = 0; i < numLookups; ++i)
+    {
+        auto target = fingerprint(i % 10 ? numFiles + i : i);
+
+        found += !!client->mNodeManager.getNodeByFingerprint(target);
+    }
+
+    auto elapsed = steady_clock::now() - began;
+    auto stats = client->mNodeManager.getFingerprintFilterStats();
+
+    LOG_info << numLookups
+             << " fingerprint look-up(s) against "
+             << numFiles
+             << " file(s) took "
+             << duration_cast<milliseconds>(elapsed).count()
+             << "ms: "
+             << found
+             << " found, "
+             << stats.negatives
+             << " answered by the filter, "
+             << stats.falsePositives
+             << " false positive(s), filter uses "
+             << stats.memory
+             << " bytes";
+
+    EXPECT_EQ(found, static_cast<unsigned>(numLookups / 10));
+}
+
+// Resident set size of this process, in kilobytes (0 if unknown).
+static uint64_t residentSetSize()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+
+    if (statm >> size >> resident)
+    {
+        return resident * 4;
+    }
+#endif // __linux__
+
+    return 0;
+}
+
+TEST_F(NodeManagerTest, DISABLED_FolderWalkBenchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numFiles = 500000u;
+    constexpr auto numHotNodes = 1000u;
+
+    client->sctable->begin();
+
+    // Nodes the application works with regularly.
+    auto hot = populate(folderB, numHotNodes);
+    populate(folderA, numFiles);
+
+    client->sctable->commit();
+
+    client->mNodeManager.setCacheLRUMaxSize(numHotNodes * 2);
+
+    // Snapshots go first so that their walk starts from a fresh heap.
+    for (auto snapshots : {true, false})
+    {
+        for (auto& handle : hot)
+        {
+            client->mNodeManager.getNodeByHandle(handle);
+        }
+
+        auto rssBefore = residentSetSize();
+        auto began = steady_clock::now();
+
+        // Page through the folder once.
+        auto numListed = children(folderA, snapshots).size();
+
+        auto elapsed = steady_clock::now() - began;
+        auto rssAfter = residentSetSize();
+
+        // A hot node that has to be loaded again is a cache miss.
+        auto hits = 0u;
+
+        for (auto& handle : hot)
+        {
+            auto inRAM = client->mNodeManager.getNumberNodesInRam();
+
+            client->mNodeManager.getNodeByHandle(handle);
+
+            hits += client->mNodeManager.getNumberNodesInRam() == inRAM;
+        }
+
+        LOG_info << (snapshots ? "Snapshot" : "Regular")
+                 << " walk of "
+                 << numListed
+                 << " node(s) took "
+                 << duration_cast<milliseconds>(elapsed).count()
+                 << "ms, RSS grew by "
+                 << static_cast<int64_t>(rssAfter - rssBefore)
+                 << "KB, "
+                 << client->mNodeManager.getNumberNodesInRam()
+                 << " node(s) in RAM, hot set hit rate "
+                 << hits * 100 / numHotNodes
+                 << "%";
+
+        EXPECT_EQ(numListed, numFiles);
+    }
+}
+
+TEST_F(NodeManagerTest, DISABLED_SearchBenchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numFiles = 100000u;
+
+    client->sctable->begin();
+
+    auto expected = populate(folderA, numFiles);
+    populate(folderB, numFiles / 10);
+
+    client->sctable->commit();
+
+    auto began = steady_clock::now();
+    auto found = search(folderA);
+    auto elapsed = steady_clock::now() - began;
+
+    LOG_info << "Search below a folder returned "
+             << found.size()
+             << " of "
+             << numFiles + numFiles / 10
+             << " matching node(s) in "
+             << duration_cast<milliseconds>(elapsed).count()
+             << "ms";
+
+    EXPECT_EQ(found, expected);
+}
+
+TEST_F(NodeManagerTest, RecentActionsFollowNodeChanges)
+{
+    auto oldest = addRecent(folderA, 1000);
+
+    for (auto ctime = 2000; ctime <= 5000; ctime += 1000)
+    {
+        addRecent(folderA, ctime);
+    }
+
+    auto actions = client->getRecentActions(0, 0);
+
+    ASSERT_EQ(actions.size(), 1u);
+    EXPECT_EQ(actions[0].time, 5000);
+    EXPECT_EQ(actions[0].parent, folderA.as8byte());
+    EXPECT_EQ(actions[0].nodes.size(), 5u);
+
+    // Only the feed knows about this file as it was never written to the database.
+    auto added = addRecent(folderB, 6000, false);
+
+    added->changed.newnode = true;
+    client->updateRecentActions({added});
+
+    actions = client->getRecentActions(0, 0);
+
+    ASSERT_EQ(actions.size(), 2u);
+    EXPECT_EQ(actions[0].time, 6000);
+    EXPECT_EQ(actions[0].parent, folderB.as8byte());
+    ASSERT_EQ(actions[0].nodes.size(), 1u);
+    EXPECT_EQ(actions[0].nodes[0], added);
+    EXPECT_EQ(actions[1].nodes.size(), 5u);
+
+    // Removals are applied to the feed too.
+    oldest->changed.removed = true;
+    client->updateRecentActions({oldest});
+
+    actions = client->getRecentActions(0, 0);
+
+    EXPECT_EQ(count(actions), 5u);
+    EXPECT_EQ(count(client->getRecentActions(0, 2500)), 4u);
+    oldest->changed.removed = false;
+
+    // Moving a folder reloads the feed from the database.
+    auto folder = client->mNodeManager.getNodeByHandle(folderB);
+
+    folder->changed.parent = true;
+    client->updateRecentActions({folder});
+    folder->changed.parent = false;
+
+    actions = client->getRecentActions(0, 0);
+
+    ASSERT_EQ(actions.size(), 1u);
+    EXPECT_EQ(actions[0].nodes.size(), 5u);
+    EXPECT_EQ(actions[0].nodes.back()->nodeHandle(), oldest->nodeHandle());
+}
+
+TEST_F(NodeManagerTest, RecentActionsFollowNewVersions)
+{
+    auto previous = addRecent(folderA, 1000);
+    auto current = addRecent(folderA, 2000);
+
+    auto actions = client->getRecentActions(0, 0);
+
+    ASSERT_EQ(actions.size(), 1u);
+    EXPECT_FALSE(actions[0].updated);
+    EXPECT_EQ(actions[0].nodes.size(), 2u);
+
+    // The previous file becomes a version of the current one.
+    previous->setparent(current, false);
+    client->mNodeManager.saveNodeInDb(previous.get());
+
+    // Only the version is notified: the current file must be reinserted
+    // so that its count of versions is brought up to date.
+    previous->changed.parent = true;
+    client->updateRecentActions({previous});
+    previous->changed.parent = false;
+
+    actions = client->getRecentActions(0, 0);
+
+    ASSERT_EQ(actions.size(), 1u);
+    EXPECT_EQ(actions[0].time, 2000);
+    EXPECT_TRUE(actions[0].updated);
+    ASSERT_EQ(actions[0].nodes.size(), 1u);
+    EXPECT_EQ(actions[0].nodes[0]->nodeHandle(), current->nodeHandle());
+}
+
+TEST_F(NodeManagerTest, DISABLED_RecentActionsBenchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numFiles = 500000u;
+    constexpr auto numRefreshes = 10u;
+    constexpr m_time_t now = 1700000000;
+
+    // A file every five seconds, so all of them fall in the last 30 days.
+    client->sctable->begin();
+
+    for (auto i = 0u; i < numFiles; ++i)
+    {
+        auto parent = i % 2 ? folderA : folderB;
+
+        addRecent(parent, now - static_cast<m_time_t>(numFiles - i) * 5, true);
+    }
+
+    client->sctable->commit();
+
+    for (auto maxcount : {500u, 10000u, 0u})
+    {
+        auto since = now - 30 * 86400;
+
+        // Rebuild the feed from scratch after every change, as we used to.
+        auto began = steady_clock::now();
+
+        for (auto i = 0u; i < numRefreshes; ++i)
+        {
+            client->invalidateRecentActions();
+            client->getRecentActions(maxcount, since);
+        }
+
+        auto rebuilt = steady_clock::now() - began;
+
+        // Apply each change to the feed instead.
+        auto latest = now;
+
+        began = steady_clock::now();
+
+        for (auto i = 0u; i < numRefreshes; ++i)
+        {
+            auto added = addRecent(folderA, ++latest, false);
+
+            added->changed.newnode = true;
+            client->updateRecentActions({added});
+            client->getRecentActions(maxcount, since);
+        }
+
+        auto updated = steady_clock::now() - began;
+
+        LOG_info << "Recent actions of "
+                 << numFiles
+                 << " file(s), at most "
+                 << maxcount
+                 << " node(s): rebuilt "
+                 << duration_cast<microseconds>(rebuilt).count() / numRefreshes
+                 << "us, updated "
+                 << duration_cast<microseconds>(updated).count() / numRefreshes
+                 << "us per refresh";
+
+        // Files that were never persisted are gone once the feed is reloaded.
+        auto expected = maxcount ? maxcount : numFiles + numRefreshes;
+
+        EXPECT_EQ(count(client->getRecentActions(maxcount, since)), expected);
+    }
+}
+
+} // NodeManagerTests
@@ -307,7 +307,7 @@ TEST(Serialization, Node_forFile_withoutParent_withoutShares_withoutAttrs_withou
     n->ctime = 44;
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(90u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 90u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -321,7 +321,7 @@ TEST(Serialization, Node_forFolder_withoutParent_withoutShares_withoutAttrs_with
     n->ctime = 44;
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(71u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 71u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -336,7 +336,7 @@ TEST(Serialization, Node_forFile_withoutShares_withoutAttrs_withoutFileAttrStrin
     n->ctime = 44;
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(90u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 90u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -355,7 +355,7 @@ TEST(Serialization, Node_forFile_withoutShares_withoutFileAttrString_withoutPlin
     };
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(104u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 104u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -375,7 +375,7 @@ TEST(Serialization, Node_forFile_withoutShares_withoutPlink)
     n->fileattrstring = "blah";
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(108u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 108u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -396,7 +396,7 @@ TEST(Serialization, Node_forFile_withoutShares)
     n->plink.reset(new mega::PublicLink{n->nodehandle, 1, 2, false});
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(131u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 131u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -418,7 +418,7 @@ TEST(Serialization, Node_forFile_withoutShares_withAuthKey)
     n->plink.reset(new mega::PublicLink{n->nodehandle, 1, 2, false, "someAuthKey"});
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(142u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 142u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -468,7 +468,7 @@ TEST(Serialization, Node_forFolder_withoutShares_withoutAttrs_withoutFileAttrStr
     n->ctime = 44;
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(71u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 71u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -487,7 +487,7 @@ TEST(Serialization, Node_forFolder_withoutShares_withoutFileAttrString_withoutPl
     };
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(85u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 85u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n);
 }
@@ -507,7 +507,7 @@ TEST(Serialization, Node_forFolder_withoutShares_withoutPlink)
     n->fileattrstring = "blah";
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
-    ASSERT_EQ(85u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 85u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n, true);
 }
@@ -529,11 +529,91 @@ TEST(Serialization, Node_forFolder_withoutShares)
     std::string data;
     ASSERT_TRUE(n->serialize(&data));
 
-    ASSERT_EQ(108u, data.size());
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + 108u, data.size());
     auto dn = client.cli->mNodeManager.getNodeFromBlob(&data);
     checkDeserializedNode(*dn, *n, true);
 }
 
+TEST(Serialization, Node_fromLegacyRecord_isUpgradedWhenSaved)
+{
+    MockClient client;
+    auto& parent = mt::makeNode(*client.cli, mega::FOLDERNODE, ::mega::NodeHandle().set6byte(43));
+    std::unique_ptr<mega::Node> n{&mt::makeNode(*client.cli, mega::FILENODE, ::mega::NodeHandle().set6byte(42), &parent)};
+    n->size = 12;
+    n->owner = 88;
+    n->ctime = 44;
+    n->attrs.map = std::map<mega::nameid, std::string>{
+        {mega::AttrMap::string2nameid("lbl"), "3"},
+    };
+    n->fileattrstring = "blah";
+    n->plink.reset(new mega::PublicLink{n->nodehandle, 1, 2, false});
+
+    // This is a record without a header, as cached by DB version 14
+    const std::array<char, 124> rawData = {
+        0x0c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2a, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x2b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x58, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x2c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x58, 0x58, 0x58, 0x58,
+        0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58,
+        0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58,
+        0x58, 0x58, 0x58, 0x58, 0x05, 0x00, 0x62, 0x6c, 0x61, 0x68, 0x00, 0x01,
+        0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6c, 0x62,
+        0x6c, 0x01, 0x00, 0x33, 0x00, 0x2a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00
+    };
+    const std::string legacyData(rawData.data(), rawData.size());
+
+    mega::NodeData legacy(legacyData.data(), legacyData.size(), mega::NodeData::COMPONENT_LABEL);
+    EXPECT_EQ(3, legacy.getLabel());
+
+    auto dn = client.cli->mNodeManager.getNodeFromBlob(&legacyData);
+    ASSERT_TRUE(dn);
+    checkDeserializedNode(*dn, *n);
+
+    // Saving the node again writes a header in front of the same body.
+    std::string data;
+    ASSERT_TRUE(dn->serialize(&data));
+    ASSERT_EQ(mega::NodeData::RECORD_HEADER_SIZE + legacyData.size(), data.size());
+    EXPECT_EQ(legacyData, data.substr(mega::NodeData::RECORD_HEADER_SIZE));
+}
+
+TEST(Serialization, NodeData_readsAttributesViaOffsetTable)
+{
+    MockClient client;
+    auto& parent = mt::makeNode(*client.cli, mega::FOLDERNODE, ::mega::NodeHandle().set6byte(43));
+    std::unique_ptr<mega::Node> n{&mt::makeNode(*client.cli, mega::FILENODE, ::mega::NodeHandle().set6byte(42), &parent)};
+    n->size = 12;
+    n->owner = 88;
+    n->ctime = 44;
+    n->attrs.map = std::map<mega::nameid, std::string>{
+        {mega::AttrMap::string2nameid("lbl"), "3"},
+        {mega::AttrMap::string2nameid(mega::MegaClient::NODE_ATTRIBUTE_DESCRIPTION), "foo"},
+    };
+    n->fileattrstring = "blah";
+    n->plink.reset(new mega::PublicLink{n->nodehandle, 1, 2, false, "someAuthKey"});
+    std::string data;
+    ASSERT_TRUE(n->serialize(&data));
+
+    // Only the attributes are read when the record has an offset table.
+    mega::NodeData current(data.data(), data.size(), mega::NodeData::COMPONENT_LABEL);
+    EXPECT_EQ(3, current.getLabel());
+    EXPECT_EQ("foo", current.getDescription());
+
+    // The record's body is identical to a legacy record.
+    const auto* body = data.data() + mega::NodeData::RECORD_HEADER_SIZE;
+    const auto size = data.size() - mega::NodeData::RECORD_HEADER_SIZE;
+
+    mega::NodeData legacy(body, size, mega::NodeData::COMPONENT_LABEL);
+    EXPECT_EQ(3, legacy.getLabel());
+    EXPECT_EQ("foo", legacy.getDescription());
+
+    const std::string legacyData(body, size);
+    auto dn = client.cli->mNodeManager.getNodeFromBlob(&legacyData);
+    ASSERT_TRUE(dn);
+    checkDeserializedNode(*dn, *n);
+}
+
 TEST(Serialization, Node_forFolder_withoutShares_32bit)
 {
     MockClient client;
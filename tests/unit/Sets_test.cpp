@@ -0,0 +1,192 @@
+/**
+ * @file Sets_test.cpp
+ * @brief Unit tests for Sets and their Elements
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mega/megaapp.h>
+#include <mega/megaclient.h>
+
+#include "utils.h"
+#include "mega.h"
+
+namespace SetsTests
+{
+
+using namespace mega;
+
+class SetsTest
+  : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        client = mt::makeClient(app);
+    }
+
+    // Add a Set to the client.
+    handle addSet()
+    {
+        auto sid = mNextHandle++;
+
+        client->addSet(Set(sid, UNDEF, std::string(FILENODEKEYLENGTH, 'k'), UNDEF, string_map()));
+
+        return sid;
+    }
+
+    // Add an Element representing node to the Set sid.
+    handle addElement(handle sid, handle node)
+    {
+        auto eid = mNextHandle++;
+
+        client->addOrUpdateSetElement(SetElement(sid, node, eid, std::string(FILENODEKEYLENGTH, 'k'), string_map()));
+
+        return eid;
+    }
+
+    MegaApp app;
+    std::shared_ptr<MegaClient> client;
+
+private:
+    handle mNextHandle = 1;
+}; // SetsTest
+
+TEST_F(SetsTest, ElementsAreIndexedByNode)
+{
+    constexpr handle photo = 0x1234;
+    constexpr handle other = 0x5678;
+
+    auto album0 = addSet();
+    auto album1 = addSet();
+
+    auto element0 = addElement(album0, photo);
+    addElement(album0, other);
+    addElement(album1, photo);
+
+    client->notifypurge();
+
+    auto elements = client->getSetElementsByNode(photo);
+
+    ASSERT_EQ(elements.size(), 2u);
+    EXPECT_EQ(elements[0]->node(), photo);
+    EXPECT_EQ(elements[1]->node(), photo);
+    EXPECT_NE(elements[0]->set(), elements[1]->set());
+
+    EXPECT_TRUE(client->getSetElementsByNode(0x9abc).empty());
+
+    // Removed Elements are dropped from the index.
+    client->deleteSetElement(album0, element0);
+    client->notifypurge();
+
+    elements = client->getSetElementsByNode(photo);
+
+    ASSERT_EQ(elements.size(), 1u);
+    EXPECT_EQ(elements[0]->set(), album1);
+
+    // As are the Elements of removed Sets.
+    client->deleteSet(album1);
+    client->notifypurge();
+
+    EXPECT_TRUE(client->getSetElementsByNode(photo).empty());
+    EXPECT_EQ(client->getSetElementsByNode(other).size(), 1u);
+}
+
+TEST_F(SetsTest, DISABLED_Benchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numSets = 100u;
+    constexpr auto numElements = 100000u;
+    constexpr auto numNodes = numElements / 2;
+
+    client = mt::makeClient(app, new SqliteDbAccess(LocalPath::fromAbsolutePath(".")));
+    client->sid = "AWA5YAbtb4JO-y2zWxmKZpSe5-6XM7CTEkA-3Nv7J4byQUpOazdfSC1ZUFlS-kah76gPKUEkTF9g7MeE";
+
+    // So our database doesn't collide with the one used by other tests.
+    client->sid[24] = 'S';
+    client->sid[25] = 'E';
+
+    client->opensctable();
+    client->sctable->begin();
+
+    std::vector<handle> sets;
+
+    for (auto i = 0u; i < numSets; ++i)
+    {
+        sets.emplace_back(addSet());
+    }
+
+    // Each node is in two albums.
+    for (auto i = 0u; i < numElements; ++i)
+    {
+        addElement(sets[i % numSets], i % numNodes + 1);
+    }
+
+    client->notifypurge();
+
+    auto began = steady_clock::now();
+
+    client->initsc();
+
+    auto persisted = steady_clock::now();
+    auto found = 0u;
+
+    for (auto node = 1u; node <= numNodes; ++node)
+    {
+        found += static_cast<unsigned>(client->getSetElementsByNode(node).size());
+    }
+
+    auto queried = steady_clock::now();
+
+    // Removing a Set drops all of its Elements.
+    for (auto sid : sets)
+    {
+        client->deleteSet(sid);
+    }
+
+    client->notifypurge();
+
+    auto removed = steady_clock::now();
+
+    LOG_info << "Persisting "
+             << numElements
+             << " Element(s) took "
+             << duration_cast<milliseconds>(persisted - began).count()
+             << "ms, "
+             << numNodes
+             << " look-up(s) by node took "
+             << duration_cast<milliseconds>(queried - persisted).count()
+             << "ms, removing "
+             << numSets
+             << " Set(s) took "
+             << duration_cast<milliseconds>(removed - queried).count()
+             << "ms";
+
+    EXPECT_EQ(found, numElements);
+
+    client->removeCaches();
+}
+
+} // SetsTests
@@ -0,0 +1,475 @@
+/**
+ * @file Sqlite_test.cpp
+ * @brief Unit tests for the SQLite DB access layer
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include <mega/db.h>
+#include <mega/db/sqlite.h>
+#include <mega/megaapp.h>
+#include <mega/megaclient.h>
+#include "megafs.h"
+
+#include "utils.h"
+
+using namespace mega;
+using namespace std;
+
+class SqliteDBTest
+  : public ::testing::Test
+{
+public:
+        SqliteDBTest()
+          : Test()
+          , fsAccess()
+          , name("test")
+          , rng()
+          , rootPath(LocalPath::fromAbsolutePath("."))
+        {
+            // Get the current path.
+            bool result = fsAccess.cwd(rootPath);
+            if (!result)
+                assert(result);
+
+            // Create temporary DB root path.
+            rootPath.appendWithSeparator(
+                LocalPath::fromRelativePath("db"), false);
+
+            // Make sure our root path is clear.
+            fsAccess.emptydirlocal(rootPath);
+            fsAccess.rmdirlocal(rootPath);
+
+            // Create root path.
+            result = fsAccess.mkdirlocal(rootPath, false, true);
+            if (!result)
+                assert(result);
+        }
+
+        ~SqliteDBTest()
+        {
+            // Remove temporary root path.
+            fsAccess.emptydirlocal(rootPath);
+
+            bool result = fsAccess.rmdirlocal(rootPath);
+            if (!result)
+                assert(result);
+        }
+
+        FSACCESS_CLASS fsAccess;
+        string name;
+        PrnGen rng;
+        LocalPath rootPath;
+}; // SqliteDBTest
+
+TEST_F(SqliteDBTest, CreateCurrent)
+{
+    SqliteDbAccess dbAccess(rootPath);
+
+    // Assume databases are in legacy format until proven otherwise.
+    EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::LEGACY_DB_VERSION);
+
+    // Create a new database.
+    DbTablePtr dbTable(dbAccess.openTableWithNodes(rng, fsAccess, name, 0, nullptr));
+
+    // Was the database created successfully?
+    ASSERT_TRUE(!!dbTable);
+
+    // New databases should not be in the legacy format.
+    EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::DB_VERSION);
+
+}
+
+TEST_F(SqliteDBTest, OpenCurrent)
+{
+    // Create a dummy database.
+    {
+        SqliteDbAccess dbAccess(rootPath);
+
+        EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::LEGACY_DB_VERSION);
+
+        DbTablePtr dbTable(dbAccess.openTableWithNodes(rng, fsAccess, name, 0, nullptr));
+        ASSERT_TRUE(!!dbTable);
+
+        EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::DB_VERSION);
+    }
+
+    // Open the database.
+    SqliteDbAccess dbAccess(rootPath);
+
+    EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::LEGACY_DB_VERSION);
+
+    DbTablePtr dbTable(dbAccess.openTableWithNodes(rng, fsAccess, name, 0, nullptr));
+    EXPECT_TRUE(!!dbTable);
+
+    EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::DB_VERSION);
+}
+
+TEST_F(SqliteDBTest, ProbeCurrent)
+{
+    SqliteDbAccess dbAccess(rootPath);
+
+    // Create dummy database.
+    {
+        auto dbFile =
+          dbAccess.databasePath(fsAccess,
+                                name,
+                                DbAccess::DB_VERSION);
+
+        auto fileAccess = fsAccess.newfileaccess(false);
+        EXPECT_TRUE(fileAccess->fopen(dbFile, false, true, FSLogging::logOnError));
+    }
+
+    EXPECT_TRUE(dbAccess.probe(fsAccess, name));
+}
+
+TEST_F(SqliteDBTest, ProbeLegacy)
+{
+    SqliteDbAccess dbAccess(rootPath);
+
+    // Create dummy database.
+    {
+        auto dbFile =
+          dbAccess.databasePath(fsAccess,
+                                name,
+                                DbAccess::LEGACY_DB_VERSION);
+
+        auto fileAccess = fsAccess.newfileaccess(false);
+        EXPECT_TRUE(fileAccess->fopen(dbFile, false, true, FSLogging::logOnError));
+    }
+
+    EXPECT_TRUE(dbAccess.probe(fsAccess, name));
+}
+
+TEST_F(SqliteDBTest, RecycleLegacy)
+{
+    // Node record headers and compression share a single version bump, so
+    // that databases written by the last release are migrated in place.
+    ASSERT_EQ(DbAccess::LEGACY_DB_VERSION, 14);
+    ASSERT_TRUE(DbAccess::legacyDbRecyclable());
+
+    SqliteDbAccess dbAccess(rootPath);
+
+    auto currentPath = dbAccess.databasePath(fsAccess, name, DbAccess::DB_VERSION);
+    auto legacyPath = dbAccess.databasePath(fsAccess, name, DbAccess::LEGACY_DB_VERSION);
+
+    // Create a database and move it to where the last release kept it.
+    {
+        DbTablePtr dbTable(dbAccess.openTableWithNodes(rng, fsAccess, name, 0, nullptr));
+        ASSERT_TRUE(!!dbTable);
+
+        string data = "legacy";
+
+        dbTable->begin();
+        ASSERT_TRUE(dbTable->put(1, &data[0], static_cast<unsigned>(data.size())));
+        dbTable->commit();
+    }
+
+    ASSERT_TRUE(fsAccess.renamelocal(currentPath, legacyPath));
+
+    // Open it again, recycling the legacy database.
+    SqliteDbAccess recycler(rootPath);
+
+    DbTablePtr dbTable(recycler.openTableWithNodes(rng, fsAccess, name, DB_OPEN_FLAG_RECYCLE, nullptr));
+    ASSERT_TRUE(!!dbTable);
+
+    EXPECT_EQ(recycler.currentDbVersion, DbAccess::DB_VERSION);
+    EXPECT_FALSE(fsAccess.fileExistsAt(legacyPath));
+
+    // The legacy database's content has been kept.
+    string data;
+
+    EXPECT_TRUE(dbTable->get(1, &data));
+    EXPECT_EQ(data, "legacy");
+}
+
+TEST_F(SqliteDBTest, ProbeNone)
+{
+    SqliteDbAccess dbAccess(rootPath);
+    EXPECT_FALSE(dbAccess.probe(fsAccess, name));
+}
+
+
+TEST_F(SqliteDBTest, RootPath)
+{
+    SqliteDbAccess dbAccess(rootPath);
+    EXPECT_EQ(dbAccess.rootPath(), rootPath);
+}
+
+class SqliteNodeCompressionTest
+  : public SqliteDBTest
+{
+public:
+    // Prefixes every compressed record.
+    static constexpr m_off_t MARKER = NodeData::RECORD_MARKER + 256;
+
+    // Open the account database.
+    DbTablePtr open(SqliteDbAccess& dbAccess)
+    {
+        return DbTablePtr(dbAccess.openTableWithNodes(rng, fsAccess, name, 0, nullptr));
+    }
+
+    // Store numFiles file nodes below a single folder.
+    void populate(unsigned int numFiles)
+    {
+        SqliteDbAccess dbAccess(rootPath);
+
+        auto table = open(dbAccess);
+        ASSERT_TRUE(table);
+
+        auto nodes = dynamic_cast<DBTableNodes*>(table.get());
+        ASSERT_TRUE(nodes);
+
+        table->begin();
+
+        std::unique_ptr<Node> folder(&mt::makeNode(*client, FOLDERNODE, parentHandle));
+        folder->attrs.map['n'] = "folder";
+
+        ASSERT_TRUE(nodes->put(folder.get()));
+
+        for (auto i = 0u; i < numFiles; ++i)
+        {
+            NodeHandle handle;
+
+            handle.set6byte(parentHandle.as8byte() + 1 + i);
+
+            std::unique_ptr<Node> file(&mt::makeNode(*client, FILENODE, handle, folder.get()));
+
+            file->attrs.map['n'] = "IMG_" + std::to_string(i) + ".jpg";
+            file->attrs.map[AttrMap::string2nameid("lbl")] = std::to_string(i % 7);
+            file->ctime = 1700000000 + i;
+            file->size = 1024 * (i + 1);
+
+            ASSERT_TRUE(nodes->put(file.get()));
+
+            file->serialize(&records[handle]);
+        }
+
+        table->commit();
+    }
+
+    // Retrieve all of the folder's children.
+    void children(SqliteDbAccess& dbAccess,
+                  std::vector<std::pair<NodeHandle, NodeSerialized>>& children)
+    {
+        auto table = open(dbAccess);
+        ASSERT_TRUE(table);
+
+        auto nodes = dynamic_cast<DBTableNodes*>(table.get());
+        ASSERT_TRUE(nodes);
+
+        ASSERT_TRUE(nodes->getChildren(parentHandle, children, CancelToken()));
+    }
+
+    // Retrieve each file's record exactly as it's stored.
+    void stored(SqliteDbAccess& dbAccess, std::map<NodeHandle, string>& blobs)
+    {
+        auto path = dbAccess.databasePath(fsAccess, name, DbAccess::DB_VERSION).toPath(false);
+
+        sqlite3* db = nullptr;
+        ASSERT_EQ(sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr), SQLITE_OK);
+
+        sqlite3_stmt* stmt = nullptr;
+        ASSERT_EQ(sqlite3_prepare_v2(db, "SELECT nodehandle, node FROM nodes", -1, &stmt, nullptr), SQLITE_OK);
+
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            NodeHandle handle;
+
+            handle.set6byte(static_cast<uint64_t>(sqlite3_column_int64(stmt, 0)));
+
+            auto data = static_cast<const char*>(sqlite3_column_blob(stmt, 1));
+            auto size = static_cast<size_t>(sqlite3_column_bytes(stmt, 1));
+
+            if (records.count(handle))
+            {
+                blobs[handle].assign(data, size);
+            }
+        }
+
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+    }
+
+    // How many of blobs are compressed?
+    static size_t numCompressed(const std::map<NodeHandle, string>& blobs)
+    {
+        return static_cast<size_t>(std::count_if(blobs.begin(), blobs.end(), [](const std::pair<const NodeHandle, string>& b) {
+            return b.second.size() >= sizeof(MARKER)
+                   && MemAccess::get<m_off_t>(b.second.data()) == MARKER;
+        }));
+    }
+
+    MegaApp app;
+    std::shared_ptr<MegaClient> client = mt::makeClient(app);
+    NodeHandle parentHandle = NodeHandle().set6byte(1);
+    std::map<NodeHandle, string> records;
+}; // SqliteNodeCompressionTest
+
+TEST_F(SqliteNodeCompressionTest, RecordsAreCompressedIncrementally)
+{
+    populate(4096);
+
+    SqliteDbAccess dbAccess(rootPath);
+
+    auto table = open(dbAccess);
+    ASSERT_TRUE(table);
+
+    // Opening the database doesn't rewrite any records.
+    std::map<NodeHandle, string> blobs;
+
+    stored(dbAccess, blobs);
+
+    ASSERT_EQ(blobs.size(), records.size());
+    EXPECT_EQ(numCompressed(blobs), 0u);
+
+    // Each commit compresses another batch of records.
+    table->begin();
+    table->commit();
+
+    blobs.clear();
+    stored(dbAccess, blobs);
+
+#ifdef HAVE_ZSTD
+    auto compressed = numCompressed(blobs);
+
+    EXPECT_GT(compressed, 0u);
+    EXPECT_LT(compressed, records.size());
+
+    for (auto i = 0; i < 8; ++i)
+    {
+        table->begin();
+        table->commit();
+    }
+
+    blobs.clear();
+    stored(dbAccess, blobs);
+
+    EXPECT_EQ(numCompressed(blobs), records.size());
+
+    // Compressed records are smaller than the records they replace.
+    for (auto& b : blobs)
+    {
+        EXPECT_LT(b.second.size(), records[b.first].size());
+    }
+#else // HAVE_ZSTD
+    // Records are never compressed without zstd.
+    EXPECT_EQ(numCompressed(blobs), 0u);
+#endif // ! HAVE_ZSTD
+}
+
+TEST_F(SqliteNodeCompressionTest, RecordsAreReadTransparently)
+{
+    populate(4096);
+
+    SqliteDbAccess dbAccess(rootPath);
+
+    {
+        auto table = open(dbAccess);
+        ASSERT_TRUE(table);
+
+        auto nodes = dynamic_cast<DBTableNodes*>(table.get());
+        ASSERT_TRUE(nodes);
+
+        // Compress some, but not all, of the records.
+        table->begin();
+        table->commit();
+
+        for (auto& r : records)
+        {
+            NodeSerialized serialized;
+
+            ASSERT_TRUE(nodes->getNode(r.first, serialized));
+            EXPECT_EQ(serialized.mNode, r.second);
+        }
+    }
+
+    std::vector<std::pair<NodeHandle, NodeSerialized>> retrieved;
+
+    children(dbAccess, retrieved);
+
+    ASSERT_EQ(retrieved.size(), records.size());
+
+    for (auto& r : retrieved)
+    {
+        EXPECT_EQ(r.second.mNode, records[r.first]);
+    }
+}
+
+// Run once with and once without USE_ZSTD to compare cold listing times.
+TEST_F(SqliteNodeCompressionTest, DISABLED_Benchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numFiles = 250000u;
+
+    SqliteDbAccess dbAccess(rootPath);
+
+    auto path = dbAccess.databasePath(fsAccess, name, DbAccess::DB_VERSION).toPath(false);
+
+    populate(numFiles);
+
+    auto sizeBefore = std::filesystem::file_size(path);
+
+    // Compress every record, a batch per commit.
+    auto began = steady_clock::now();
+
+    {
+        auto table = open(dbAccess);
+        ASSERT_TRUE(table);
+
+        for (auto i = 0u; i <= numFiles / 1024; ++i)
+        {
+            table->begin();
+            table->commit();
+        }
+    }
+
+    auto migrated = steady_clock::now() - began;
+    auto sizeAfter = std::filesystem::file_size(path);
+
+    // List the folder using a fresh connection.
+    std::vector<std::pair<NodeHandle, NodeSerialized>> retrieved;
+
+    began = steady_clock::now();
+
+    children(dbAccess, retrieved);
+
+    auto listed = steady_clock::now() - began;
+
+    LOG_info << "Database size: "
+             << sizeBefore
+             << " -> "
+             << sizeAfter
+             << " byte(s), migrated in "
+             << duration_cast<milliseconds>(migrated).count()
+             << "ms, "
+             << retrieved.size()
+             << " children listed in "
+             << duration_cast<milliseconds>(listed).count()
+             << "ms";
+
+    EXPECT_EQ(retrieved.size(), numFiles);
+}
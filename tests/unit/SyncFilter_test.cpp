@@ -0,0 +1,217 @@
+/**
+ * @file SyncFilter_test.cpp
+ * @brief Unit tests for .megaignore filter chains.
+ *
+ * (c) 2013-2024 by Mega Limited, Auckland, New Zealand
+ *
+ * This file is part of the MEGA SDK - Client Access Engine.
+ *
+ * Applications using the MEGA API must present a valid application key
+ * and comply with the rules set forth in the Terms of Service.
+ *
+ * The MEGA SDK is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * @copyright Simplified (2-clause) BSD License.
+ *
+ * You should have received a copy of the license along with this
+ * program.
+ */
+
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mega/filesystem.h>
+#include <mega/logging.h>
+#include <mega/syncfilter.h>
+
+namespace SyncFilterTests
+{
+
+using namespace mega;
+
+class FilterChainTest
+  : public ::testing::Test
+{
+protected:
+    // Load the specified rules into mChain.
+    void load(const string_vector& rules)
+    {
+        ASSERT_EQ(mChain.load(rules), FLR_SUCCESS);
+
+        mChain.mLoadSucceeded = true;
+    }
+
+    // Match a name and a path against mChain.
+    ExclusionState match(const string& name,
+                         const string& path,
+                         nodetype_t type = FILENODE,
+                         bool onlyInheritable = false) const
+    {
+        RemotePathPair p(name, path);
+
+        return mChain.match(p, type, onlyInheritable);
+    }
+
+    // Match a name against mChain.
+    ExclusionState match(const string& name,
+                         nodetype_t type = FILENODE,
+                         bool onlyInheritable = false) const
+    {
+        return match(name, name, type, onlyInheritable);
+    }
+
+    FilterChain mChain;
+}; // FilterChainTest
+
+TEST_F(FilterChainTest, LastMatchingRuleWins)
+{
+    load({"-:*.tmp",
+          "+:keep.tmp",
+          "-G:keep.TMP",
+          "-:k*p.tmp"});
+
+    // Only the suffix rule matches.
+    EXPECT_EQ(match("a.tmp"), ES_EXCLUDED);
+
+    // Generic glob is the last matching rule.
+    EXPECT_EQ(match("keep.tmp"), ES_EXCLUDED);
+
+    // Case-sensitive literal doesn't match but the generic glob does.
+    EXPECT_EQ(match("KEEP.tmp"), ES_EXCLUDED);
+
+    // Nothing matches.
+    EXPECT_EQ(match("a.txt"), ES_UNMATCHED);
+}
+
+TEST_F(FilterChainTest, LiteralTakesPrecedenceWhenDefinedLater)
+{
+    load({"-:*.tmp",
+          "-:k*p.tmp",
+          "+:keep.tmp"});
+
+    EXPECT_EQ(match("keep.tmp"), ES_INCLUDED);
+    EXPECT_EQ(match("KEEP.TMP"), ES_INCLUDED);
+    EXPECT_EQ(match("kelp.tmp"), ES_EXCLUDED);
+}
+
+TEST_F(FilterChainTest, CaseSensitivity)
+{
+    load({"-G:*.LOG",
+          "-g:Thumbs.db"});
+
+    EXPECT_EQ(match("a.LOG"), ES_EXCLUDED);
+    EXPECT_EQ(match("a.log"), ES_UNMATCHED);
+    EXPECT_EQ(match("THUMBS.DB"), ES_EXCLUDED);
+    EXPECT_EQ(match("thumbs.db"), ES_EXCLUDED);
+}
+
+TEST_F(FilterChainTest, NodeTypes)
+{
+    load({"-d:build",
+          "-f:*.o",
+          "+f:build"});
+
+    EXPECT_EQ(match("build", FOLDERNODE), ES_EXCLUDED);
+    EXPECT_EQ(match("build", FILENODE), ES_INCLUDED);
+    EXPECT_EQ(match("a.o", FILENODE), ES_EXCLUDED);
+    EXPECT_EQ(match("a.o", FOLDERNODE), ES_UNMATCHED);
+}
+
+TEST_F(FilterChainTest, InheritableRules)
+{
+    load({"-:*.bak",
+          "+N:*.bak",
+          "-N:local"});
+
+    EXPECT_EQ(match("a.bak"), ES_INCLUDED);
+    EXPECT_EQ(match("a.bak", FILENODE, true), ES_EXCLUDED);
+    EXPECT_EQ(match("local"), ES_EXCLUDED);
+    EXPECT_EQ(match("local", FILENODE, true), ES_UNMATCHED);
+}
+
+TEST_F(FilterChainTest, NamesAndPaths)
+{
+    load({"-p:a/b/c",
+          "-:x/*.dat",
+          "-:c"});
+
+    EXPECT_EQ(match("c", "a/b/c"), ES_EXCLUDED);
+    EXPECT_EQ(match("d", "a/b/c"), ES_EXCLUDED);
+    EXPECT_EQ(match("y.dat", "x/y.dat"), ES_EXCLUDED);
+    EXPECT_EQ(match("y.dat", "z/y.dat"), ES_UNMATCHED);
+}
+
+TEST_F(FilterChainTest, Regexes)
+{
+    load({"-r:.*\\.tmp",
+          "+:a.tmp"});
+
+    EXPECT_EQ(match("a.tmp"), ES_INCLUDED);
+    EXPECT_EQ(match("b.TMP"), ES_EXCLUDED);
+}
+
+TEST_F(FilterChainTest, DISABLED_Benchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numRules = 1000u;
+    constexpr auto numPaths = 1000000u;
+
+    string_vector rules;
+
+    // A mix of literal, extension and general rules.
+    for (auto i = 0u; i < numRules; ++i)
+    {
+        auto n = std::to_string(i);
+
+        switch (i % 4)
+        {
+        case 0:
+            rules.emplace_back("-:name" + n);
+            break;
+        case 1:
+            rules.emplace_back("-:*.ext" + n);
+            break;
+        case 2:
+            rules.emplace_back("+f:keep" + n + ".txt");
+            break;
+        case 3:
+            rules.emplace_back("-:pre" + n + "*");
+            break;
+        }
+    }
+
+    load(rules);
+
+    auto matched = 0u;
+    auto began = steady_clock::now();
+
+    for (auto i = 0u; i < numPaths; ++i)
+    {
+        auto name = "file" + std::to_string(i) + ".ext" + std::to_string(i % 2000);
+        auto path = "dir" + std::to_string(i % 100) + "/" + name;
+
+        matched += match(name, path) != ES_UNMATCHED;
+    }
+
+    auto elapsed = steady_clock::now() - began;
+
+    LOG_info << numPaths
+             << " path(s) matched against "
+             << numRules
+             << " rule(s) in "
+             << duration_cast<milliseconds>(elapsed).count()
+             << "ms ("
+             << matched
+             << " matched)";
+
+    EXPECT_GT(matched, 0u);
+}
+
+} // SyncFilterTests
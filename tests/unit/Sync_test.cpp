@@ -16,8 +16,11 @@
  * program.
  */
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <numeric>
+#include <thread>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -1139,5 +1142,150 @@ TEST_F(SyncConfigStoreTest, Write)
 
 } // SyncConfigTests
 
+namespace SyncTreestateTests
+{
+
+using namespace mega;
+
+// Overlay icon queries must be answered while the sync thread is in the middle
+// of a long recursiveSync pass (which holds mLocalNodeChangeMutex throughout).
+TEST(SyncTreestate, QueriesDontWaitForSyncPass)
+{
+    constexpr auto numPaths = 20000u;
+    constexpr auto numQueriesDuringPass = 100000u;
+
+    SyncThreadsafeState state(1, nullptr, false);
+    std::timed_mutex localNodeChangeMutex;
+
+    std::vector<LocalPath> paths;
+    std::vector<uint64_t> ids;
+
+    // Link the sync root and a hundred folders below it.
+    auto rootId = state.nextTreestateId();
+    state.linkTreestate(0, LocalPath(), nullptr, rootId);
+
+    std::vector<uint64_t> folderIds;
+
+    for (auto i = 0u; i < 100; ++i)
+    {
+        folderIds.emplace_back(state.nextTreestateId());
+        state.linkTreestate(rootId, LocalPath::fromRelativePath("d" + std::to_string(i)), nullptr, folderIds.back());
+    }
+
+    for (auto i = 0u; i < numPaths; ++i)
+    {
+        auto name = LocalPath::fromRelativePath("f" + std::to_string(i));
+        auto path = LocalPath::fromRelativePath("d" + std::to_string(i % 100));
+        path.appendWithSeparator(name, true);
+        paths.emplace_back(std::move(path));
+
+        ids.emplace_back(state.nextTreestateId());
+        state.linkTreestate(folderIds[i % 100], name, nullptr, ids.back());
+    }
+
+    std::atomic<unsigned> numQueries{0};
+    std::atomic<bool> passRunning{true};
+    std::atomic<bool> badState{false};
+
+    // The sync thread's pass: keep publishing until enough queries were served.
+    std::thread syncThread([&]() {
+        std::lock_guard<std::timed_mutex> g(localNodeChangeMutex);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+
+        for (auto i = 0u; numQueries < numQueriesDuringPass && std::chrono::steady_clock::now() < deadline; ++i)
+        {
+            auto ts = i / numPaths % 2 ? TREESTATE_SYNCING : TREESTATE_SYNCED;
+            state.publishTreestate(ids[i % numPaths], ts);
+        }
+
+        passRunning = false;
+    });
+
+    // The file manager's overlay queries.
+    std::vector<std::thread> queryThreads;
+
+    for (auto t = 0u; t < 4; ++t)
+    {
+        queryThreads.emplace_back([&, t]() {
+            for (auto i = t; passRunning; i += 7)
+            {
+                auto ts = state.publishedTreestate(paths[i % numPaths]);
+
+                if (ts != TREESTATE_NONE && ts != TREESTATE_SYNCED && ts != TREESTATE_SYNCING)
+                {
+                    badState = true;
+                }
+
+                ++numQueries;
+            }
+        });
+    }
+
+    syncThread.join();
+
+    for (auto& t : queryThreads)
+    {
+        t.join();
+    }
+
+    EXPECT_GE(numQueries.load(), numQueriesDuringPass);
+    EXPECT_FALSE(badState);
+
+    // Forgotten states are reported as none.
+    state.publishTreestate(ids[0], TREESTATE_NONE);
+    EXPECT_EQ(state.publishedTreestate(paths[0]), TREESTATE_NONE);
+    EXPECT_NE(state.publishedTreestate(paths[1]), TREESTATE_NONE);
+}
+
+TEST(SyncTreestate, LinksFollowRenamesAndShortnames)
+{
+    SyncThreadsafeState state(1, nullptr, false);
+
+    auto path = [](const std::string& folder, const std::string& file) {
+        auto result = LocalPath::fromRelativePath(folder);
+        result.appendWithSeparator(LocalPath::fromRelativePath(file), true);
+        return result;
+    };
+
+    auto rootId = state.nextTreestateId();
+    auto folderId = state.nextTreestateId();
+    auto fileId = state.nextTreestateId();
+
+    auto folder = LocalPath::fromRelativePath("Long Folder Name");
+    auto shortname = LocalPath::fromRelativePath("LONGFO~1");
+
+    state.linkTreestate(0, LocalPath(), nullptr, rootId);
+    state.linkTreestate(rootId, folder, &shortname, folderId);
+    state.linkTreestate(folderId, LocalPath::fromRelativePath("file"), nullptr, fileId);
+
+    state.publishTreestate(rootId, TREESTATE_SYNCING);
+    state.publishTreestate(folderId, TREESTATE_SYNCING);
+    state.publishTreestate(fileId, TREESTATE_PENDING);
+
+    EXPECT_EQ(state.publishedTreestate(LocalPath()), TREESTATE_SYNCING);
+    EXPECT_EQ(state.publishedTreestate(path("Long Folder Name", "file")), TREESTATE_PENDING);
+
+    // Paths may be given by shortname, as localnodebypath() allows.
+    EXPECT_EQ(state.publishedTreestate(path("LONGFO~1", "file")), TREESTATE_PENDING);
+
+    // Renaming the folder only relinks the folder, its children follow.
+    auto renamed = LocalPath::fromRelativePath("renamed");
+
+    state.unlinkTreestate(rootId, folder, &shortname, folderId);
+    state.linkTreestate(rootId, renamed, nullptr, folderId);
+
+    EXPECT_EQ(state.publishedTreestate(path("renamed", "file")), TREESTATE_PENDING);
+    EXPECT_EQ(state.publishedTreestate(path("Long Folder Name", "file")), TREESTATE_NONE);
+    EXPECT_EQ(state.publishedTreestate(path("LONGFO~1", "file")), TREESTATE_NONE);
+
+    // Unlinking a stale id leaves the current link alone.
+    state.unlinkTreestate(rootId, renamed, nullptr, fileId);
+
+    EXPECT_EQ(state.publishedTreestate(path("renamed", "file")), TREESTATE_PENDING);
+}
+
+} // SyncTreestateTests
+
 #endif
 
@@ -16,12 +16,18 @@
  * program.
  */
 
+#include <chrono>
+
 #include <gtest/gtest.h>
 
 #include <mega/megaclient.h>
+#include <mega/file.h>
+#include <mega/logging.h>
 #include <mega/megaapp.h>
 #include <mega/transfer.h>
+#include <mega/transferslot.h>
 
+#include "DefaultedDbTable.h"
 #include "DefaultedFileSystemAccess.h"
 #include "utils.h"
 #include "mega.h"
@@ -86,4 +92,769 @@ TEST(Transfer, serialize_unserialize)
     checkTransfers(tf, *newTf);
 }
 
+TEST(DirectReadUrlCache, ReusesFreshUrlsUntilInvalidated)
+{
+    auto now = mega::Waiter::ds.load();
+    mega::DirectReadUrlCache cache;
+    std::vector<std::string> urls;
+    mega::m_off_t size = 0;
+
+    cache.put(1, {"https://a/", "https://b/"}, 100);
+
+    ASSERT_TRUE(cache.get(1, urls, size));
+    EXPECT_EQ(urls.size(), 2u);
+    EXPECT_EQ(size, 100);
+    EXPECT_FALSE(cache.get(2, urls, size));
+
+    // URLs rejected by the storage server are never reused.
+    cache.invalidate(1);
+    EXPECT_FALSE(cache.get(1, urls, size));
+
+    // Neither are old ones.
+    cache.put(1, {"https://a/"}, 100);
+    mega::Waiter::ds = now + mega::DirectReadUrlCache::MAX_AGE_DS;
+    EXPECT_FALSE(cache.get(1, urls, size));
+    EXPECT_EQ(cache.size(), 0u);
+
+    // The least recently used node is evicted first.
+    for (mega::handle h = 0; h <= mega::DirectReadUrlCache::MAX_ENTRIES; ++h)
+    {
+        cache.put(h, {"https://a/"}, 100);
+
+        if (h > 1)
+        {
+            ASSERT_TRUE(cache.get(0, urls, size));
+        }
+    }
+
+    EXPECT_EQ(cache.size(), mega::DirectReadUrlCache::MAX_ENTRIES);
+    EXPECT_TRUE(cache.get(0, urls, size));
+    EXPECT_FALSE(cache.get(1, urls, size));
+
+    mega::Waiter::ds = now;
+}
+
+
+
+namespace
+{
+
+// Counts how often the app is told that a transfer changed.
+class UpdateCountingApp
+  : public mega::MegaApp
+{
+public:
+    void transfer_update(mega::Transfer*) override
+    {
+        ++updates;
+    }
+
+    size_t updates = 0;
+}; // UpdateCountingApp
+
+class TransferListTest
+  : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        client = mt::makeClient(app);
+    }
+
+    void TearDown() override
+    {
+        // Transfers remove themselves from the list.
+        for (auto* transfer : mTransfers)
+        {
+            delete transfer;
+        }
+    }
+
+    // Queue a transfer with a single file.
+    mega::Transfer* add(mega::direction_t direction, m_off_t size)
+    {
+        auto* transfer = new mega::Transfer(client.get(), direction);
+        transfer->size = size;
+
+        mFiles.emplace_back(new mega::File());
+
+        auto* file = mFiles.back().get();
+        file->transfer = transfer;
+        file->file_it = transfer->files.insert(transfer->files.end(), file);
+
+        mega::TransferDbCommitter committer(client->tctable);
+        client->transferlist.addtransfer(transfer, committer);
+
+        mTransfers.emplace(transfer);
+
+        return transfer;
+    }
+
+    // Delete a transfer, as if it had completed.
+    void remove(mega::Transfer* transfer)
+    {
+        mTransfers.erase(transfer);
+        delete transfer;
+    }
+
+    // Pick at most limit transfers per category.
+    std::array<std::vector<mega::Transfer*>, 6> next(size_t limit)
+    {
+        std::array<size_t, 6> counts{};
+
+        std::function<bool(mega::Transfer*)> continueCategory = [&](mega::Transfer* transfer) {
+            auto& count = counts[mega::TransferCategory(transfer).index()];
+            return count < limit && ++count;
+        };
+
+        std::function<bool(mega::direction_t)> continueDirection = [](mega::direction_t) {
+            return true;
+        };
+
+        mega::TransferDbCommitter committer(client->tctable);
+
+        return client->transferlist.nexttransfers(continueCategory, continueDirection, committer);
+    }
+
+    static unsigned smallPuts()
+    {
+        return mega::TransferCategory(mega::PUT, mega::SMALLFILE).index();
+    }
+
+    // The list's transfers in order.
+    std::vector<mega::Transfer*> listed(mega::direction_t direction)
+    {
+        std::vector<mega::Transfer*> result;
+
+        auto& list = client->transferlist;
+
+        for (auto i = list.begin(direction); i != list.end(direction); ++i)
+        {
+            result.emplace_back(*i);
+        }
+
+        return result;
+    }
+
+    UpdateCountingApp app;
+    std::shared_ptr<mega::MegaClient> client;
+
+private:
+    std::set<mega::Transfer*> mTransfers;
+    std::vector<std::unique_ptr<mega::File>> mFiles;
+}; // TransferListTest
+
+} // anonymous
+
+TEST_F(TransferListTest, NextTransfersSkipsPausedAndBackedOff)
+{
+    std::vector<mega::Transfer*> transfers;
+
+    for (auto i = 0; i < 4; ++i)
+    {
+        transfers.emplace_back(add(mega::PUT, 1024));
+    }
+
+    mega::TransferDbCommitter committer(client->tctable);
+
+    client->transferlist.pause(transfers[0], true, committer);
+    transfers[1]->bt.backoff(100);
+
+    auto chosen = next(10);
+
+    EXPECT_EQ(chosen[smallPuts()], std::vector<mega::Transfer*>({transfers[2], transfers[3]}));
+
+    // Resumed transfers and expired backoffs are picked up again, in priority order.
+    client->transferlist.pause(transfers[0], false, committer);
+    transfers[1]->bt.arm();
+    client->transferlist.backoffsAborted(mega::PUT);
+
+    chosen = next(10);
+
+    EXPECT_EQ(chosen[smallPuts()], transfers);
+}
+
+TEST_F(TransferListTest, NextTransfersFollowsPriority)
+{
+    auto* large = add(mega::PUT, 1 << 20);
+    auto* first = add(mega::PUT, 1024);
+    auto* second = add(mega::PUT, 1024);
+
+    mega::TransferDbCommitter committer(client->tctable);
+    client->transferlist.movetofirst(second, committer);
+
+    auto chosen = next(1);
+
+    EXPECT_EQ(chosen[smallPuts()], std::vector<mega::Transfer*>({second}));
+    EXPECT_EQ(chosen[mega::TransferCategory(large).index()], std::vector<mega::Transfer*>({large}));
+
+    client->transferlist.movetolast(second, committer);
+
+    chosen = next(1);
+
+    EXPECT_EQ(chosen[smallPuts()], std::vector<mega::Transfer*>({first}));
+}
+
+TEST_F(TransferListTest, RepeatedMovesRenumberFewTransfers)
+{
+    constexpr auto numTransfers = 1000u;
+    constexpr auto numMoves = 200u;
+    constexpr auto destination = 900u;
+
+    std::vector<mega::Transfer*> expected;
+
+    for (auto i = 0u; i < numTransfers; ++i)
+    {
+        expected.emplace_back(add(mega::PUT, 1024));
+    }
+
+    mega::TransferDbCommitter committer(client->tctable);
+
+    app.updates = 0;
+
+    // Keep moving the first transfer into the same gap, so that gap runs out.
+    for (auto i = 0u; i < numMoves; ++i)
+    {
+        auto* transfer = expected.front();
+
+        client->transferlist.movetransfer(transfer, destination, committer);
+
+        expected.erase(expected.begin());
+        expected.insert(expected.begin() + destination - 1, transfer);
+    }
+
+    auto actual = listed(mega::PUT);
+
+    ASSERT_EQ(actual, expected);
+
+    for (auto i = 1u; i < actual.size(); ++i)
+    {
+        EXPECT_LT(actual[i - 1]->priority, actual[i]->priority);
+    }
+
+    // Renumbering everything before the destination would tell the app
+    // about hundreds of transfers each time the gap ran out.
+    EXPECT_LT(app.updates, numMoves * 10);
+}
+
+TEST_F(TransferListTest, DISABLED_DispatchBenchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numTransfers = 200000u;
+    constexpr auto numDispatches = 1000u;
+    constexpr auto numPerDispatch = 16u;
+
+    mega::TransferDbCommitter committer(client->tctable);
+
+    // Half of the queue is paused, so a dispatch has to get past them.
+    for (auto i = 0u; i < numTransfers; ++i)
+    {
+        auto* transfer = add(mega::PUT, 1024);
+
+        if (i < numTransfers / 2)
+        {
+            client->transferlist.pause(transfer, true, committer);
+        }
+    }
+
+    auto elapsed = steady_clock::duration::zero();
+    auto dispatched = 0u;
+
+    for (auto i = 0u; i < numDispatches; ++i)
+    {
+        auto began = steady_clock::now();
+        auto chosen = next(numPerDispatch);
+        elapsed += steady_clock::now() - began;
+
+        // Pretend the transfers completed, freeing their slots.
+        for (auto* transfer : chosen[smallPuts()])
+        {
+            remove(transfer);
+            ++dispatched;
+        }
+    }
+
+    LOG_info << numDispatches
+             << " dispatch(es) against "
+             << numTransfers
+             << " queued upload(s) took "
+             << duration_cast<microseconds>(elapsed).count() / numDispatches
+             << "us on average";
+
+    EXPECT_EQ(dispatched, numDispatches * numPerDispatch);
+}
+
+namespace mega
+{
+
+// Gives tests access to the slot's download pipeline and writeback.
+class TransferSlotTestPeer
+{
+public:
+    static bool pipelineAccepts(const TransferSlot& slot, const TransferBufferManager::FilePiece& piece)
+    {
+        return slot.pipelineAccepts(piece);
+    }
+
+    static void pipelinePiece(TransferSlot& slot, MegaClient* client, std::shared_ptr<TransferBufferManager::FilePiece> piece)
+    {
+        slot.pipelinePiece(client, std::move(piece));
+    }
+
+    static bool processPipeline(TransferSlot& slot, MegaClient* client, TransferDbCommitter& committer, dstime& backoff)
+    {
+        return slot.processPipeline(client, committer, backoff);
+    }
+
+    static void writeback(TransferSlot& slot, m_off_t contiguous)
+    {
+        slot.writeback(contiguous);
+    }
+}; // TransferSlotTestPeer
+
+} // mega
+
+namespace
+{
+
+using mega::TransferSlotTestPeer;
+
+// Records what a transfer slot writes, without touching the disk.
+class RecordingFileAccess
+  : public mega::FileAccess
+{
+public:
+    explicit RecordingFileAccess(mega::Waiter* waiter)
+      : mega::FileAccess(waiter)
+    {
+    }
+
+    bool fopen(const mega::LocalPath&, bool, bool, mega::FSLogging, mega::DirAccess*, bool, bool, mega::LocalPath*) override
+    {
+        return true;
+    }
+
+    void updatelocalname(const mega::LocalPath&, bool) override
+    {
+    }
+
+    void fclose() override
+    {
+    }
+
+    bool fwrite(const mega::byte*, unsigned length, m_off_t position) override
+    {
+        writes.emplace_back(position, length);
+        return true;
+    }
+
+    bool fstat(mega::m_time_t&, m_off_t&) override
+    {
+        return false;
+    }
+
+    bool ftruncate(m_off_t) override
+    {
+        return true;
+    }
+
+    void fwriteback(m_off_t position, m_off_t length) override
+    {
+        writebacks.emplace_back(position, length);
+        calls.push_back('w');
+    }
+
+    void fdropcache(m_off_t position, m_off_t length) override
+    {
+        drops.emplace_back(position, length);
+        calls.push_back('d');
+    }
+
+    // Position and length of each call.
+    using Ranges = std::vector<std::pair<m_off_t, m_off_t>>;
+
+    Ranges writes;
+    Ranges writebacks;
+    Ranges drops;
 
+    // Order of writeback ('w') and drop ('d') calls.
+    std::string calls;
+
+protected:
+    bool sysread(mega::byte*, unsigned, m_off_t) override
+    {
+        return false;
+    }
+
+    bool sysstat(mega::m_time_t*, m_off_t*, mega::FSLogging) override
+    {
+        return false;
+    }
+
+    bool sysopen(bool, mega::FSLogging) override
+    {
+        return true;
+    }
+
+    void sysclose() override
+    {
+    }
+}; // RecordingFileAccess
+
+class TransferSlotPipelineTest
+  : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // The client has no worker threads, so pieces are decrypted as they're handed over.
+        client = mt::makeClient(app);
+
+        transfer.reset(new mega::Transfer(client.get(), mega::GET));
+        std::fill(transfer->transferkey.data(),
+                  transfer->transferkey.data() + mega::SymmCipher::KEYLENGTH,
+                  'K');
+
+        // Large enough that the download never completes.
+        transfer->size = 1ll << 40;
+
+        slot.reset(new mega::TransferSlot(transfer.get()));
+        slot->transferbuf.setIsRaid(transfer.get(), {"http://a/"}, 0, slot->maxRequestSize, false);
+
+        auto fa = std::make_unique<RecordingFileAccess>(client->waiter.get());
+        file = fa.get();
+        slot->fa.reset(std::move(fa));
+    }
+
+    void TearDown() override
+    {
+        slot.reset();
+        transfer.reset();
+    }
+
+    // The piece covering the chunk that starts at position.
+    std::shared_ptr<mega::TransferBufferManager::FilePiece> piece(m_off_t position)
+    {
+        auto length = mega::ChunkedHash::chunkceil(position) - position;
+
+        return std::make_shared<mega::TransferBufferManager::FilePiece>(position, static_cast<size_t>(length));
+    }
+
+    // Write what the pipeline can, and return whether the transfer completed or failed.
+    bool process()
+    {
+        mega::dstime backoff = 0;
+        mega::TransferDbCommitter committer(client->tctable);
+
+        return TransferSlotTestPeer::processPipeline(*slot, client.get(), committer, backoff);
+    }
+
+    // Downloaded data the slot reports as progress: written, or waiting in the pipeline.
+    m_off_t progress()
+    {
+        return transfer->progresscompleted + slot->pipelineStats().bytes;
+    }
+
+    mega::MegaApp app;
+    std::shared_ptr<mega::MegaClient> client;
+    std::unique_ptr<mega::Transfer> transfer;
+    std::unique_ptr<mega::TransferSlot> slot;
+    RecordingFileAccess* file = nullptr;
+}; // TransferSlotPipelineTest
+
+} // anonymous
+
+TEST_F(TransferSlotPipelineTest, WritesPiecesInFileOrder)
+{
+    std::vector<m_off_t> positions;
+
+    for (m_off_t position = 0; positions.size() < 8; position = mega::ChunkedHash::chunkceil(position))
+    {
+        positions.emplace_back(position);
+    }
+
+    // Pieces arrive in reverse order.
+    for (auto i = positions.rbegin(); i != positions.rend(); ++i)
+    {
+        auto p = piece(*i);
+
+        ASSERT_TRUE(TransferSlotTestPeer::pipelineAccepts(*slot, *p));
+        TransferSlotTestPeer::pipelinePiece(*slot, client.get(), p);
+    }
+
+    EXPECT_EQ(slot->pipelineStats().decrypted, positions.size());
+    EXPECT_TRUE(file->writes.empty());
+
+    ASSERT_FALSE(process());
+
+    // They're written in file order, with nothing left out.
+    ASSERT_FALSE(file->writes.empty());
+
+    m_off_t end = 0;
+
+    for (auto& write : file->writes)
+    {
+        EXPECT_EQ(write.first, end);
+        end = write.first + write.second;
+    }
+
+    EXPECT_EQ(end, mega::ChunkedHash::chunkceil(positions.back()));
+    EXPECT_EQ(transfer->progresscompleted, end);
+    EXPECT_EQ(slot->pipelineStats().bytes, 0);
+}
+
+TEST_F(TransferSlotPipelineTest, HoldsBackPiecesWhenFull)
+{
+    m_off_t position = 0;
+
+    while (TransferSlotTestPeer::pipelineAccepts(*slot, *piece(position)))
+    {
+        TransferSlotTestPeer::pipelinePiece(*slot, client.get(), piece(position));
+        position = mega::ChunkedHash::chunkceil(position);
+    }
+
+    // The pipeline fills up to its limit and no further.
+    auto held = slot->pipelineStats().bytes;
+    auto next = piece(position);
+
+    EXPECT_LE(held, mega::TransferSlot::MAX_PIPELINE_SIZE);
+    EXPECT_GT(held + static_cast<m_off_t>(next->buf.datalen()), mega::TransferSlot::MAX_PIPELINE_SIZE);
+
+    // A piece starting part way through a chunk waits for the pipeline to empty.
+    auto partial = std::make_shared<mega::TransferBufferManager::FilePiece>(position + 16, 16);
+
+    EXPECT_FALSE(TransferSlotTestPeer::pipelineAccepts(*slot, *partial));
+
+    // Writing drains it, so the next piece can come in.
+    ASSERT_FALSE(process());
+
+    EXPECT_EQ(slot->pipelineStats().bytes, 0);
+    EXPECT_TRUE(TransferSlotTestPeer::pipelineAccepts(*slot, *next));
+    EXPECT_TRUE(TransferSlotTestPeer::pipelineAccepts(*slot, *partial));
+}
+
+TEST_F(TransferSlotPipelineTest, ProgressNeverGoesBackwards)
+{
+    m_off_t position = 0;
+    m_off_t reported = 0;
+
+    for (auto i = 0; i < 32; ++i)
+    {
+        auto p = piece(position);
+        auto length = static_cast<m_off_t>(p->buf.datalen());
+
+        // A piece counts as soon as it's handed over...
+        TransferSlotTestPeer::pipelinePiece(*slot, client.get(), p);
+        EXPECT_EQ(progress(), reported + length);
+        reported = progress();
+
+        // ...and writing it doesn't count it again, or take it away.
+        if (i % 3 == 2)
+        {
+            ASSERT_FALSE(process());
+            EXPECT_EQ(progress(), reported);
+            EXPECT_EQ(slot->pipelineStats().bytes, 0);
+        }
+
+        position = mega::ChunkedHash::chunkceil(position);
+    }
+
+    ASSERT_FALSE(process());
+    EXPECT_EQ(progress(), reported);
+    EXPECT_EQ(transfer->progresscompleted, position);
+}
+
+TEST_F(TransferSlotPipelineTest, WritesBackWholeWindowsBeforeDroppingThePrevious)
+{
+    using Ranges = RecordingFileAccess::Ranges;
+
+    const auto window = mega::TransferSlot::WRITEBACK_WINDOW;
+
+    // Nothing happens until a window's worth of data has been written.
+    TransferSlotTestPeer::writeback(*slot, window - 1);
+
+    EXPECT_TRUE(file->calls.empty());
+
+    // The first window is written back but there's nothing to drop yet.
+    TransferSlotTestPeer::writeback(*slot, window + 10);
+
+    EXPECT_EQ(file->calls, "w");
+    EXPECT_EQ(file->writebacks, Ranges({{0, window + 10}}));
+    EXPECT_TRUE(file->drops.empty());
+
+    // Windows are measured from where the last one ended.
+    TransferSlotTestPeer::writeback(*slot, 2 * window);
+
+    EXPECT_EQ(file->calls, "w");
+
+    // Each window is started before the previous one is waited for and dropped.
+    TransferSlotTestPeer::writeback(*slot, 2 * window + 20);
+
+    EXPECT_EQ(file->calls, "wwd");
+    EXPECT_EQ(file->writebacks, Ranges({{0, window + 10}, {window + 10, window + 10}}));
+    EXPECT_EQ(file->drops, Ranges({{0, window + 10}}));
+
+    TransferSlotTestPeer::writeback(*slot, 4 * window);
+
+    EXPECT_EQ(file->calls, "wwdwd");
+    EXPECT_EQ(file->writebacks.back(), std::make_pair(2 * window + 20, 2 * window - 20));
+    EXPECT_EQ(file->drops.back(), std::make_pair(window + 10, window + 10));
+}
+
+namespace
+{
+
+class TransferCacheTest
+  : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        client = mt::makeClient(app);
+        client->tctable.reset(new mt::DefaultedDbTable(client->rng));
+
+        // Make sure nothing is flushed just because time has passed.
+        mega::TransferDbCommitter committer(client->tctable);
+        client->transfercacheflush(&committer, true);
+    }
+
+    void TearDown() override
+    {
+        // Destroying a dirty transfer writes it out.
+        mega::TransferDbCommitter committer(client->tctable);
+        mTransfers.clear();
+    }
+
+    // Add a transfer that has already been written to the cache once.
+    mega::Transfer* add()
+    {
+        mTransfers.emplace_back(new mega::Transfer(client.get(), mega::GET));
+
+        auto* transfer = mTransfers.back().get();
+
+        mega::TransferDbCommitter committer(client->tctable);
+        client->transfercacheadd(transfer, &committer);
+
+        // Records that can't be serialized aren't given an identity.
+        if (!transfer->dbid)
+        {
+            transfer->dbid = static_cast<uint32_t>(mTransfers.size());
+        }
+
+        return transfer;
+    }
+
+    // Destroy a transfer, as if it had been freed.
+    void remove(mega::Transfer* transfer)
+    {
+        mega::TransferDbCommitter committer(client->tctable);
+
+        for (auto i = mTransfers.begin(); i != mTransfers.end(); ++i)
+        {
+            if (i->get() == transfer)
+            {
+                mTransfers.erase(i);
+                break;
+            }
+        }
+    }
+
+    // How many times has a transfer been written to the cache?
+    uint64_t writes() const
+    {
+        return client->performanceStats.transferCacheWrites;
+    }
+
+    mega::MegaApp app;
+    std::shared_ptr<mega::MegaClient> client;
+
+private:
+    std::vector<std::unique_ptr<mega::Transfer>> mTransfers;
+}; // TransferCacheTest
+
+} // anonymous
+
+TEST_F(TransferCacheTest, CoalescesProgressUpdates)
+{
+    auto* transfer = add();
+
+    auto written = writes();
+    auto coalesced = client->performanceStats.transferCacheCoalesced;
+
+    // Progress updates are only noted.
+    for (auto i = 0; i < 8; ++i)
+    {
+        client->transfercachedirty(transfer);
+    }
+
+    EXPECT_EQ(writes(), written);
+    EXPECT_EQ(client->performanceStats.transferCacheCoalesced, coalesced + 7);
+
+    // And written out once when flushed.
+    {
+        mega::TransferDbCommitter committer(client->tctable);
+        client->transfercacheflush(&committer, true);
+    }
+
+    EXPECT_EQ(writes(), written + 1);
+    EXPECT_TRUE(client->dirtytransfers.empty());
+}
+
+TEST_F(TransferCacheTest, FlushesWhenDestroyed)
+{
+    auto* transfer = add();
+    auto* finished = add();
+
+    auto written = writes();
+
+    client->transfercachedirty(transfer);
+    client->transfercachedirty(finished);
+
+    EXPECT_EQ(writes(), written);
+
+    // Progress isn't lost when a transfer goes away.
+    remove(transfer);
+
+    EXPECT_EQ(writes(), written + 1);
+
+    // Unless its record is about to be removed.
+    finished->finished = true;
+    remove(finished);
+
+    EXPECT_EQ(writes(), written + 1);
+    EXPECT_TRUE(client->dirtytransfers.empty());
+}
+
+TEST_F(TransferCacheTest, FlushesAtDirtyLimit)
+{
+    std::vector<mega::Transfer*> transfers;
+
+    for (size_t i = 0; i < mega::MegaClient::TRANSFERCACHE_MAX_DIRTY; ++i)
+    {
+        transfers.emplace_back(add());
+    }
+
+    auto written = writes();
+
+    mega::TransferDbCommitter committer(client->tctable);
+
+    // Just below the limit, transfers are held back.
+    for (size_t i = 0; i + 1 < transfers.size(); ++i)
+    {
+        client->transfercachedirty(transfers[i]);
+    }
+
+    client->transfercacheflush(&committer, false);
+
+    EXPECT_EQ(writes(), written);
+
+    // Reaching it writes them all out.
+    client->transfercachedirty(transfers.back());
+    client->transfercacheflush(&committer, false);
+
+    EXPECT_EQ(writes(), written + transfers.size());
+    EXPECT_TRUE(client->dirtytransfers.empty());
+}
@@ -16,18 +16,21 @@
  * program.
  */
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <fstream>
+#include <map>
 #include <tuple>
 
 #include <gtest/gtest.h>
 
 #include <mega/base64.h>
 #include <mega/filesystem.h>
+#include <mega/node.h>
 #include <mega/utils.h>
 #include "megafs.h"
 
-#include <mega/db.h>
-#include <mega/db/sqlite.h>
 #include <mega/json.h>
 #include <mega/process.h>
 
@@ -594,144 +597,6 @@ TEST(Filesystem, isContainingPathOf)
 #undef SEP
 }
 
-class SqliteDBTest
-  : public ::testing::Test
-{
-public:
-        SqliteDBTest()
-          : Test()
-          , fsAccess()
-          , name("test")
-          , rng()
-          , rootPath(LocalPath::fromAbsolutePath("."))
-        {
-            // Get the current path.
-            bool result = fsAccess.cwd(rootPath);
-            if (!result)
-                assert(result);
-
-            // Create temporary DB root path.
-            rootPath.appendWithSeparator(
-                LocalPath::fromRelativePath("db"), false);
-
-            // Make sure our root path is clear.
-            fsAccess.emptydirlocal(rootPath);
-            fsAccess.rmdirlocal(rootPath);
-
-            // Create root path.
-            result = fsAccess.mkdirlocal(rootPath, false, true);
-            if (!result)
-                assert(result);
-        }
-
-        ~SqliteDBTest()
-        {
-            // Remove temporary root path.
-            fsAccess.emptydirlocal(rootPath);
-
-            bool result = fsAccess.rmdirlocal(rootPath);
-            if (!result)
-                assert(result);
-        }
-
-        FSACCESS_CLASS fsAccess;
-        string name;
-        PrnGen rng;
-        LocalPath rootPath;
-}; // SqliteDBTest
-
-TEST_F(SqliteDBTest, CreateCurrent)
-{
-    SqliteDbAccess dbAccess(rootPath);
-
-    // Assume databases are in legacy format until proven otherwise.
-    EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::LEGACY_DB_VERSION);
-
-    // Create a new database.
-    DbTablePtr dbTable(dbAccess.openTableWithNodes(rng, fsAccess, name, 0, nullptr));
-
-    // Was the database created successfully?
-    ASSERT_TRUE(!!dbTable);
-
-    // New databases should not be in the legacy format.
-    EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::DB_VERSION);
-
-}
-
-TEST_F(SqliteDBTest, OpenCurrent)
-{
-    // Create a dummy database.
-    {
-        SqliteDbAccess dbAccess(rootPath);
-
-        EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::LEGACY_DB_VERSION);
-
-        DbTablePtr dbTable(dbAccess.openTableWithNodes(rng, fsAccess, name, 0, nullptr));
-        ASSERT_TRUE(!!dbTable);
-
-        EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::DB_VERSION);
-    }
-
-    // Open the database.
-    SqliteDbAccess dbAccess(rootPath);
-
-    EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::LEGACY_DB_VERSION);
-
-    DbTablePtr dbTable(dbAccess.openTableWithNodes(rng, fsAccess, name, 0, nullptr));
-    EXPECT_TRUE(!!dbTable);
-
-    EXPECT_EQ(dbAccess.currentDbVersion, DbAccess::DB_VERSION);
-}
-
-TEST_F(SqliteDBTest, ProbeCurrent)
-{
-    SqliteDbAccess dbAccess(rootPath);
-
-    // Create dummy database.
-    {
-        auto dbFile =
-          dbAccess.databasePath(fsAccess,
-                                name,
-                                DbAccess::DB_VERSION);
-
-        auto fileAccess = fsAccess.newfileaccess(false);
-        EXPECT_TRUE(fileAccess->fopen(dbFile, false, true, FSLogging::logOnError));
-    }
-
-    EXPECT_TRUE(dbAccess.probe(fsAccess, name));
-}
-
-TEST_F(SqliteDBTest, ProbeLegacy)
-{
-    SqliteDbAccess dbAccess(rootPath);
-
-    // Create dummy database.
-    {
-        auto dbFile =
-          dbAccess.databasePath(fsAccess,
-                                name,
-                                DbAccess::LEGACY_DB_VERSION);
-
-        auto fileAccess = fsAccess.newfileaccess(false);
-        EXPECT_TRUE(fileAccess->fopen(dbFile, false, true, FSLogging::logOnError));
-    }
-
-    EXPECT_TRUE(dbAccess.probe(fsAccess, name));
-}
-
-TEST_F(SqliteDBTest, ProbeNone)
-{
-    SqliteDbAccess dbAccess(rootPath);
-    EXPECT_FALSE(dbAccess.probe(fsAccess, name));
-}
-
-
-TEST_F(SqliteDBTest, RootPath)
-{
-    SqliteDbAccess dbAccess(rootPath);
-    EXPECT_EQ(dbAccess.rootPath(), rootPath);
-}
-
 #ifdef WIN32
 #define SEP "\\"
 #else // WIN32
@@ -1304,3 +1169,319 @@ TEST(Split, with_delimiter)
     EXPECT_EQ(result.second.second, 4u);
 }
 
+
+namespace
+{
+
+struct NamedEntry
+{
+    LocalPath name;
+}; // NamedEntry
+
+struct NamedEntryName
+{
+    const LocalPath& operator()(const NamedEntry& entry) const
+    {
+        return entry.name;
+    }
+}; // NamedEntryName
+
+using NamedEntries = sorted_pointer_vector<NamedEntry, NamedEntryName>;
+
+// Resident set size of this process, in kilobytes (0 if unknown).
+uint64_t residentSetSize()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+
+    if (statm >> size >> resident)
+    {
+        return resident * 4;
+    }
+#endif // __linux__
+
+    return 0;
+}
+
+} // anonymous
+
+TEST(SortedPointerVector, FindsEntriesAddedInAnyOrder)
+{
+    NamedEntry a{LocalPath::fromRelativePath("a")};
+    NamedEntry b{LocalPath::fromRelativePath("b")};
+    NamedEntry c{LocalPath::fromRelativePath("c")};
+    NamedEntries entries;
+
+    entries.set(&c);
+    entries.set(&a);
+    entries.set(&b);
+
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(*entries.find(a.name), &a);
+    EXPECT_EQ(*entries.find(b.name), &b);
+    EXPECT_EQ(*entries.find(c.name), &c);
+    EXPECT_EQ(entries.find(LocalPath::fromRelativePath("d")), entries.end());
+
+    // Entries are traversed in key order.
+    std::vector<NamedEntry*> expected{&a, &b, &c};
+    EXPECT_EQ(std::vector<NamedEntry*>(entries.begin(), entries.end()), expected);
+
+    entries.erase(entries.find(b.name));
+
+    EXPECT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries.find(b.name), entries.end());
+    EXPECT_EQ(entries.back(), &c);
+}
+
+TEST(SortedPointerVector, LaterEntryReplacesEarlierWithSameKey)
+{
+    NamedEntry older{LocalPath::fromRelativePath("x")};
+    NamedEntry newer{LocalPath::fromRelativePath("x")};
+    NamedEntry other{LocalPath::fromRelativePath("y")};
+    NamedEntries entries;
+
+    // Out of order, so the duplicate is resolved by the lazy sort.
+    entries.set(&other);
+    entries.set(&older);
+    entries.set(&newer);
+
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(*entries.find(older.name), &newer);
+
+    // And in order, when the duplicate is resolved immediately.
+    entries.set(&older);
+
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(*entries.find(older.name), &older);
+}
+
+TEST(SortedPointerVector, DISABLED_MemoryBenchmark)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    constexpr auto numEntries = 1000000u;
+
+    // Names long enough that copying them costs an allocation.
+    std::vector<NamedEntry> storage(numEntries);
+
+    for (auto i = 0u; i < numEntries; ++i)
+    {
+        storage[i].name = LocalPath::fromRelativePath("some-file-name-" + std::to_string(uint64_t(i) * 7919u % numEntries) + ".jpg");
+    }
+
+    auto measure = [&](const char* layout, auto&& populate, auto&& lookup) {
+        auto rssBefore = residentSetSize();
+        auto began = steady_clock::now();
+
+        populate();
+
+        auto populated = steady_clock::now();
+        auto rssAfter = residentSetSize();
+        auto found = 0u;
+
+        for (auto& entry : storage)
+        {
+            found += lookup(entry.name);
+        }
+
+        auto elapsed = steady_clock::now() - populated;
+
+        LOG_info << layout
+                 << ": "
+                 << numEntries
+                 << " entries took "
+                 << duration_cast<milliseconds>(populated - began).count()
+                 << "ms to add, "
+                 << duration_cast<milliseconds>(elapsed).count()
+                 << "ms to look up, RSS grew by "
+                 << static_cast<int64_t>(rssAfter - rssBefore)
+                 << "KB";
+
+        EXPECT_EQ(found, numEntries);
+    };
+
+    {
+        std::map<LocalPath, NamedEntry*> entries;
+
+        measure("map", [&]() {
+            for (auto& entry : storage)
+                entries[entry.name] = &entry;
+        }, [&](const LocalPath& name) {
+            return entries.count(name);
+        });
+    }
+
+    {
+        NamedEntries entries;
+
+        measure("sorted_pointer_vector", [&]() {
+            for (auto& entry : storage)
+                entries.set(&entry);
+        }, [&](const LocalPath& name) {
+            return entries.find(name) != entries.end() ? 1u : 0u;
+        });
+    }
+}
+
+#ifdef ENABLE_SYNC
+
+namespace
+{
+
+// Carries the names a LocalNode's children are keyed by.
+struct LocalTreeNode
+  : public LocalNodeCore
+{
+    bool serialize(string*) const override
+    {
+        return false;
+    }
+}; // LocalTreeNode
+
+// A sync's tree: each folder's children, in the order they're added.
+using LocalTree = std::vector<std::vector<LocalTreeNode>>;
+
+void addChild(std::map<LocalPath, LocalTreeNode*>& children,
+              const LocalPath& name,
+              LocalTreeNode& child)
+{
+    children[name] = &child;
+}
+
+template<typename KeyOf>
+void addChild(sorted_pointer_vector<LocalTreeNode, KeyOf>& children,
+              const LocalPath&,
+              LocalTreeNode& child)
+{
+    children.set(&child);
+}
+
+// Index each folder's children like LocalNode does and look each child
+// up like LocalNode::childbyname does: by name, then by short name.
+template<typename Children, typename ShortChildren>
+void measureLocalTree(const char* layout, LocalTree& tree)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::milliseconds;
+    using std::chrono::steady_clock;
+
+    std::vector<std::pair<Children, ShortChildren>> folders(tree.size());
+
+    auto rssBefore = residentSetSize();
+    auto began = steady_clock::now();
+    auto numChildren = 0u;
+
+    for (auto i = 0u; i < tree.size(); ++i)
+    {
+        for (auto& child : tree[i])
+        {
+            addChild(folders[i].first, child.localname, child);
+
+            if (child.slocalname)
+            {
+                addChild(folders[i].second, *child.slocalname, child);
+            }
+
+            ++numChildren;
+        }
+    }
+
+    auto populated = steady_clock::now();
+    auto rssAfter = residentSetSize();
+    auto expected = 0u;
+    auto found = 0u;
+
+    auto lookup = [](const std::pair<Children, ShortChildren>& folder, const LocalPath& name) {
+        return folder.first.find(name) != folder.first.end()
+               || folder.second.find(name) != folder.second.end();
+    };
+
+    for (auto i = 0u; i < tree.size(); ++i)
+    {
+        for (auto& child : tree[i])
+        {
+            found += lookup(folders[i], child.localname);
+            ++expected;
+
+            // Notifications may name the child by its short name.
+            if (child.slocalname)
+            {
+                found += lookup(folders[i], *child.slocalname);
+                ++expected;
+            }
+        }
+    }
+
+    auto elapsed = steady_clock::now() - populated;
+
+    LOG_info << layout
+             << ": "
+             << numChildren
+             << " children in "
+             << tree.size()
+             << " folders took "
+             << duration_cast<milliseconds>(populated - began).count()
+             << "ms to add, "
+             << duration_cast<milliseconds>(elapsed).count()
+             << "ms to look up, RSS grew by "
+             << static_cast<int64_t>(rssAfter - rssBefore)
+             << "KB";
+
+    EXPECT_EQ(found, expected);
+}
+
+} // anonymous
+
+// LocalNode can only be built by a live Sync so the tree is made of
+// LocalNodeCore instances, keyed by the same LocalNodeName and
+// LocalNodeShortname that index LocalNode's children.
+TEST(SortedPointerVector, DISABLED_LocalTreeBenchmark)
+{
+    constexpr auto numEntries = 1000000u;
+
+    LocalTree tree;
+
+    for (auto numAdded = 0u; numAdded < numEntries; )
+    {
+        // Folders hold anywhere from 1 to 400 children.
+        auto numChildren = std::min(1u + static_cast<unsigned>(tree.size() * 37u % 400u),
+                                    numEntries - numAdded);
+
+        // Every other folder is added in name order, as when loaded from
+        // the state cache, and the rest in scan order.
+        auto inOrder = tree.size() % 2 == 0;
+
+        tree.emplace_back(numChildren);
+
+        for (auto i = 0u; i < numChildren; ++i)
+        {
+            auto index = std::to_string(inOrder ? i : uint64_t(i) * 7919u % numChildren);
+            auto& child = tree.back()[i];
+
+            index.insert(0, 6 - index.size(), '0');
+
+            child.localname = LocalPath::fromRelativePath("some-file-name-" + index + ".jpg");
+            child.type = FILENODE;
+
+            // Some children also have a legacy short name.
+            if (i % 10 == 0)
+            {
+                child.slocalname.reset(new LocalPath(LocalPath::fromRelativePath("SOMEFI~" + index + ".JPG")));
+            }
+        }
+
+        numAdded += numChildren;
+    }
+
+    measureLocalTree<std::map<LocalPath, LocalTreeNode*>,
+                     std::map<LocalPath, LocalTreeNode*>>("map", tree);
+
+    measureLocalTree<sorted_pointer_vector<LocalTreeNode, LocalNodeName>,
+                     sorted_pointer_vector<LocalTreeNode, LocalNodeShortname>>("sorted_pointer_vector", tree);
+}
+
+#endif // ENABLE_SYNC